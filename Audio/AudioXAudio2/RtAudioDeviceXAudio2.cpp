@@ -5,7 +5,7 @@
     ==========
     File        :   RtAudioDeviceXAudio2.h
     Author      :   Jamie Taylor
-    Last Edit   :   31/03/13
+    Last Edit   :   17/10/26
     Desc        :   XAudio2 implementation of the audio device.
 
 ===============================================================================
@@ -21,9 +21,6 @@ AudioDeviceXAudio2::AudioDeviceXAudio2
 ================
 */
 AudioDeviceXAudio2::AudioDeviceXAudio2( ) {
-    listHead = NULL;
-    listHead = NULL;
-
     audioEngine    = NULL;
     masteringVoice = NULL;
 
@@ -35,9 +32,6 @@ AudioDeviceXAudio2::AudioDeviceXAudio2( ) {
 
     isRunning = false;
 
-    static DynamicPoolAllocator<AudioDeviceView> allctr( sizeof( AudioDeviceView ), 1, 1 );
-    memAllctr = &allctr;
-
     static HeapAllocator<void> hAllctr;
     heapAllctr = &hAllctr;
 }
@@ -105,7 +99,7 @@ bool AudioDeviceXAudio2::Start( void ) {
     dspSettings.SrcChannelCount = 1;
     dspSettings.DstChannelCount = deviceDetails.OutputFormat.Format.nChannels;
 
-    coefficientsMatrix = reinterpret_cast<F32*>( heapAllctr->Allocate( sizeof( F32 ) * ( dspSettings.SrcChannelCount * dspSettings.DstChannelCount ) ) );
+    coefficientsMatrix = reinterpret_cast<F32*>( RT_ALLOC( *heapAllctr, sizeof( F32 ) * ( dspSettings.SrcChannelCount * dspSettings.DstChannelCount ), 1 ) );
     dspSettings.pMatrixCoefficients = coefficientsMatrix;
 
     isRunning = true;
@@ -152,17 +146,7 @@ AudioDeviceXAudio2::GetMixerCount
 ================
 */
 U32 AudioDeviceXAudio2::GetMixerCount( void ) const {
-    U32 attachedCount = 0;
-
-    AudioDeviceView *p = listHead;
-    while( p != NULL ) {
-        if( p->mixer != NULL ) {
-            ++attachedCount;
-        }
-        p = p->next;
-    }
-
-    return attachedCount;
+    return mixers.Count( );
 }
 
 /*
@@ -173,12 +157,10 @@ AudioDeviceXAudio2::GetActiveMixerCount
 U32 AudioDeviceXAudio2::GetActiveMixerCount( void ) const {
     U32 activeCount = 0;
 
-    AudioDeviceView *p = listHead;
-    while( ( p != NULL )) {
-        if( ( p->mixer != NULL ) && ( p->mixer->IsRunning( ) == true )  ) {
+    for( MixerXAudio2 *mixer=mixers.GetFirst( ); mixer!=NULL; mixer=mixers.GetNext( mixer ) ) {
+        if( mixer->IsRunning( ) == true ) {
             ++activeCount;
         }
-        p = p->next;
     }
 
     return activeCount;
@@ -190,17 +172,7 @@ AudioDeviceXAudio2::GetAudioFileCount
 ================
 */
 U32 AudioDeviceXAudio2::GetAudioFileCount( void ) const {
-    U32 attachedCount = 0;
-
-    AudioDeviceView *p = listHead;
-    while( p != NULL ) {
-        if( p->file != NULL ) {
-            ++attachedCount;
-        }
-        p = p->next;
-    }
-
-    return attachedCount;
+    return wavFiles.Count( );
 }
 
 /*
@@ -211,12 +183,10 @@ AudioDeviceXAudio2::GetActiveAudioFileCount
 U32 AudioDeviceXAudio2::GetActiveAudioFileCount( void ) const {
     U32 activeCount = 0;
 
-    AudioDeviceView *p = listHead;
-    while( p != NULL ) {
-        if( ( p->file != NULL ) && ( p->file->IsPlaying( ) == true ) ) {
+    for( WavFileXAudio2 *file=wavFiles.GetFirst( ); file!=NULL; file=wavFiles.GetNext( file ) ) {
+        if( file->IsPlaying( ) == true ) {
             ++activeCount;
         }
-        p = p->next;
     }
 
     return activeCount;
@@ -228,12 +198,10 @@ AudioDeviceXAudio2::Play
 ================
 */
 void AudioDeviceXAudio2::Play( void ) {
-    AudioDeviceView *p = listHead;
-    while( p != NULL ) {
-        if( p->file != NULL && p->file->IsPlaying( ) == false ) {
-            p->file->Play( );
+    for( WavFileXAudio2 *file=wavFiles.GetFirst( ); file!=NULL; file=wavFiles.GetNext( file ) ) {
+        if( file->IsPlaying( ) == false ) {
+            file->Play( );
         }
-        p = p->next;
     }
 }
 
@@ -243,12 +211,10 @@ AudioDeviceXAudio2::Pause
 ================
 */
 void AudioDeviceXAudio2::Pause( void ) {
-    AudioDeviceView *p = listHead;
-    while( p != NULL ) {
-        if( p->file != NULL && p->file->IsPlaying( ) == true ) {
-            p->file->Pause( );
+    for( WavFileXAudio2 *file=wavFiles.GetFirst( ); file!=NULL; file=wavFiles.GetNext( file ) ) {
+        if( file->IsPlaying( ) == true ) {
+            file->Pause( );
         }
-        p = p->next;
     }
 }
 
@@ -258,12 +224,10 @@ AudioDeviceXAudio2::Stop
 ================
 */
 void AudioDeviceXAudio2::Stop( void ) {
-    AudioDeviceView *p = listHead;
-    while( p != NULL ) {
-        if( p->file != NULL && p->file->IsPlaying( ) == true ) {
-            p->file->Stop( );
+    for( WavFileXAudio2 *file=wavFiles.GetFirst( ); file!=NULL; file=wavFiles.GetNext( file ) ) {
+        if( file->IsPlaying( ) == true ) {
+            file->Stop( );
         }
-        p = p->next;
     }
 }
 
@@ -273,12 +237,8 @@ AudioDeviceXAudio2::SetLoopingParams
 ================
 */
 void AudioDeviceXAudio2::SetLoopingParams( U32 loopStart, U32 loopDuration, U32 loopCount ) {
-    AudioDeviceView *p = listHead;
-    while( p != NULL ) {
-        if( ( p->file != NULL ) ) {
-            p->file->SetLoopingParams( loopStart, loopDuration, loopCount );
-        }
-        p = p->next;
+    for( WavFileXAudio2 *file=wavFiles.GetFirst( ); file!=NULL; file=wavFiles.GetNext( file ) ) {
+        file->SetLoopingParams( loopStart, loopDuration, loopCount );
     }
 }
 
@@ -288,12 +248,8 @@ AudioDeviceXAudio2::SetVolume
 ================
 */
 void AudioDeviceXAudio2::SetVolume( F32 vol ) {
-    AudioDeviceView *p = listHead;
-    while( p != NULL ) {
-        if( ( p->file != NULL ) ) {
-            p->file->SetVolume( vol );
-        }
-        p = p->next;
+    for( WavFileXAudio2 *file=wavFiles.GetFirst( ); file!=NULL; file=wavFiles.GetNext( file ) ) {
+        file->SetVolume( vol );
     }
 }
 
@@ -320,19 +276,16 @@ void AudioDeviceXAudio2::Update3DAudio( F32 xDelta, F32 zDelta, F32 pitchDelta,
         listener.Position.z += zRefTransformed.z;
     //}
 
-    AudioDeviceView *p = listHead;
-    while( p != NULL ) {
-        if( ( p->file != NULL ) ) { // && ( file->Is3d( ) == true )
-            // get emitter from wav file
-            X3DAUDIO_EMITTER *emitter = p->file->Get3dEmitter( );
-            IXAudio2SourceVoice *sourceVoice = p->file->GetSourceVoice( );
+    for( WavFileXAudio2 *file=wavFiles.GetFirst( ); file!=NULL; file=wavFiles.GetNext( file ) ) {
+        // if( file->Is3d( ) == true )
+        // get emitter from wav file
+        X3DAUDIO_EMITTER *emitter = file->Get3dEmitter( );
+        IXAudio2SourceVoice *sourceVoice = file->GetSourceVoice( );
 
-            X3DAudioCalculate( X3DInstance, &listener, emitter, flags, &dspSettings );
+        X3DAudioCalculate( X3DInstance, &listener, emitter, flags, &dspSettings );
 
-            sourceVoice->SetOutputMatrix( masteringVoice, /*dspSettings.SrcChannelCount*/ 2,
-                                          dspSettings.DstChannelCount, coefficientsMatrix, 0 );
-        }
-        p = p->next;
+        sourceVoice->SetOutputMatrix( masteringVoice, /*dspSettings.SrcChannelCount*/ 2,
+                                      dspSettings.DstChannelCount, coefficientsMatrix, 0 );
     }
 }
 
@@ -342,12 +295,8 @@ AudioDeviceXAudio2::ShutdownMixers
 ================
 */
 void AudioDeviceXAudio2::ShutdownMixers( void ) {
-    AudioDeviceView *p = listHead;
-    while( p != NULL ) {
-        if( ( p->mixer != NULL ) ) {
-            p->mixer->Shutdown( );
-        }
-        p = p->next;
+    for( MixerXAudio2 *mixer=mixers.GetFirst( ); mixer!=NULL; mixer=mixers.GetNext( mixer ) ) {
+        mixer->Shutdown( );
     }
 }
 
@@ -357,12 +306,8 @@ AudioDeviceXAudio2::UnloadAudioFiles
 ================
 */
 void AudioDeviceXAudio2::UnloadAudioFiles( void ) {
-    AudioDeviceView *p = listHead;
-    while( p != NULL ) {
-        if( ( p->file != NULL ) ) {
-            p->file->UnLoad( );
-        }
-        p = p->next;
+    for( WavFileXAudio2 *file=wavFiles.GetFirst( ); file!=NULL; file=wavFiles.GetNext( file ) ) {
+        file->UnLoad( );
     }
 }
 
@@ -372,23 +317,7 @@ AudioDeviceXAudio2::RegisterMixer
 ================
 */
 void AudioDeviceXAudio2::RegisterMixer( Mixer *mixer ) {
-    MixerXAudio2 *mix = reinterpret_cast<MixerXAudio2*>( mixer );
-
-    if( listHead == NULL ) {
-        listHead = memAllctr->Allocate( );
-        listHead->mixer = mix;
-        listHead->next = NULL;
-    }
-    else {
-        AudioDeviceView *thisFile = memAllctr->Allocate( );
-        thisFile->mixer = listHead->mixer;
-        thisFile->next  = listHead->next;
-        thisFile->file  = NULL; 
-
-        listHead->mixer = mix;
-        listHead->next = thisFile;
-    }
-    listHead->file = NULL;
+    mixers.PushFront( reinterpret_cast<MixerXAudio2*>( mixer ) );
 }
 
 /*
@@ -397,16 +326,7 @@ AudioDeviceXAudio2::UnRegisterMixer
 ================
 */
 void AudioDeviceXAudio2::UnRegisterMixer( Mixer *mixer ) {
-    MixerXAudio2 *mix = reinterpret_cast<MixerXAudio2*>( mixer );
-
-    AudioDeviceView *p = listHead;
-    while( p != NULL ) {
-        if( p->mixer == mix ) {
-            memAllctr->DeAllocate( p );
-            break;
-        }
-        p = p->next;
-    }
+    mixers.Remove( reinterpret_cast<MixerXAudio2*>( mixer ) );
 }
 
 /*
@@ -415,23 +335,7 @@ AudioDeviceXAudio2::RegisterWavFile
 ================
 */
 void AudioDeviceXAudio2::RegisterWavFile( WavFile *file ) {
-    WavFileXAudio2 *wav = reinterpret_cast<WavFileXAudio2*>( file );
-
-    if( listHead == NULL ) {
-        listHead = memAllctr->Allocate( );
-        listHead->file = wav;
-        listHead->next = NULL;
-    }
-    else {
-        AudioDeviceView *thisFile = memAllctr->Allocate( );
-        thisFile->file = listHead->file;
-        thisFile->next = listHead->next;
-        thisFile->mixer = NULL; 
-
-        listHead->file = wav;
-        listHead->next = thisFile;
-    }
-    listHead->mixer = NULL;
+    wavFiles.PushFront( reinterpret_cast<WavFileXAudio2*>( file ) );
 }
 
 /*
@@ -440,16 +344,7 @@ AudioDeviceXAudio2::UnRegisterWavFile
 ================
 */
 void AudioDeviceXAudio2::UnRegisterWavFile( WavFile *file ) {
-    WavFileXAudio2 *wav = reinterpret_cast<WavFileXAudio2*>( file );
-
-    AudioDeviceView *p = listHead;
-    while( p != NULL ) {
-        if( p->file == wav ) {
-            memAllctr->DeAllocate( p );
-            break;
-        }
-        p = p->next;
-    }
+    wavFiles.Remove( reinterpret_cast<WavFileXAudio2*>( file ) );
 }
 
 /*
@@ -5,9 +5,12 @@
     ==========
     File        :   RtAudioDeviceXAudio2.h
     Author      :   Jamie Taylor
-    Last Edit   :   31/03/13
+    Last Edit   :   17/10/26
     Desc        :   XAudio2 implementation of the audio device.
 
+                    17/10/26 - Mixers and wav files are tracked in intrusive lists (the links live in the
+                               mixers/files), registering and unregistering no longer allocates or searches.
+
 ===============================================================================
 */
 
@@ -21,6 +24,7 @@
 #include "RtWavFileXAudio2.h"
 
 #include "../../CoreSystems/RtHeapAllocator.h"
+#include "../../CoreSystems/RtIntrusiveList.h"
 
 // for vector & matrix ops
 #include <xnamath.h>
@@ -75,17 +79,9 @@ public:
     void                                    UnRegisterWavFile( WavFile *file );
 
 private:
-                                            struct AudioDeviceView {
-                                                AudioDeviceView( void ) { ZeroMem( this, sizeof( this ) ); }
-
-                                            WavFileXAudio2     * file;
-                                                MixerXAudio2    * mixer;
-                                                AudioDeviceView * next;
-                                            };
-
-    AudioDeviceView                        * listHead;
+    IntrusiveList<MixerXAudio2, &MixerXAudio2::deviceLink>     mixers;
+    IntrusiveList<WavFileXAudio2, &WavFileXAudio2::deviceLink> wavFiles;
     HeapAllocator<void>                    * heapAllctr;
-    DynamicPoolAllocator<AudioDeviceView>  * memAllctr;
 
     IXAudio2                               * audioEngine;
     IXAudio2MasteringVoice                 * masteringVoice;
@@ -21,6 +21,7 @@
 
 // needed to test factory functions
 #include "../../CoreSystems/RtHeapAllocator.h"
+#include "../../CoreSystems/RtIntrusiveList.h"
 
 // memory corruption caused by allctr->contruct ("XAUDIO2 glitch at sample xyz")
 //#include "../../CoreSystems/RtSinglyLinkedList_DP_V.h"
@@ -76,6 +77,10 @@ private:
     AudioFileMixerView                       * listHead;
     DynamicPoolAllocator<AudioFileMixerView> * memAllctr;
 
+                                                // links this into the audio device's list, see AudioDeviceXAudio2::Register*
+                                                friend class AudioDeviceXAudio2;
+    IntrusiveListLink                          deviceLink;
+
     // TEMPORARY HELPER
     IXAudio2                                 * tempHelper;
 
@@ -5,9 +5,12 @@
     ==========
     File        :   RtWavFileXAudio2.cpp
     Author      :   Jamie Taylor
-    Last Edit   :   25/03/13
+    Last Edit   :   17/10/26
     Desc        :   An XAudio2 implementation of the basic static wave file class. Adopting a DOOM 3 style syntax.
 
+                    17/10/26 - The file is memory mapped (MappedFile) for as long as it's loaded, the chunks are
+                               found in place and XAudio2 plays the data chunk straight from the mapping.
+
 ===============================================================================
 */
 
@@ -25,8 +28,6 @@ WavFileXAudio2::WavFileXAudio2( void ) {
     isLoaded  = false;
     isPlaying = false;
 
-    audioFile   = NULL;
-    audioBuffer = NULL;
     sourceVoice = NULL;
 
     // set member structs mem to 0
@@ -62,18 +63,7 @@ WaveFileXAudio2::Load
 ================
 */
 bool WavFileXAudio2::Load( const I8 *fileName ) {
-    // put the filename into a 
-    const I8 *fileNameCopy = fileName;
-    I8 fileNameArray[256] = { 0 };
-    U32 i = 0;
-    while( *fileNameCopy ) {
-        fileNameArray[i++] = *fileNameCopy++;
-    }
-    fileNameArray[i] = '\0';
-    
-    audioFile = CreateFile( fileNameArray, GENERIC_READ, FILE_SHARE_READ, 
-        NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL ); // use FILE_FLAG_NO_BUFFERING for async streaming
-    if ( audioFile == INVALID_HANDLE_VALUE ) {
+    if( audioFile.Open( fileName ) == false ) {
         return false;
     }
 
@@ -83,29 +73,35 @@ bool WavFileXAudio2::Load( const I8 *fileName ) {
     U32 fileType       = 0;
 
     // read the 'RIFF' chunk
-    FindChunk( FOURCC_ID_RIFF, chunkSize, chunkPosition );
-    ReadChunk( &fileType, chunkSize, chunkPosition );
+    if( FindChunk( FOURCC_ID_RIFF, chunkSize, chunkPosition ) == true ) {
+        ReadChunk( &fileType, chunkSize, chunkPosition );
+    }
 
     // read the 'fmt' section of the 'RIFF' chunk
-    FindChunk( FOURCC_ID_FMT, chunkSize, chunkPosition );
-    ReadChunk( &audioFileFormat.Format, chunkSize, chunkPosition );
+    bool hasFormat = FindChunk( FOURCC_ID_FMT, chunkSize, chunkPosition );
+    if( hasFormat == true ) {
+        ReadChunk( &audioFileFormat, ( chunkSize < sizeof( audioFileFormat ) ) ? chunkSize : static_cast<U32>( sizeof( audioFileFormat ) ), chunkPosition );
+    }
 
     // only supporting Wave files at present
-    if( fileType != FOURCC_ID_WAVE ) {
+    if( ( fileType != FOURCC_ID_WAVE ) || ( hasFormat == false ) ) {
         UnLoad( );
         return false;
     }
 
-    // read the 'data' section of the 'RIFF chunk, this contains our audio data
-    FindChunk( FOURCC_ID_DATA, chunkSize, chunkPosition );
-    audioBuffer = reinterpret_cast<U8*>( allocator.Allocate( ( sizeof( U8 ) * chunkSize ) ) );
-    ReadChunk( audioBuffer, chunkSize, chunkPosition );
+    // find the 'data' section of the 'RIFF chunk, this contains our audio data - it's played straight
+    // from the mapping, start reading it in now rather than on the audio thread when it's first played
+    if( FindChunk( FOURCC_ID_DATA, chunkSize, chunkPosition ) == false ) {
+        UnLoad( );
+        return false;
+    }
+    audioFile.Prefetch( chunkPosition, chunkSize );
 
     // populate XAUDIO2_BUFFER
     // size of the audio buffer in bytes
     audioFileBuffer.AudioBytes = chunkSize;
     // buffer containing audio data
-    audioFileBuffer.pAudioData = const_cast<U8*>( reinterpret_cast<U8*>( audioBuffer ) );
+    audioFileBuffer.pAudioData = audioFile.Data( ) + chunkPosition;
     // tell the source voice not to expect any data after this buffer
     audioFileBuffer.Flags = XAUDIO2_END_OF_STREAM;
 
@@ -146,16 +142,8 @@ void WavFileXAudio2::UnLoad( void ) {
         sourceVoice->DestroyVoice( );
     }
 
-    if( audioBuffer != NULL ) {
-        allocator.DeAllocate( audioBuffer );
-        audioBuffer = NULL;
-    }
-
-    if( audioFile != NULL ) {
-        if ( CloseHandle( audioFile ) == 0) {
-            audioFile = NULL;
-        }
-    }
+    // after the source voice, it plays from the mapping
+    audioFile.Close( );
 
     isLoaded = false;
 }
@@ -316,75 +304,44 @@ IXAudio2SourceVoice* WavFileXAudio2::GetSourceVoice( void ) const {
 ================
 WavFileXAudio2::FindChunk
 
-true = chunk found, false = chunk not found
+true = chunk found, false = chunk not found (or runs off the end of the file)
 ================
 */
 bool WavFileXAudio2::FindChunk( U32 fourcc, U32 &chunkSize, U32 &chunkPosition ) {
-    // set file pointer to the beginning of the file for safety
-    if( SetFilePointer( audioFile, 0, NULL, FILE_BEGIN ) == INVALID_SET_FILE_POINTER ) {
-        return false;
-    }
+    const U8 *fileData = audioFile.Data( );
+    U64 fileSize = audioFile.Size( );
 
     // find the chunk
     U32 chunkType     = 0;
     U32 chunkDataSize = 0;
-    U32 RIFFDataSize  = 0;
-    U32 fileType      = 0;
-    U32 offset        = 0;
-
-    U32 bytesRead   = 0;
-    U32 loopControl = 1;
-    while( loopControl == 1 ) {
-        // read the chunks format
-        if( ReadFile( audioFile, &chunkType, sizeof( U32 ), reinterpret_cast<LPDWORD>( &bytesRead ), NULL ) == 0 ) {
-            loopControl = HRESULT_FROM_WIN32( GetLastError( ) );
+    U64 offset        = 0;
+
+    while( ( offset + ( sizeof( U32 ) * 2 ) ) <= fileSize ) {
+        // read the chunks format and size
+        CopyMem( &fileData[offset], &chunkType, sizeof( U32 ) );
+        CopyMem( &fileData[offset + sizeof( U32 )], &chunkDataSize, sizeof( U32 ) );
+        offset += ( sizeof( U32 ) * 2 );
+
+        // RIFF chunk, is this a WAVE or xWMA file? (the RIFF chunk contains all the other chunks, it
+        // effectively is the audio file) only the file type is read, the chunks inside come after it
+        if( chunkType == FOURCC_ID_RIFF ) {
+            chunkDataSize = 4;
         }
 
-        // read the chunks size
-        if( ReadFile( audioFile, &chunkDataSize, sizeof( unsigned int ), reinterpret_cast<LPDWORD>( &bytesRead ), NULL ) == 0 ) {
-            loopControl = HRESULT_FROM_WIN32( GetLastError( ) );
-        }
-
-        // act based on chunk type
-        // act based on chunk type
-        switch( chunkType ) {
-        // RIFF chunk, is this a WAVE or xWMA file? what size is the RIFF chunk? 
-        // (the RIFF chunk contains all the other chunks, it effectively is the audio file)
-        case FOURCC_ID_RIFF:
-            RIFFDataSize = chunkDataSize;
-            chunkDataSize = 4; // ...
-            if( ReadFile( audioFile, &fileType, sizeof( U32 ), reinterpret_cast<LPDWORD>( &bytesRead ), NULL ) == 0 ) {
-                loopControl = HRESULT_FROM_WIN32( GetLastError( ) );
-            }
-            break;
-
-        // skip over the chunk
-        default:
-            // set file pointer
-            if( SetFilePointer( audioFile, chunkDataSize, 0, FILE_CURRENT ) == INVALID_SET_FILE_POINTER ) {
-                loopControl = HRESULT_FROM_WIN32( GetLastError( ) );
-            }
-            break;
-        } // switch( chunkType )
-
-        // increment the offset
-        offset += ( sizeof( unsigned int ) * 2 );
-
         // have we found the chunk?
         if( chunkType == fourcc ) {
+            if( ( offset + chunkDataSize ) > fileSize ) {
+                return false;
+            }
+
             chunkSize = chunkDataSize;
-            chunkPosition = offset;
+            chunkPosition = static_cast<U32>( offset );
             return true;
         }
 
-        // add the size of what we've just read to the offset and keep looking (skip over this chunk), it's not the one we're looking for
+        // skip over this chunk, it's not the one we're looking for
         offset += chunkDataSize;
-
-        // if we've read all or more bytes than exist in the RIFF chunk's data section then we're done / something's gone wrong / the chunk searched for isn't present
-        if( bytesRead >= RIFFDataSize ) {
-            return false;
-        }
-    } // while( 1 )
+    } // while( )
 
     // if the chunk has been found this point will not be hit
     return false;
@@ -398,17 +355,15 @@ returns the number of bytes read, 0 indicates error
 ================
 */
 U32    WavFileXAudio2::ReadChunk( void *buffer, U32 bytesToRead, U32 bufferOffset ) {
-    // set file pointer
-    if( SetFilePointer( audioFile, bufferOffset, NULL, FILE_BEGIN ) == INVALID_SET_FILE_POINTER ) {
+    U64 fileSize = audioFile.Size( );
+    if( bufferOffset >= fileSize ) {
         return 0;
     }
 
-    // read
-    // using this in asynchronous file IO is potentially unsafe: http://msdn.microsoft.com/en-gb/library/windows/desktop/aa365467(v=vs.85).aspx
-    U32 bytesRead = 0;
-    if( ReadFile( audioFile, buffer, bytesToRead, reinterpret_cast<LPDWORD>( &bytesRead ), NULL ) == 0 ) {
-        return 0;
-    }
+    // copy out of the mapping
+    U64 available = fileSize - bufferOffset;
+    U32 bytesRead = ( bytesToRead < available ) ? bytesToRead : static_cast<U32>( available );
+    CopyMem( audioFile.Data( ) + bufferOffset, buffer, bytesRead );
 
     return bytesRead;
 }
@@ -5,9 +5,11 @@
     ==========
     File        :   RtWaveFileXAudio2.h
     Author      :   Jamie Taylor
-    Last Edit   :   25/03/13
+    Last Edit   :   17/10/26
     Desc        :   An XAudio2 implementationof the basic static wave file class. Adopting a DOOM 3 style syntax.
 
+                    17/10/26 - The file is a MappedFile rather than a HANDLE, see RtWavFileXAudio2.cpp.
+
 ===============================================================================
 */
 
@@ -17,10 +19,12 @@
 
 
 #include "../../PlatformIndependenceLayer/RtPlatform.h"
+#include "../../PlatformIndependenceLayer/RtMappedFile.h"
 #include "../../CoreSystems/RtMemoryCommon.h"
 
 // needed to test factory functions
 #include "../../CoreSystems/RtHeapAllocator.h"
+#include "../../CoreSystems/RtIntrusiveList.h"
 
 #include "../RtWavFile.h"
 #include <XAudio2.h>
@@ -81,7 +85,8 @@ private:
     U32                     ReadChunk( void *buffer, U32 bytesToRead, U32 bufferOffset );
 
                             // private, implementation specific members
-    HANDLE                  audioFile;
+                            // mapped for as long as the file's loaded, XAudio2 plays straight from it
+    MappedFile              audioFile;
     WAVEFORMATEXTENSIBLE    audioFileFormat;
     XAUDIO2_BUFFER          audioFileBuffer;
     IXAudio2SourceVoice *   sourceVoice;
@@ -90,6 +95,10 @@ private:
     // bool                 is3d;
     X3DAUDIO_EMITTER        emitter;
 
+                            // links this into the audio device's list, see AudioDeviceXAudio2::Register*
+                            friend class AudioDeviceXAudio2;
+    IntrusiveListLink       deviceLink;
+
                             // local alloator
     HeapAllocator<void>     allocator;
 
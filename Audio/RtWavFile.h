@@ -5,9 +5,12 @@
     ==========
     File        :   RtWavFile.h
     Author      :   Jamie Taylor
-    Last Edit   :   25/03/13
+    Last Edit   :   17/10/26
     Desc        :   A basic static wav file class. Adopting a DOOM 3 style syntax.
 
+                    17/10/26 - Dropped the unused audioBuffer member, the XAudio2 version plays straight from
+                               its mapped file.
+
 ===============================================================================
 */
 
@@ -54,7 +57,6 @@ public:
 protected:
     bool            isLoaded;
     bool            isPlaying;
-    U8*             audioBuffer;
 };
 
 
@@ -0,0 +1,108 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtAlgorithm.cpp
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    SSE2 linear searches, see RtAlgorithm.h.
+
+===============================================================================
+*/
+
+
+#include "RtAlgorithm.h"
+#include <emmintrin.h>
+
+
+/*
+================
+LinearSearch
+
+16 elements per iteration, the four compares are or'd together so there's a single branch
+until something matches.
+================
+*/
+U32 LinearSearch( const U32 *elements, U32 count, const U32 &value ) {
+    const __m128i key = _mm_set1_epi32( static_cast<int>( value ) );
+    U32 i = 0;
+
+    for( ; ( i + 16 ) <= count; i += 16 ) {
+        const __m128i *p = reinterpret_cast<const __m128i*>( &elements[i] );
+        __m128i a = _mm_cmpeq_epi32( _mm_loadu_si128( p ), key );
+        __m128i b = _mm_cmpeq_epi32( _mm_loadu_si128( p + 1 ), key );
+        __m128i c = _mm_cmpeq_epi32( _mm_loadu_si128( p + 2 ), key );
+        __m128i d = _mm_cmpeq_epi32( _mm_loadu_si128( p + 3 ), key );
+        __m128i any = _mm_or_si128( _mm_or_si128( a, b ), _mm_or_si128( c, d ) );
+
+        if( _mm_movemask_epi8( any ) != 0 ) {
+            // one byte per lane, 4 per element
+            U32 mask = static_cast<U32>( _mm_movemask_epi8( a ) ) | ( static_cast<U32>( _mm_movemask_epi8( b ) ) << 16 );
+            if( mask != 0 ) {
+                return i + ( LowestSetBit( mask ) >> 2 );
+            }
+            mask = static_cast<U32>( _mm_movemask_epi8( c ) ) | ( static_cast<U32>( _mm_movemask_epi8( d ) ) << 16 );
+            return i + 8 + ( LowestSetBit( mask ) >> 2 );
+        }
+    }
+
+    for( ; ( i + 4 ) <= count; i += 4 ) {
+        __m128i eq = _mm_cmpeq_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( &elements[i] ) ), key );
+        U32 mask = static_cast<U32>( _mm_movemask_epi8( eq ) );
+        if( mask != 0 ) {
+            return i + ( LowestSetBit( mask ) >> 2 );
+        }
+    }
+
+    for( ; i<count; ++i ) {
+        if( elements[i] == value ) {
+            return i;
+        }
+    }
+
+    return RT_INVALID_INDEX;
+}
+
+/*
+================
+LinearSearch
+
+SSE2 has no 64 bit compare, compare the 32 bit halves and and each half with its neighbour.
+================
+*/
+U32 LinearSearch( const U64 *elements, U32 count, const U64 &value ) {
+    const __m128i key = _mm_set1_epi64x( static_cast<long long>( value ) );
+    U32 i = 0;
+
+    for( ; ( i + 8 ) <= count; i += 8 ) {
+        const __m128i *p = reinterpret_cast<const __m128i*>( &elements[i] );
+        __m128i a = _mm_cmpeq_epi32( _mm_loadu_si128( p ), key );
+        __m128i b = _mm_cmpeq_epi32( _mm_loadu_si128( p + 1 ), key );
+        __m128i c = _mm_cmpeq_epi32( _mm_loadu_si128( p + 2 ), key );
+        __m128i d = _mm_cmpeq_epi32( _mm_loadu_si128( p + 3 ), key );
+        a = _mm_and_si128( a, _mm_shuffle_epi32( a, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+        b = _mm_and_si128( b, _mm_shuffle_epi32( b, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+        c = _mm_and_si128( c, _mm_shuffle_epi32( c, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+        d = _mm_and_si128( d, _mm_shuffle_epi32( d, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+        __m128i any = _mm_or_si128( _mm_or_si128( a, b ), _mm_or_si128( c, d ) );
+
+        if( _mm_movemask_epi8( any ) != 0 ) {
+            // one byte per lane, 8 per element
+            U32 mask = static_cast<U32>( _mm_movemask_epi8( a ) ) | ( static_cast<U32>( _mm_movemask_epi8( b ) ) << 16 );
+            if( mask != 0 ) {
+                return i + ( LowestSetBit( mask ) >> 3 );
+            }
+            mask = static_cast<U32>( _mm_movemask_epi8( c ) ) | ( static_cast<U32>( _mm_movemask_epi8( d ) ) << 16 );
+            return i + 4 + ( LowestSetBit( mask ) >> 3 );
+        }
+    }
+
+    for( ; i<count; ++i ) {
+        if( elements[i] == value ) {
+            return i;
+        }
+    }
+
+    return RT_INVALID_INDEX;
+}
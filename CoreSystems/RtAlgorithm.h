@@ -0,0 +1,360 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtAlgorithm.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Sorting and searching over plain arrays, used by the containers.
+
+                     Sort - introsort: quicksort (median of three) that falls back to heapsort if it recurses too
+                     deep, with small partitions left for a final insertion sort pass. O(n log n) worst case,
+                     not stable.
+
+                     LowerBound/BinarySearch - for arrays sorted with the same comparator.
+
+                     LinearSearch - compares 4 (32 bit) or 2 (64 bit) integers at a time with SSE2 for U32, I32,
+                     U64 and I64 arrays, element by element with operator== for anything else. SSE2 is part of
+                     x86_64 and already assumed by RtAtomic.h.
+
+                     Search functions return the index of the element or RT_INVALID_INDEX.
+
+===============================================================================
+*/
+
+
+#ifndef RT_ALGORITHM_H
+#define RT_ALGORITHM_H
+
+
+#include "../PlatformIndependenceLayer/RtPlatform.h"
+#include "RtTypeTraits.h"
+
+
+// returned by the search functions when the element isn't there
+#define RT_INVALID_INDEX static_cast<U32>( -1 )
+
+// partitions this small are left to the final insertion sort
+static const U32 SORT_INSERTION_THRESHOLD = 16;
+
+
+/*
+================
+LowestSetBit
+
+Index of the lowest set bit, @mask must not be zero.
+================
+*/
+inline U32 LowestSetBit( U32 mask ) {
+#if RT_COMPILER == RT_COMPILER_MSVC
+    unsigned long index;
+    _BitScanForward( &index, mask );
+    return static_cast<U32>( index );
+#elif RT_COMPILER == RT_COMPILER_GCC
+    return static_cast<U32>( __builtin_ctz( mask ) );
+#endif // RT_COMPILER
+}
+
+/*
+================
+Less
+
+Default comparator, operator< .
+================
+*/
+template<class T>
+struct Less {
+    bool operator()( const T &a, const T &b ) const { return ( a < b ); }
+};
+
+/*
+================
+Swap
+================
+*/
+template<class T>
+inline void Swap( T &a, T &b ) {
+    T temp( Move( a ) );
+    a = Move( b );
+    b = Move( temp );
+}
+
+
+/*
+===============================================================================
+
+IntroSort - helpers for Sort
+
+===============================================================================
+*/
+template<class T, class Compare>
+struct IntroSort {
+    static void         Loop( T *elements, U32 count, U32 depthLimit, Compare &compare );
+    static U32          Partition( T *elements, U32 count, Compare &compare );
+    static void         HeapSort( T *elements, U32 count, Compare &compare );
+    static void         SiftDown( T *elements, U32 root, U32 count, Compare &compare );
+    static void         InsertionSort( T *elements, U32 count, Compare &compare );
+};
+
+/*
+================
+IntroSort<T, Compare>::Loop
+
+Recurses into the smaller partition and loops on the larger one so the stack stays O(log n).
+================
+*/
+template<class T, class Compare>
+void IntroSort<T, Compare>::Loop( T *elements, U32 count, U32 depthLimit, Compare &compare ) {
+    while( count > SORT_INSERTION_THRESHOLD ) {
+        if( depthLimit == 0 ) {
+            HeapSort( elements, count, compare );
+            return;
+        }
+        --depthLimit;
+
+        U32 split = Partition( elements, count, compare );
+        if( split < ( count - split ) ) {
+            Loop( elements, split, depthLimit, compare );
+            elements += split;
+            count -= split;
+        }
+        else {
+            Loop( elements + split, count - split, depthLimit, compare );
+            count = split;
+        }
+    }
+}
+
+/*
+================
+IntroSort<T, Compare>::Partition
+
+Hoare partition around the median of the first, middle and last elements. Returns the size of
+the lower partition, both partitions are non-empty.
+================
+*/
+template<class T, class Compare>
+U32 IntroSort<T, Compare>::Partition( T *elements, U32 count, Compare &compare ) {
+    U32 mid = count >> 1;
+    U32 last = count - 1;
+
+    // order first/mid/last, the median ends up in the middle
+    if( compare( elements[mid], elements[0] ) ) {
+        Swap( elements[mid], elements[0] );
+    }
+    if( compare( elements[last], elements[mid] ) ) {
+        Swap( elements[last], elements[mid] );
+        if( compare( elements[mid], elements[0] ) ) {
+            Swap( elements[mid], elements[0] );
+        }
+    }
+
+    T pivot( elements[mid] );
+    U32 i = 0;
+    U32 j = last;
+    for( ;; ) {
+        // first and last act as sentinels, neither scan can leave the array
+        while( compare( elements[i], pivot ) ) {
+            ++i;
+        }
+        while( compare( pivot, elements[j] ) ) {
+            --j;
+        }
+        if( i >= j ) {
+            return j + 1;
+        }
+        Swap( elements[i], elements[j] );
+        ++i;
+        --j;
+    }
+}
+
+/*
+================
+IntroSort<T, Compare>::HeapSort
+================
+*/
+template<class T, class Compare>
+void IntroSort<T, Compare>::HeapSort( T *elements, U32 count, Compare &compare ) {
+    for( U32 i=count>>1; i>0; --i ) {
+        SiftDown( elements, i-1, count, compare );
+    }
+
+    for( U32 end=count-1; end>0; --end ) {
+        Swap( elements[0], elements[end] );
+        SiftDown( elements, 0, end, compare );
+    }
+}
+
+/*
+================
+IntroSort<T, Compare>::SiftDown
+================
+*/
+template<class T, class Compare>
+void IntroSort<T, Compare>::SiftDown( T *elements, U32 root, U32 count, Compare &compare ) {
+    for( ;; ) {
+        U32 child = ( root << 1 ) + 1;
+        if( child >= count ) {
+            return;
+        }
+        if( ( child + 1 ) < count && compare( elements[child], elements[child+1] ) ) {
+            ++child;
+        }
+        if( !compare( elements[root], elements[child] ) ) {
+            return;
+        }
+        Swap( elements[root], elements[child] );
+        root = child;
+    }
+}
+
+/*
+================
+IntroSort<T, Compare>::InsertionSort
+================
+*/
+template<class T, class Compare>
+void IntroSort<T, Compare>::InsertionSort( T *elements, U32 count, Compare &compare ) {
+    for( U32 i=1; i<count; ++i ) {
+        if( !compare( elements[i], elements[i-1] ) ) {
+            continue;
+        }
+
+        T temp( Move( elements[i] ) );
+        U32 j = i;
+        do {
+            elements[j] = Move( elements[j-1] );
+            --j;
+        } while( j > 0 && compare( temp, elements[j-1] ) );
+        elements[j] = Move( temp );
+    }
+}
+
+
+/*
+================
+Sort
+
+@compare( a, b ) returns true if a must come before b.
+================
+*/
+template<class T, class Compare>
+void Sort( T *elements, U32 count, Compare compare ) {
+    if( count < 2 ) {
+        return;
+    }
+
+    // 2 * log2( count )
+    U32 depthLimit = 0;
+    for( U32 n=count; n>1; n>>=1 ) {
+        depthLimit += 2;
+    }
+
+    IntroSort<T, Compare>::Loop( elements, count, depthLimit, compare );
+    IntroSort<T, Compare>::InsertionSort( elements, count, compare );
+}
+
+template<class T>
+void Sort( T *elements, U32 count ) {
+    Sort( elements, count, Less<T>( ) );
+}
+
+/*
+================
+LowerBound
+
+Index of the first element that doesn't come before @value, @count if there isn't one.
+================
+*/
+template<class T, class Compare>
+U32 LowerBound( const T *elements, U32 count, const T &value, Compare compare ) {
+    U32 first = 0;
+    while( count > 0 ) {
+        U32 half = count >> 1;
+        if( compare( elements[first + half], value ) ) {
+            first += half + 1;
+            count -= half + 1;
+        }
+        else {
+            count = half;
+        }
+    }
+
+    return first;
+}
+
+template<class T>
+U32 LowerBound( const T *elements, U32 count, const T &value ) {
+    return LowerBound( elements, count, value, Less<T>( ) );
+}
+
+/*
+================
+BinarySearch
+================
+*/
+template<class T, class Compare>
+U32 BinarySearch( const T *elements, U32 count, const T &value, Compare compare ) {
+    U32 index = LowerBound( elements, count, value, compare );
+    if( index < count && !compare( value, elements[index] ) ) {
+        return index;
+    }
+
+    return RT_INVALID_INDEX;
+}
+
+template<class T>
+U32 BinarySearch( const T *elements, U32 count, const T &value ) {
+    return BinarySearch( elements, count, value, Less<T>( ) );
+}
+
+/*
+================
+LinearSearch
+================
+*/
+template<class T>
+U32 LinearSearch( const T *elements, U32 count, const T &value ) {
+    for( U32 i=0; i<count; ++i ) {
+        if( elements[i] == value ) {
+            return i;
+        }
+    }
+
+    return RT_INVALID_INDEX;
+}
+
+// SSE2 versions, see RtAlgorithm.cpp
+U32 LinearSearch( const U32 *elements, U32 count, const U32 &value );
+U32 LinearSearch( const U64 *elements, U32 count, const U64 &value );
+
+inline U32 LinearSearch( const I32 *elements, U32 count, const I32 &value ) {
+    return LinearSearch( reinterpret_cast<const U32*>( elements ), count, static_cast<U32>( value ) );
+}
+
+inline U32 LinearSearch( const I64 *elements, U32 count, const I64 &value ) {
+    return LinearSearch( reinterpret_cast<const U64*>( elements ), count, static_cast<U64>( value ) );
+}
+
+/*
+================
+ReverseLinearSearch
+
+Index of the last matching element.
+================
+*/
+template<class T>
+U32 ReverseLinearSearch( const T *elements, U32 count, const T &value ) {
+    for( U32 i=count; i>0; --i ) {
+        if( elements[i-1] == value ) {
+            return i-1;
+        }
+    }
+
+    return RT_INVALID_INDEX;
+}
+
+
+#endif // RT_ALGORITHM_H
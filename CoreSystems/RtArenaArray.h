@@ -0,0 +1,277 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtArenaArray.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Array that grows in place inside its own reserved range of address space, pages are
+                     committed as it fills. While it stays inside the reservation growing never moves or
+                     copies the elements, so pointers to them stay valid and appending is a compare, a
+                     store and an increment.
+
+                     For building up large amounts of POD data of unknown size, file loaders and the like,
+                     when a rough upper bound is known (@maxCount is only address space, none of it costs
+                     memory until it's used). No constructors or destructors are run.
+
+                     17/10/26 - The reservation is made on first use. Running past it moves the array to a fresh
+                                reservation twice the size (the only time the elements are copied and pointers
+                                to them go stale) rather than writing off the end, and a failed reserve or commit
+                                is reported - PushBack() returns false, Append() null and HasFailed() stays true.
+
+===============================================================================
+*/
+
+
+#ifndef RT_ARENA_ARRAY_H
+#define RT_ARENA_ARRAY_H
+
+
+#include "RtCommonHeaders.h"
+#include "RtAssert.h"
+#include "RtMemoryCommon.h"
+#include "RtUncopyable_V.h"
+#include "../PlatformIndependenceLayer/RtVirtualMemory.h"
+
+
+// bytes committed each time the array runs out of room - can be overridden in RtConfiguration.h
+#ifndef ARENA_ARRAY_GROW_SIZE
+    #define ARENA_ARRAY_GROW_SIZE ( 256 * 1024 )
+#endif // ARENA_ARRAY_GROW_SIZE
+
+
+/*
+===============================================================================
+
+Arena Array class
+
+===============================================================================
+*/
+template<class T>
+class ArenaArray : public Uncopyable {
+public:
+                        // room for @maxCount elements is reserved when the first one is added
+    explicit            ArenaArray( size_t maxCount = 0 );
+                        ~ArenaArray( void );
+
+    T &                 operator[]( U32 index ) { return data[index]; }
+    const T &           operator[]( U32 index ) const { return data[index]; }
+
+                        // false (and nothing is added) if the array couldn't grow
+    bool                PushBack( const T &value );
+                        // append @count uninitialised elements, returns the first or null if the array couldn't grow
+    T *                 Append( U32 count );
+
+                        // make sure there's a reservation for at least @maxCount elements, false on failure
+    bool                Reserve( size_t maxCount );
+
+    T *                 GetData( void ) { return data; }
+    const T *           GetData( void ) const { return data; }
+    U32                 Count( void ) const { return count; }
+    bool                IsEmpty( void ) const { return count == 0; }
+                        // a reserve or commit has failed, the array won't grow any more
+    bool                HasFailed( void ) const { return failed; }
+
+                        // empties the array, the committed pages are kept for reuse
+    void                Clear( void );
+
+private:
+    bool                Grow( U32 needed );
+    bool                Relocate( size_t maxCount_ );
+
+    T                 * data;
+    U32                 count;
+    U32                 capacity;
+    bool                failed;
+
+    size_t              maxCount;
+    size_t              reservedBytes;
+    size_t              committedBytes;
+};
+
+
+/*
+================
+ArenaArray::ArenaArray
+================
+*/
+template<class T>
+ArenaArray<T>::ArenaArray( size_t maxCount_ ) {
+    data = NULL;
+    count = 0;
+    capacity = 0;
+    failed = false;
+
+    maxCount = ( maxCount_ > 0 ) ? maxCount_ : 1;
+    reservedBytes = 0;
+    committedBytes = 0;
+}
+
+/*
+================
+ArenaArray::~ArenaArray
+================
+*/
+template<class T>
+ArenaArray<T>::~ArenaArray( void ) {
+    if( data != NULL ) {
+        ReleasePages( data, reservedBytes );
+        data = NULL;
+    }
+}
+
+/*
+================
+ArenaArray::PushBack
+================
+*/
+template<class T>
+bool ArenaArray<T>::PushBack( const T &value ) {
+    if( ( count == capacity ) && ( Grow( 1 ) == false ) ) {
+        return false;
+    }
+
+    data[count++] = value;
+    return true;
+}
+
+/*
+================
+ArenaArray::Append
+================
+*/
+template<class T>
+T * ArenaArray<T>::Append( U32 count_ ) {
+    if( ( ( capacity - count ) < count_ ) && ( Grow( count_ - ( capacity - count ) ) == false ) ) {
+        return NULL;
+    }
+
+    T *first = &data[count];
+    count += count_;
+    return first;
+}
+
+/*
+================
+ArenaArray::Reserve
+================
+*/
+template<class T>
+bool ArenaArray<T>::Reserve( size_t maxCount_ ) {
+    if( maxCount_ <= maxCount ) {
+        return ( failed == false );
+    }
+
+    // nothing to move yet, it's reserved on first use
+    if( data == NULL ) {
+        maxCount = maxCount_;
+        return ( failed == false );
+    }
+
+    if( ( failed == true ) || ( Relocate( maxCount_ ) == false ) ) {
+        failed = true;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+================
+ArenaArray::Clear
+================
+*/
+template<class T>
+void ArenaArray<T>::Clear( void ) {
+    count = 0;
+}
+
+/*
+================
+ArenaArray::Grow
+
+Commits at least another ARENA_ARRAY_GROW_SIZE bytes, moving to a bigger reservation first if
+this one is full.
+================
+*/
+template<class T>
+bool ArenaArray<T>::Grow( U32 needed ) {
+    if( failed == true ) {
+        return false;
+    }
+
+    size_t wanted = static_cast<size_t>( count ) + needed;
+    if( ( data == NULL ) || ( wanted > maxCount ) ) {
+        size_t doubled = ( data == NULL ) ? maxCount : ( maxCount * 2 );
+        if( Relocate( ( doubled > wanted ) ? doubled : wanted ) == false ) {
+            failed = true;
+            return false;
+        }
+    }
+
+    size_t pageSize = GetPageSize( );
+    size_t step = ( wanted * sizeof( T ) ) - committedBytes;
+    step = ( step > ARENA_ARRAY_GROW_SIZE ) ? step : ARENA_ARRAY_GROW_SIZE;
+    step = ( step + ( pageSize - 1 ) ) & ~( pageSize - 1 );
+    if( step > ( reservedBytes - committedBytes ) ) {
+        step = reservedBytes - committedBytes;
+    }
+
+    if( CommitPages( reinterpret_cast<U8*>( data ) + committedBytes, step ) == false ) {
+        failed = true;
+        return false;
+    }
+    committedBytes += step;
+
+    size_t committedCount = committedBytes / sizeof( T );
+    capacity = ( committedCount < 0xFFFFFFFF ) ? static_cast<U32>( committedCount ) : 0xFFFFFFFF;
+    return true;
+}
+
+/*
+================
+ArenaArray::Relocate
+
+Reserves room for @maxCount_ elements and moves the array there, the old reservation is released.
+================
+*/
+template<class T>
+bool ArenaArray<T>::Relocate( size_t maxCount_ ) {
+    size_t pageSize = GetPageSize( );
+    if( maxCount_ > ( ( static_cast<size_t>( -1 ) - pageSize ) / sizeof( T ) ) ) {
+        return false;
+    }
+
+    size_t bytes = ( ( maxCount_ * sizeof( T ) ) + ( pageSize - 1 ) ) & ~( pageSize - 1 );
+    T *block = reinterpret_cast<T*>( ReservePages( bytes ) );
+    if( block == NULL ) {
+        return false;
+    }
+
+    // only what's in use is carried over
+    size_t used = ( ( count * sizeof( T ) ) + ( pageSize - 1 ) ) & ~( pageSize - 1 );
+    if( used > 0 ) {
+        if( CommitPages( block, used ) == false ) {
+            ReleasePages( block, bytes );
+            return false;
+        }
+        CopyMem( data, block, count * sizeof( T ) );
+    }
+
+    if( data != NULL ) {
+        ReleasePages( data, reservedBytes );
+    }
+
+    data = block;
+    maxCount = bytes / sizeof( T );
+    reservedBytes = bytes;
+    committedBytes = used;
+
+    size_t committedCount = committedBytes / sizeof( T );
+    capacity = ( committedCount < 0xFFFFFFFF ) ? static_cast<U32>( committedCount ) : 0xFFFFFFFF;
+    return true;
+}
+
+
+#endif // RT_ARENA_ARRAY_H
@@ -0,0 +1,433 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtCachedPoolAllocator.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Per-thread caching front-end for the dynamic pool allocator. Each thread keeps a small
+                     "magazine" of free elements it can allocate from and free to without touching any
+                     shared state. When a magazine runs dry it is refilled with half a magazine's worth of
+                     elements from the shared depot (a DynamicPoolAllocator behind a spin lock) in one go,
+                     when it overflows half of it is handed back the same way. The depot lock is only taken
+                     once per MAGAZINE_SIZE/2 operations in the worst case.
+
+                     Threads are handed a cache slot the first time they touch any cached pool, at most
+                     MAX_POOL_CACHE_THREADS threads hold a slot at once, any others bypass the cache and go
+                     straight to the depot until a slot frees up. A thread gives its slot back with
+                     ReleasePoolCacheThread() before it exits, which hands its magazine in every cached pool
+                     back to that pool's depot so the slot can be reused. A thread that exits without
+                     calling it strands its slot and the elements in its magazines until the pools are
+                     destroyed.
+
+                     Every pool carries a magazine for every slot, MAX_POOL_CACHE_THREADS cache lines
+                     aligned ThreadCaches - with the defaults (64 slots, 32 element magazines) that's about
+                     20KB (64 bit) per pool whether or not the slots are used.
+
+                     Per-thread hit/miss counters are kept so magazines can be sized, a hit is an
+                     Allocate/DeAllocate served by the magazine, a miss is one that had to visit the depot.
+
+===============================================================================
+*/
+
+
+#ifndef RT_CACHED_POOL_ALLOCATOR_H
+#define RT_CACHED_POOL_ALLOCATOR_H
+
+
+#include "../RtCommonHeaders.h"
+#include "../PlatformIndependenceLayer/RtAtomic.h"
+#include "RtAssert.h"
+#include "RtDynamicPoolAllocator.h"
+#include "RtSpinLock.h"
+#include "RtIntrusiveList.h"
+
+
+// these can be overridden in RtConfiguration.h
+#ifndef DEFAULT_POOL_MAGAZINE_SIZE
+    #define DEFAULT_POOL_MAGAZINE_SIZE 32
+#endif // DEFAULT_POOL_MAGAZINE_SIZE
+
+#ifndef MAX_POOL_CACHE_THREADS
+    #define MAX_POOL_CACHE_THREADS 64
+#endif // MAX_POOL_CACHE_THREADS
+
+
+/*
+===============================================================================
+
+Pool cache registry
+
+Slot bookkeeping shared by every cached pool. Pools register themselves so a thread giving up its
+slot can flush its magazine in each of them.
+
+===============================================================================
+*/
+class PoolCache {
+public:
+                        // hand the magazine in @threadIndex back to the depot and reset its stats
+    virtual void        FlushCacheSlot( U32 threadIndex ) = 0;
+
+    IntrusiveListLink   registryLink;
+
+protected:
+    virtual             ~PoolCache( void ) { }
+};
+
+struct PoolCacheRegistry {
+                        PoolCacheRegistry( void ) { freeSlotCount = nextSlot = 0; }
+
+                        // guards everything below
+    SpinLock            lock;
+    IntrusiveList<PoolCache, &PoolCache::registryLink> pools;
+                        // slots given back by exited threads, read without the lock to see if it's worth taking
+    U32                 freeSlots[MAX_POOL_CACHE_THREADS];
+    volatile U32        freeSlotCount;
+                        // slots never handed out start here
+    U32                 nextSlot;
+};
+
+// no slot assigned yet
+static const U32 POOL_CACHE_NO_THREAD_INDEX = 0xFFFFFFFF;
+
+/*
+================
+GetPoolCacheRegistry
+
+Created by the first cached pool, before any thread can ask for a slot.
+================
+*/
+inline PoolCacheRegistry& GetPoolCacheRegistry( void ) {
+    static PoolCacheRegistry registry;
+    return registry;
+}
+
+/*
+================
+PoolCacheThreadIndex
+
+The calling thread's slot, POOL_CACHE_NO_THREAD_INDEX or MAX_POOL_CACHE_THREADS (none free) if it doesn't have one.
+================
+*/
+inline U32& PoolCacheThreadIndex( void ) {
+    static RT_THREAD_LOCAL U32 threadIndex = POOL_CACHE_NO_THREAD_INDEX;
+    return threadIndex;
+}
+
+/*
+================
+GetPoolCacheThreadIndex
+
+Every thread gets a slot index the first time it asks, shared across all cached pools.
+Returns MAX_POOL_CACHE_THREADS when there are no slots left, a thread without one tries
+again whenever another thread has given one back.
+================
+*/
+inline U32 GetPoolCacheThreadIndex( void ) {
+    U32 &threadIndex = PoolCacheThreadIndex( );
+    if( threadIndex < MAX_POOL_CACHE_THREADS ) {
+        return threadIndex;
+    }
+
+    PoolCacheRegistry &registry = GetPoolCacheRegistry( );
+    if( threadIndex == POOL_CACHE_NO_THREAD_INDEX || AtomicLoad32( &registry.freeSlotCount ) > 0 ) {
+        ScopedSpinLock lock( registry.lock );
+        if( registry.freeSlotCount > 0 ) {
+            threadIndex = registry.freeSlots[registry.freeSlotCount - 1];
+            AtomicStore32( &registry.freeSlotCount, registry.freeSlotCount - 1 );
+        }
+        else {
+            threadIndex = ( registry.nextSlot < MAX_POOL_CACHE_THREADS ) ? registry.nextSlot++ : MAX_POOL_CACHE_THREADS;
+        }
+    }
+
+    return threadIndex;
+}
+
+/*
+================
+ReleasePoolCacheThread
+
+Give the calling thread's slot back, call before a thread that used any cached pool exits. Its
+magazine in every cached pool is returned to that pool's depot first. The thread may carry on
+using cached pools afterwards, it just picks up a slot again.
+================
+*/
+inline void ReleasePoolCacheThread( void ) {
+    U32 &threadIndex = PoolCacheThreadIndex( );
+    if( threadIndex < MAX_POOL_CACHE_THREADS ) {
+        PoolCacheRegistry &registry = GetPoolCacheRegistry( );
+        ScopedSpinLock lock( registry.lock );
+
+        for( PoolCache *pool = registry.pools.GetFirst( ); pool != NULL; pool = registry.pools.GetNext( pool ) ) {
+            pool->FlushCacheSlot( threadIndex );
+        }
+
+        registry.freeSlots[registry.freeSlotCount] = threadIndex;
+        AtomicStore32( &registry.freeSlotCount, registry.freeSlotCount + 1 );
+    }
+
+    threadIndex = POOL_CACHE_NO_THREAD_INDEX;
+}
+
+
+/*
+===============================================================================
+
+Cached Pool Allocator class
+
+===============================================================================
+*/
+template<class T = void, U32 MAGAZINE_SIZE = DEFAULT_POOL_MAGAZINE_SIZE>
+class CachedPoolAllocator : public PoolCache {
+public:
+                        // per-thread cache statistics
+                        struct CacheStats {
+                            CacheStats( void ) { allocHits = allocMisses = freeHits = freeMisses = 0; }
+
+                            U64 allocHits;
+                            U64 allocMisses;
+                            U64 freeHits;
+                            U64 freeMisses;
+                        };
+
+                        CachedPoolAllocator( U32 elementSize_, U32 numberOf = DEFAULT_DYNAMIC_POOL_START_SIZE, U8 alignment = 1 );
+                        ~CachedPoolAllocator( void );
+
+                        // get and return pool elements, safe to call from any thread
+    T                 * Allocate( void );
+    void                DeAllocate( T *putBack );
+
+                        // construct & destruct - not necessary for POD and void
+    template<class U>
+    void                Construct( U *posInMem, const U &val = 0 );
+    template<class U>
+    void                Destruct( U *toDestruct );
+
+                        // hand the calling thread's cached elements back to the depot, it keeps its slot (see ReleasePoolCacheThread)
+    void                FlushThreadCache( void );
+
+                        // statistics for the cache slot @threadIndex (see GetPoolCacheThreadIndex), not synchronised
+    void                GetCacheStats( U32 threadIndex, CacheStats &stats ) const;
+    void                GetThreadCacheStats( CacheStats &stats ) const;
+
+private:
+                        // each thread's cache sits on its own cache line(s)
+                        struct RT_ALIGN( RT_CACHE_LINE_SIZE ) ThreadCache {
+                            ThreadCache( void ) { count = 0; }
+
+                            T        * elements[MAGAZINE_SIZE];
+                            U32        count;
+                            CacheStats stats;
+                        };
+
+    virtual void        FlushCacheSlot( U32 threadIndex );
+
+    void                Refill( ThreadCache &cache );
+    void                Drain( ThreadCache &cache, U32 keep );
+
+    ThreadCache         caches[MAX_POOL_CACHE_THREADS];
+
+                        // shared depot, only touched with depotLock held
+    SpinLock            depotLock;
+    DynamicPoolAllocator<T> depot;
+
+                        CachedPoolAllocator( const CachedPoolAllocator &ref ) { /* do nothing - forbidden op */ }
+    void                operator=( const CachedPoolAllocator &rhs ) { /* do nothing - forbidden op */ }
+};
+
+
+/*
+================
+CachedPoolAllocator<T, MAGAZINE_SIZE>::CachedPoolAllocator
+================
+*/
+template<class T, U32 MAGAZINE_SIZE>
+CachedPoolAllocator<T, MAGAZINE_SIZE>::CachedPoolAllocator( U32 elementSize_, U32 numberOf, U8 alignment ) :
+    depot( elementSize_, numberOf, alignment ) {
+    RT_SLOW_ASSERT( MAGAZINE_SIZE >= 2 );
+
+    PoolCacheRegistry &registry = GetPoolCacheRegistry( );
+    ScopedSpinLock lock( registry.lock );
+    registry.pools.PushBack( this );
+}
+
+/*
+================
+CachedPoolAllocator<T, MAGAZINE_SIZE>::~CachedPoolAllocator
+
+Not thread-safe, every other thread must be done with the pool. Any cached
+elements are returned to the depot so it can release them.
+================
+*/
+template<class T, U32 MAGAZINE_SIZE>
+CachedPoolAllocator<T, MAGAZINE_SIZE>::~CachedPoolAllocator( void ) {
+    {
+        PoolCacheRegistry &registry = GetPoolCacheRegistry( );
+        ScopedSpinLock lock( registry.lock );
+        registry.pools.Remove( this );
+    }
+
+    for( U32 i=0; i<MAX_POOL_CACHE_THREADS; ++i ) {
+        Drain( caches[i], 0 );
+    }
+}
+
+/*
+================
+CachedPoolAllocator<T, MAGAZINE_SIZE>::Allocate
+================
+*/
+template<class T, U32 MAGAZINE_SIZE>
+T* CachedPoolAllocator<T, MAGAZINE_SIZE>::Allocate( void ) {
+    U32 threadIndex = GetPoolCacheThreadIndex( );
+    if( threadIndex == MAX_POOL_CACHE_THREADS ) {
+        // no cache slot for this thread
+        ScopedSpinLock lock( depotLock );
+        return depot.Allocate( );
+    }
+
+    ThreadCache &cache = caches[threadIndex];
+    if( cache.count > 0 ) {
+        ++cache.stats.allocHits;
+    }
+    else {
+        ++cache.stats.allocMisses;
+        Refill( cache );
+    }
+
+    return cache.elements[--cache.count];
+}
+
+/*
+================
+CachedPoolAllocator<T, MAGAZINE_SIZE>::DeAllocate
+
+Elements may be freed on a different thread to the one that allocated them.
+================
+*/
+template<class T, U32 MAGAZINE_SIZE>
+void CachedPoolAllocator<T, MAGAZINE_SIZE>::DeAllocate( T *putBack ) {
+    U32 threadIndex = GetPoolCacheThreadIndex( );
+    if( threadIndex == MAX_POOL_CACHE_THREADS ) {
+        ScopedSpinLock lock( depotLock );
+        depot.DeAllocate( putBack );
+        return;
+    }
+
+    ThreadCache &cache = caches[threadIndex];
+    if( cache.count < MAGAZINE_SIZE ) {
+        ++cache.stats.freeHits;
+    }
+    else {
+        ++cache.stats.freeMisses;
+        Drain( cache, MAGAZINE_SIZE / 2 );
+    }
+
+    cache.elements[cache.count++] = putBack;
+}
+
+/*
+================
+CachedPoolAllocator<T, MAGAZINE_SIZE>::Construct
+================
+*/
+template<class T, U32 MAGAZINE_SIZE>
+template<class U>
+void CachedPoolAllocator<T, MAGAZINE_SIZE>::Construct( U *posInMem, const U &val ) {
+    // use placement new
+    new( reinterpret_cast<void*>( posInMem ) ) U( val );
+}
+
+/*
+================
+CachedPoolAllocator<T, MAGAZINE_SIZE>::Destruct
+================
+*/
+template<class T, U32 MAGAZINE_SIZE>
+template<class U>
+void CachedPoolAllocator<T, MAGAZINE_SIZE>::Destruct( U *toDestruct ) {
+    toDestruct->~U( );
+}
+
+/*
+================
+CachedPoolAllocator<T, MAGAZINE_SIZE>::FlushThreadCache
+================
+*/
+template<class T, U32 MAGAZINE_SIZE>
+void CachedPoolAllocator<T, MAGAZINE_SIZE>::FlushThreadCache( void ) {
+    U32 threadIndex = GetPoolCacheThreadIndex( );
+    if( threadIndex != MAX_POOL_CACHE_THREADS ) {
+        Drain( caches[threadIndex], 0 );
+    }
+}
+
+/*
+================
+CachedPoolAllocator<T, MAGAZINE_SIZE>::GetCacheStats
+================
+*/
+template<class T, U32 MAGAZINE_SIZE>
+void CachedPoolAllocator<T, MAGAZINE_SIZE>::GetCacheStats( U32 threadIndex, CacheStats &stats ) const {
+    RT_SLOW_ASSERT( threadIndex < MAX_POOL_CACHE_THREADS );
+    stats = caches[threadIndex].stats;
+}
+
+/*
+================
+CachedPoolAllocator<T, MAGAZINE_SIZE>::GetThreadCacheStats
+================
+*/
+template<class T, U32 MAGAZINE_SIZE>
+void CachedPoolAllocator<T, MAGAZINE_SIZE>::GetThreadCacheStats( CacheStats &stats ) const {
+    U32 threadIndex = GetPoolCacheThreadIndex( );
+    stats = ( threadIndex != MAX_POOL_CACHE_THREADS ) ? caches[threadIndex].stats : CacheStats( );
+}
+
+/*
+================
+CachedPoolAllocator<T, MAGAZINE_SIZE>::FlushCacheSlot
+
+Called by ReleasePoolCacheThread on the thread that owns the slot.
+================
+*/
+template<class T, U32 MAGAZINE_SIZE>
+void CachedPoolAllocator<T, MAGAZINE_SIZE>::FlushCacheSlot( U32 threadIndex ) {
+    Drain( caches[threadIndex], 0 );
+    caches[threadIndex].stats = CacheStats( );
+}
+
+/*
+================
+CachedPoolAllocator<T, MAGAZINE_SIZE>::Refill
+
+Pull half a magazine from the depot, the depot grows if it has to.
+================
+*/
+template<class T, U32 MAGAZINE_SIZE>
+void CachedPoolAllocator<T, MAGAZINE_SIZE>::Refill( ThreadCache &cache ) {
+    ScopedSpinLock lock( depotLock );
+    while( cache.count < ( MAGAZINE_SIZE / 2 ) ) {
+        cache.elements[cache.count++] = depot.Allocate( );
+    }
+}
+
+/*
+================
+CachedPoolAllocator<T, MAGAZINE_SIZE>::Drain
+
+Hand everything above @keep back to the depot.
+================
+*/
+template<class T, U32 MAGAZINE_SIZE>
+void CachedPoolAllocator<T, MAGAZINE_SIZE>::Drain( ThreadCache &cache, U32 keep ) {
+    ScopedSpinLock lock( depotLock );
+    while( cache.count > keep ) {
+        depot.DeAllocate( cache.elements[--cache.count] );
+    }
+}
+
+
+#endif // RT_CACHED_POOL_ALLOCATOR_H
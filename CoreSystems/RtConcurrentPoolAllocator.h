@@ -0,0 +1,261 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtConcurrentPoolAllocator.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Thread-safe, lock-free variant of the pool allocator. Same usage as PoolAllocator, you can
+                     hand it a pre-allocated buffer (or an offset into one) or set @mem to null and it will
+                     allocate its own local buffer, either way ((elementSize * numberOf) + alignment) bytes are used.
+
+                     The free list is a Treiber stack. Since every element lives in one contiguous buffer an
+                     element can be named by its index, so the head packs a 32 bit index and a 32 bit tag into
+                     a single 64 bit word. Every successful push/pop bumps the tag, which stops the ABA problem
+                     without needing a double-width compare-exchange. Reading a stale element's next index
+                     during a pop is harmless, the memory is never handed back to the os while the pool is alive
+                     and the compare-exchange will fail.
+
+===============================================================================
+*/
+
+
+#ifndef RT_CONCURRENT_POOL_ALLOCATOR_H
+#define RT_CONCURRENT_POOL_ALLOCATOR_H
+
+
+#include "../RtCommonHeaders.h"
+#include "../PlatformIndependenceLayer/RtAtomic.h"
+#include "RtAssert.h"
+
+
+/*
+===============================================================================
+
+Concurrent Pool Allocator class
+
+===============================================================================
+*/
+template<class T = void>
+class ConcurrentPoolAllocator {
+public:
+                        ConcurrentPoolAllocator( U32 elementSize_, U32 numberOf = DEFAULT_STATIC_POOL_START_SIZE, U8 *mem = NULL, U32 offset = 0, U8 alignment = 1 );
+                        ~ConcurrentPoolAllocator( void );
+
+                        // get and return pool elements, safe to call from any thread - returns null when the pool is empty
+    T                 * Allocate( void );
+    void                DeAllocate( T *putBack );
+
+                        // construct & destruct - not necessary for POD and void
+    template<class U>
+    void                Construct( U *posInMem, const U &val = 0 );
+    template<class U>
+    void                Destruct( U *toDestruct );
+
+                        // approximate under contention
+    U32                 GetFreeCount( void ) const;
+
+private:
+                        // index of the next free element, recycled to hold data when in use
+                        struct PoolElement {
+                            U32 next;
+                        };
+
+                        // marks the end of the free list
+    static const U32    NULL_INDEX = 0xFFFFFFFF;
+
+    PoolElement       * GetElement( U32 index ) const;
+
+                        // hand back dynamically allocated memory
+    void                Clear( void );
+
+                        // kept on its own cache line, every thread hammers it
+    RT_ALIGN( RT_CACHE_LINE_SIZE ) volatile U64 head;
+    RT_ALIGN( RT_CACHE_LINE_SIZE ) volatile U32 freeCount;
+
+                        // aligned start of the element buffer
+    U8                * memory;
+                        // what operator new handed us (if usingLocal)
+    U8                * rawMemory;
+    bool                usingLocal;
+
+    U32                 elementSize;
+    U32                 elementCount;
+
+                        ConcurrentPoolAllocator( const ConcurrentPoolAllocator &ref ) { /* do nothing - forbidden op */ }
+    void                operator=( const ConcurrentPoolAllocator &rhs ) { /* do nothing - forbidden op */ }
+};
+
+
+/*
+================
+ConcurrentPoolAllocator<T>::ConcurrentPoolAllocator
+
+Not thread-safe, construct before sharing the pool.
+================
+*/
+template<class T>
+ConcurrentPoolAllocator<T>::ConcurrentPoolAllocator( U32 elementSize_, U32 numberOf, U8 *mem, U32 offset, U8 alignment ) {
+    RT_SLOW_ASSERT( ( alignment < 1 ) == false );
+    RT_SLOW_ASSERT( ( numberOf > 0 ) && ( numberOf < NULL_INDEX ) );
+
+    // elements need to be able to hold the next index, and stay aligned when laid end to end
+    elementSize = ( elementSize_ > sizeof( PoolElement ) ) ? elementSize_ : sizeof( PoolElement );
+    elementSize = ( elementSize + ( alignment - 1 ) ) & ~( static_cast<U32>( alignment ) - 1 );
+    elementCount = numberOf;
+
+    if( mem != NULL ) {
+        rawMemory = &mem[offset];
+        usingLocal = false;
+    }
+    else {
+        rawMemory = reinterpret_cast<U8*>( operator new( ( elementSize * elementCount ) + alignment ) );
+        usingLocal = true;
+    }
+
+    // all elements are equal in size so simply align the start of the buffer
+    size_t temp = reinterpret_cast<size_t>( rawMemory );
+    size_t misalignment = ( temp & ( alignment-1 ) );
+    temp += ( misalignment != 0 ) ? ( alignment - misalignment ) : 0;
+    memory = reinterpret_cast<U8*>( temp );
+
+    // link every element to the next, element 0 ends up at the head
+    for( U32 i=0; i<( elementCount - 1 ); ++i ) {
+        GetElement( i )->next = i + 1;
+    }
+    GetElement( elementCount - 1 )->next = NULL_INDEX;
+
+    head = 0; // tag 0, index 0
+    freeCount = elementCount;
+}
+
+/*
+================
+ConcurrentPoolAllocator<T>::~ConcurrentPoolAllocator
+================
+*/
+template<class T>
+ConcurrentPoolAllocator<T>::~ConcurrentPoolAllocator( void ) {
+    Clear( );
+}
+
+/*
+================
+ConcurrentPoolAllocator<T>::Allocate
+================
+*/
+template<class T>
+T* ConcurrentPoolAllocator<T>::Allocate( void ) {
+    U64 oldHead, newHead;
+    U32 index;
+
+    do {
+        oldHead = AtomicLoad64( &head );
+        index = static_cast<U32>( oldHead );
+
+        if( index == NULL_INDEX ) {
+            // static pool, out of elements - callers are expected to handle it
+            return NULL;
+        }
+
+        // tag lives in the upper 32 bits, bump it so a recycled index can't fool another thread
+        U64 tag = ( oldHead >> 32 ) + 1;
+        newHead = ( tag << 32 ) | GetElement( index )->next;
+    } while( AtomicCompareExchange64( &head, newHead, oldHead ) != oldHead );
+
+    AtomicAdd32( &freeCount, static_cast<U32>( -1 ) );
+
+    return reinterpret_cast<T*>( GetElement( index ) );
+}
+
+/*
+================
+ConcurrentPoolAllocator<T>::DeAllocate
+================
+*/
+template<class T>
+void ConcurrentPoolAllocator<T>::DeAllocate( T *putBack ) {
+    U8 *p = reinterpret_cast<U8*>( putBack );
+    RT_SLOW_ASSERT( ( p >= memory ) && ( p < ( memory + ( elementSize * elementCount ) ) ) );
+
+    U32 index = static_cast<U32>( ( p - memory ) / elementSize );
+    PoolElement *element = GetElement( index );
+
+    U64 oldHead, newHead;
+    do {
+        oldHead = AtomicLoad64( &head );
+        element->next = static_cast<U32>( oldHead );
+
+        U64 tag = ( oldHead >> 32 ) + 1;
+        newHead = ( tag << 32 ) | index;
+    } while( AtomicCompareExchange64( &head, newHead, oldHead ) != oldHead );
+
+    AtomicAdd32( &freeCount, 1 );
+}
+
+/*
+================
+ConcurrentPoolAllocator<T>::Construct
+================
+*/
+template<class T>
+template<class U>
+void ConcurrentPoolAllocator<T>::Construct( U *posInMem, const U &val ) {
+    // use placement new
+    new( reinterpret_cast<void*>( posInMem ) ) U( val );
+}
+
+/*
+================
+ConcurrentPoolAllocator<T>::Destruct
+================
+*/
+template<class T>
+template<class U>
+void ConcurrentPoolAllocator<T>::Destruct( U *toDestruct ) {
+    toDestruct->~U( );
+}
+
+/*
+================
+ConcurrentPoolAllocator<T>::GetFreeCount
+================
+*/
+template<class T>
+U32 ConcurrentPoolAllocator<T>::GetFreeCount( void ) const {
+    return AtomicLoad32( &freeCount );
+}
+
+/*
+================
+ConcurrentPoolAllocator<T>::GetElement
+================
+*/
+template<class T>
+typename ConcurrentPoolAllocator<T>::PoolElement* ConcurrentPoolAllocator<T>::GetElement( U32 index ) const {
+    return reinterpret_cast<PoolElement*>( &memory[static_cast<size_t>( index ) * elementSize] );
+}
+
+/*
+================
+ConcurrentPoolAllocator<T>::Clear
+
+Not thread-safe, every other thread must be done with the pool.
+================
+*/
+template<class T>
+void ConcurrentPoolAllocator<T>::Clear( void ) {
+    head = NULL_INDEX;
+    freeCount = 0;
+
+    if( usingLocal == true ) {
+        operator delete( reinterpret_cast<void*>( rawMemory ) );
+    }
+
+    rawMemory = NULL;
+    memory = NULL;
+}
+
+
+#endif // RT_CONCURRENT_POOL_ALLOCATOR_H
@@ -0,0 +1,496 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtConcurrentQueue.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Bounded lock-free queues for handing work and events between threads.
+
+                     SpscQueue - single producer, single consumer ring buffer. The producer only writes the
+                     tail and the consumer only writes the head, each on its own cache line, and each side
+                     keeps a cached copy of the other's index so it only touches the shared line when the
+                     queue looks full/empty.
+
+                     MpmcQueue - any number of producers and consumers. Every slot carries a sequence number
+                     which says whose turn it is (Dmitry Vyukov's bounded queue): a producer claims a position
+                     with a compare-exchange on the tail, writes the value and bumps the slot's sequence to
+                     hand it to a consumer, consumers do the same on the head. No locks and no allocation
+                     after construction, a stalled thread only holds up the slot it owns.
+
+                     Both round the capacity up to a power of two, the storage comes from the allocator once
+                     at construction. Push returns false when full and Pop returns false when empty, the batch
+                     versions move as many elements as they can in one go and return how many that was.
+
+===============================================================================
+*/
+
+
+#ifndef RT_CONCURRENT_QUEUE_H
+#define RT_CONCURRENT_QUEUE_H
+
+
+#include "RtCommonHeaders.h"
+#include "RtAssert.h"
+#include "RtTypeTraits.h"
+#include "RtUncopyable_V.h"
+#include "RtHeapAllocator.h"
+#include "../PlatformIndependenceLayer/RtAtomic.h"
+
+
+/*
+================
+QueueCapacity
+
+@capacity rounded up to a power of two, at least 2.
+================
+*/
+inline U32 QueueCapacity( U32 capacity ) {
+    RT_ASSERT( capacity <= 0x80000000 );
+
+    U32 rounded = 2;
+    while( rounded < capacity ) {
+        rounded <<= 1;
+    }
+
+    return rounded;
+}
+
+
+/*
+===============================================================================
+
+Single producer single consumer queue
+
+Push* may only be called from one thread at a time, Pop* from one (other) thread at a time.
+
+===============================================================================
+*/
+template<class T, class Allocator = HeapAllocator<U8> >
+class SpscQueue : public Uncopyable {
+public:
+                        SpscQueue( U32 capacity );
+                        // destroys anything left in the queue
+                        ~SpscQueue( void );
+
+                        // producer side
+    bool                Push( const T &value );
+    U32                 PushBatch( const T *values, U32 count );
+
+                        // consumer side
+    bool                Pop( T &out );
+    U32                 PopBatch( T *out, U32 maxCount );
+
+    U32                 Capacity( void ) const { return mask + 1; }
+                        // exact from either side if the other side is idle, approximate otherwise
+    U32                 Count( void ) const { return AtomicLoad32( &tail ) - AtomicLoad32( &head ); }
+    bool                IsEmpty( void ) const { return ( Count( ) == 0 ); }
+
+private:
+                        // indices run freely and wrap, slot = index & mask
+    RT_ALIGN( RT_CACHE_LINE_SIZE ) volatile U32 tail;
+    U32                 cachedHead;
+
+    RT_ALIGN( RT_CACHE_LINE_SIZE ) volatile U32 head;
+    U32                 cachedTail;
+
+    RT_ALIGN( RT_CACHE_LINE_SIZE ) T * slots;
+    U32                 mask;
+    Allocator           allctr;
+};
+
+/*
+================
+SpscQueue<T, Allocator>::SpscQueue
+================
+*/
+template<class T, class Allocator>
+SpscQueue<T, Allocator>::SpscQueue( U32 capacity ) {
+    U32 rounded = QueueCapacity( capacity );
+
+    slots = reinterpret_cast<T*>( RT_ALLOC( allctr, rounded * sizeof( T ), RT_CACHE_LINE_SIZE ) );
+    mask = rounded - 1;
+    head = tail = 0;
+    cachedHead = cachedTail = 0;
+}
+
+/*
+================
+SpscQueue<T, Allocator>::~SpscQueue
+================
+*/
+template<class T, class Allocator>
+SpscQueue<T, Allocator>::~SpscQueue( void ) {
+    for( U32 i=head; i!=tail; ++i ) {
+        slots[i & mask].~T( );
+    }
+
+    allctr.DeAllocate( reinterpret_cast<U8*>( slots ) );
+}
+
+/*
+================
+SpscQueue<T, Allocator>::Push
+================
+*/
+template<class T, class Allocator>
+bool SpscQueue<T, Allocator>::Push( const T &value ) {
+    U32 t = tail;
+    if( ( t - cachedHead ) > mask ) {
+        cachedHead = AtomicLoad32( &head );
+        if( ( t - cachedHead ) > mask ) {
+            return false;
+        }
+    }
+
+    new( reinterpret_cast<void*>( &slots[t & mask] ) ) T( value );
+    // publishes the element
+    AtomicStore32( &tail, t + 1 );
+    return true;
+}
+
+/*
+================
+SpscQueue<T, Allocator>::PushBatch
+
+One tail update for the whole batch.
+================
+*/
+template<class T, class Allocator>
+U32 SpscQueue<T, Allocator>::PushBatch( const T *values, U32 count ) {
+    U32 t = tail;
+    U32 space = ( mask + 1 ) - ( t - cachedHead );
+    if( space < count ) {
+        cachedHead = AtomicLoad32( &head );
+        space = ( mask + 1 ) - ( t - cachedHead );
+    }
+
+    U32 n = ( count < space ) ? count : space;
+    for( U32 i=0; i<n; ++i ) {
+        new( reinterpret_cast<void*>( &slots[( t + i ) & mask] ) ) T( values[i] );
+    }
+
+    if( n > 0 ) {
+        AtomicStore32( &tail, t + n );
+    }
+    return n;
+}
+
+/*
+================
+SpscQueue<T, Allocator>::Pop
+================
+*/
+template<class T, class Allocator>
+bool SpscQueue<T, Allocator>::Pop( T &out ) {
+    U32 h = head;
+    if( h == cachedTail ) {
+        cachedTail = AtomicLoad32( &tail );
+        if( h == cachedTail ) {
+            return false;
+        }
+    }
+
+    T *slot = &slots[h & mask];
+    out = Move( *slot );
+    slot->~T( );
+    // hands the slot back to the producer
+    AtomicStore32( &head, h + 1 );
+    return true;
+}
+
+/*
+================
+SpscQueue<T, Allocator>::PopBatch
+================
+*/
+template<class T, class Allocator>
+U32 SpscQueue<T, Allocator>::PopBatch( T *out, U32 maxCount ) {
+    U32 h = head;
+    U32 available = cachedTail - h;
+    if( available < maxCount ) {
+        cachedTail = AtomicLoad32( &tail );
+        available = cachedTail - h;
+    }
+
+    U32 n = ( maxCount < available ) ? maxCount : available;
+    for( U32 i=0; i<n; ++i ) {
+        T *slot = &slots[( h + i ) & mask];
+        out[i] = Move( *slot );
+        slot->~T( );
+    }
+
+    if( n > 0 ) {
+        AtomicStore32( &head, h + n );
+    }
+    return n;
+}
+
+
+/*
+===============================================================================
+
+Multiple producer multiple consumer queue
+
+A slot at position p is free for the producer claiming p when its sequence is p, and full for the
+consumer claiming p when its sequence is p + 1. Popping sets it to p + capacity, the position that
+next lands on the slot.
+
+===============================================================================
+*/
+template<class T, class Allocator = HeapAllocator<U8> >
+class MpmcQueue : public Uncopyable {
+public:
+                        MpmcQueue( U32 capacity );
+                        // destroys anything left in the queue, no other thread may be using it
+                        ~MpmcQueue( void );
+
+                        // any thread
+    bool                Push( const T &value );
+    U32                 PushBatch( const T *values, U32 count );
+    bool                Pop( T &out );
+    U32                 PopBatch( T *out, U32 maxCount );
+
+    U32                 Capacity( void ) const { return mask + 1; }
+                        // approximate while other threads are pushing/popping
+    U32                 Count( void ) const;
+    bool                IsEmpty( void ) const { return ( Count( ) == 0 ); }
+
+private:
+    struct Slot {
+        volatile U32    sequence;
+        T               value;
+    };
+
+                        // number of consecutive slots from @pos whose sequence is @pos + i + @offset, up to @maxCount
+    U32                 CountReady( U32 pos, U32 offset, U32 maxCount ) const;
+
+    RT_ALIGN( RT_CACHE_LINE_SIZE ) volatile U32 tail;
+    RT_ALIGN( RT_CACHE_LINE_SIZE ) volatile U32 head;
+
+    RT_ALIGN( RT_CACHE_LINE_SIZE ) Slot * slots;
+    U32                 mask;
+    Allocator           allctr;
+};
+
+/*
+================
+MpmcQueue<T, Allocator>::MpmcQueue
+================
+*/
+template<class T, class Allocator>
+MpmcQueue<T, Allocator>::MpmcQueue( U32 capacity ) {
+    U32 rounded = QueueCapacity( capacity );
+
+    slots = reinterpret_cast<Slot*>( RT_ALLOC( allctr, rounded * sizeof( Slot ), RT_CACHE_LINE_SIZE ) );
+    for( U32 i=0; i<rounded; ++i ) {
+        slots[i].sequence = i;
+    }
+    mask = rounded - 1;
+    head = tail = 0;
+}
+
+/*
+================
+MpmcQueue<T, Allocator>::~MpmcQueue
+================
+*/
+template<class T, class Allocator>
+MpmcQueue<T, Allocator>::~MpmcQueue( void ) {
+    for( U32 i=head; i!=tail; ++i ) {
+        slots[i & mask].value.~T( );
+    }
+
+    allctr.DeAllocate( reinterpret_cast<U8*>( slots ) );
+}
+
+/*
+================
+MpmcQueue<T, Allocator>::Push
+================
+*/
+template<class T, class Allocator>
+bool MpmcQueue<T, Allocator>::Push( const T &value ) {
+    U32 pos = AtomicLoad32( &tail );
+    Slot *slot;
+
+    for( ;; ) {
+        slot = &slots[pos & mask];
+        I32 diff = static_cast<I32>( AtomicLoad32( &slot->sequence ) - pos );
+        if( diff == 0 ) {
+            U32 seen = AtomicCompareExchange32( &tail, pos + 1, pos );
+            if( seen == pos ) {
+                break;
+            }
+            pos = seen;
+        }
+        else if( diff < 0 ) {
+            // the consumer from the last lap hasn't freed it - full
+            return false;
+        }
+        else {
+            // another producer got here first
+            pos = AtomicLoad32( &tail );
+        }
+    }
+
+    new( reinterpret_cast<void*>( &slot->value ) ) T( value );
+    AtomicStore32( &slot->sequence, pos + 1 );
+    return true;
+}
+
+/*
+================
+MpmcQueue<T, Allocator>::PushBatch
+
+Claims a run of free slots with a single compare-exchange.
+================
+*/
+template<class T, class Allocator>
+U32 MpmcQueue<T, Allocator>::PushBatch( const T *values, U32 count ) {
+    // nothing to claim, the ready check below would spin on a free slot forever
+    if( count == 0 ) {
+        return 0;
+    }
+
+    U32 pos = AtomicLoad32( &tail );
+    U32 n;
+
+    for( ;; ) {
+        n = CountReady( pos, 0, count );
+        if( n == 0 ) {
+            I32 diff = static_cast<I32>( AtomicLoad32( &slots[pos & mask].sequence ) - pos );
+            if( diff < 0 ) {
+                return 0;
+            }
+            pos = AtomicLoad32( &tail );
+            continue;
+        }
+
+        U32 seen = AtomicCompareExchange32( &tail, pos + n, pos );
+        if( seen == pos ) {
+            break;
+        }
+        pos = seen;
+    }
+
+    for( U32 i=0; i<n; ++i ) {
+        Slot *slot = &slots[( pos + i ) & mask];
+        new( reinterpret_cast<void*>( &slot->value ) ) T( values[i] );
+        AtomicStore32( &slot->sequence, pos + i + 1 );
+    }
+    return n;
+}
+
+/*
+================
+MpmcQueue<T, Allocator>::Pop
+================
+*/
+template<class T, class Allocator>
+bool MpmcQueue<T, Allocator>::Pop( T &out ) {
+    U32 pos = AtomicLoad32( &head );
+    Slot *slot;
+
+    for( ;; ) {
+        slot = &slots[pos & mask];
+        I32 diff = static_cast<I32>( AtomicLoad32( &slot->sequence ) - ( pos + 1 ) );
+        if( diff == 0 ) {
+            U32 seen = AtomicCompareExchange32( &head, pos + 1, pos );
+            if( seen == pos ) {
+                break;
+            }
+            pos = seen;
+        }
+        else if( diff < 0 ) {
+            // not written yet - empty
+            return false;
+        }
+        else {
+            pos = AtomicLoad32( &head );
+        }
+    }
+
+    out = Move( slot->value );
+    slot->value.~T( );
+    AtomicStore32( &slot->sequence, pos + mask + 1 );
+    return true;
+}
+
+/*
+================
+MpmcQueue<T, Allocator>::PopBatch
+================
+*/
+template<class T, class Allocator>
+U32 MpmcQueue<T, Allocator>::PopBatch( T *out, U32 maxCount ) {
+    if( maxCount == 0 ) {
+        return 0;
+    }
+
+    U32 pos = AtomicLoad32( &head );
+    U32 n;
+
+    for( ;; ) {
+        n = CountReady( pos, 1, maxCount );
+        if( n == 0 ) {
+            I32 diff = static_cast<I32>( AtomicLoad32( &slots[pos & mask].sequence ) - ( pos + 1 ) );
+            if( diff < 0 ) {
+                return 0;
+            }
+            pos = AtomicLoad32( &head );
+            continue;
+        }
+
+        U32 seen = AtomicCompareExchange32( &head, pos + n, pos );
+        if( seen == pos ) {
+            break;
+        }
+        pos = seen;
+    }
+
+    for( U32 i=0; i<n; ++i ) {
+        Slot *slot = &slots[( pos + i ) & mask];
+        out[i] = Move( slot->value );
+        slot->value.~T( );
+        AtomicStore32( &slot->sequence, pos + i + mask + 1 );
+    }
+    return n;
+}
+
+/*
+================
+MpmcQueue<T, Allocator>::Count
+================
+*/
+template<class T, class Allocator>
+U32 MpmcQueue<T, Allocator>::Count( void ) const {
+    U32 h = AtomicLoad32( &head );
+    U32 t = AtomicLoad32( &tail );
+    // head can be read before a pop and tail after it
+    I32 diff = static_cast<I32>( t - h );
+    return ( diff > 0 ) ? static_cast<U32>( diff ) : 0;
+}
+
+/*
+================
+MpmcQueue<T, Allocator>::CountReady
+================
+*/
+template<class T, class Allocator>
+U32 MpmcQueue<T, Allocator>::CountReady( U32 pos, U32 offset, U32 maxCount ) const {
+    if( maxCount > ( mask + 1 ) ) {
+        maxCount = mask + 1;
+    }
+
+    U32 n = 0;
+    while( n < maxCount && AtomicLoad32( &slots[( pos + n ) & mask].sequence ) == ( pos + n + offset ) ) {
+        ++n;
+    }
+
+    return n;
+}
+
+
+#endif // RT_CONCURRENT_QUEUE_H
@@ -3,9 +3,13 @@
     -----------
     File        :    DoubleEndedStackAllocator.h
     Author      :    Jamie Taylor
-    Last Edit   :    29/07/12
+    Last Edit   :    17/10/26
     Desc        :    Double Ended Stack fashioned memory allocator.
                      |Bottom->    |    <-Top|
+
+                     17/10/26 - Added markers for both ends, GetMarker()/FreeToMarker() roll one end back in one go and
+                                ScopedDoubleEndedStackFrame does it on scope exit. AllocateNoHeader() skips the allocation
+                                info bytes for callers that only ever free to markers, it can't be passed to DeAllocate().
 */
 #ifndef DOUBLE_ENDED_STACK_ALLOCATOR_H
 #define DOUBLE_ENDED_STACK_ALLOCATOR_H
@@ -21,6 +25,9 @@ template<class T = void>
 class DoubleEndedStackAllocator
 {
 public:
+    // A point in one end of the stack that can be rolled back to (byte offset from the stack base)
+    typedef size_t Marker;
+
     // Ctor - explicit keyword removed when param "mem" default arg was removed
     DoubleEndedStackAllocator(size_t sizeInBytes, U8 *mem, size_t offset = 0);
 
@@ -33,6 +40,13 @@ public:
     // Aligned and unaligned de-allocation
     void DeAllocate(T *freeThis);
 
+    // Aligned and unaligned allocation without the allocation info bytes - free with FreeToMarker()/Clear() only
+    T* AllocateNoHeader(size_t sizeInBytes, U8 alignment = 1, bool fromBottom = true);
+
+    // Get the current bottom/top as a marker, free everything allocated from that end since
+    Marker GetMarker(bool fromBottom = true) const;
+    void FreeToMarker(Marker marker, bool fromBottom = true);
+
     // Construct & destruct - not necessary for POD and void
     template<class U>
     void Construct(U *posInMem, const U &val);
@@ -163,6 +177,64 @@ void DoubleEndedStackAllocator<T>::DeAllocate(T *freeThis)
 }
 /**************************************************************************************************************************/
 
+// Allocation with no allocation info stored, bottom is aligned and bumped up or top is bumped down and aligned
+template<class T>
+T* DoubleEndedStackAllocator<T>::AllocateNoHeader(size_t sizeInBytes, U8 alignment, bool fromBottom)
+{
+    RT_SLOW_ASSERT(!(alignment < 1));
+
+    size_t temp = 0;
+    if(fromBottom)
+    {
+        // get the misalignment - mask = alignment-1, and round up
+        temp = reinterpret_cast<size_t>(bottom);
+        size_t misalignment = (temp & (alignment-1));
+        temp += (misalignment != 0) ? (alignment - misalignment) : 0;
+
+        // don't stray into the other half of the buffer
+        RT_SLOW_ASSERT(!((reinterpret_cast<U8*>(temp) + sizeInBytes) > top));
+        bottom = reinterpret_cast<U8*>(temp) + sizeInBytes;
+    }
+    else
+    {
+        // move down then round down to the alignment
+        temp = reinterpret_cast<size_t>(top) - sizeInBytes;
+        temp &= ~(static_cast<size_t>(alignment) - 1);
+
+        RT_SLOW_ASSERT(!(reinterpret_cast<U8*>(temp) < bottom));
+        top = reinterpret_cast<U8*>(temp);
+    }
+
+    return reinterpret_cast<T*>(temp);
+}
+/**************************************************************************************************************************/
+
+// Get a marker for the current bottom or top
+template<class T>
+typename DoubleEndedStackAllocator<T>::Marker DoubleEndedStackAllocator<T>::GetMarker(bool fromBottom) const
+{
+    return static_cast<Marker>((fromBottom ? bottom : top) - stack);
+}
+/**************************************************************************************************************************/
+
+// Roll one end back to a marker, everything allocated from that end after it is freed
+template<class T>
+void DoubleEndedStackAllocator<T>::FreeToMarker(Marker marker, bool fromBottom)
+{
+    // can only roll back, not forward
+    if(fromBottom)
+    {
+        RT_SLOW_ASSERT(!(&stack[marker] > bottom));
+        bottom = &stack[marker];
+    }
+    else
+    {
+        RT_SLOW_ASSERT(!(&stack[marker] < top));
+        top = &stack[marker];
+    }
+}
+/**************************************************************************************************************************/
+
 // Construct an object at a memory address
 template<class T>
 template<class U>
@@ -186,8 +258,9 @@ void DoubleEndedStackAllocator<T>::Destruct(U *toDestruct)
 template<class T>
 void DoubleEndedStackAllocator<T>::Clear()
 {
-    top = &stack[0];
-    bottom = limit - 1;
+    // same state as after construction
+    bottom = &stack[0];
+    top = limit - 1;
 }
 /**************************************************************************************************************************/
 
@@ -215,4 +288,26 @@ size_t DoubleEndedStackAllocator<T>::GetRemainingSpace() const
 }
 /**************************************************************************************************************************/
 
+/**************************************************************************************************************************/
+// Scoped stack frame for one end of a double ended stack - takes a marker on construction and rolls that end back on destruction
+/**************************************************************************************************************************/
+template<class T = void>
+class ScopedDoubleEndedStackFrame
+{
+public:
+    explicit ScopedDoubleEndedStackFrame(DoubleEndedStackAllocator<T> &_allocator, bool _fromBottom = true) : allocator(_allocator)
+        { fromBottom = _fromBottom; marker = allocator.GetMarker(fromBottom); }
+    ~ScopedDoubleEndedStackFrame() { allocator.FreeToMarker(marker, fromBottom); }
+
+private:
+    DoubleEndedStackAllocator<T> &allocator;
+    typename DoubleEndedStackAllocator<T>::Marker marker;
+    bool fromBottom;
+
+    ScopedDoubleEndedStackFrame(const ScopedDoubleEndedStackFrame &ref) : allocator(ref.allocator) { /*do nothing - forbidden op*/ }
+    void operator=(const ScopedDoubleEndedStackFrame & /*rhs*/) { /*do nothing - forbidden op*/ }
+};
+/**************************************************************************************************************************/
+
+
 #endif // DOUBLE_ENDED_STACK_ALLOCATOR_H
@@ -171,7 +171,8 @@ DoublyLinkedList<T>::DoublyLinkedList(bool _isAligned, U8 _alignment)
     // we cannot simply have the pool allocator as a member as its ctor relies on param values we won't have
     // at compile time and since we want to avoid dynamic allcation where possible, we construct the allocator here,
     // and declare it static so it won't be destroyed upon leaving the ctor, we then set the pointer to it to circumvent scope issues
-    static DynamicPoolAllocator<Node> memallctr(sizeof(Node), 1, alignment); // make 1 node - which'll effectively be the head in the pool allocators internal list (still a usable node) so set to 1
+    // nodes are carved from contiguous slabs so traversal stays cache friendly
+    static DynamicPoolAllocator<Node> memallctr(sizeof(Node), 1, alignment, DEFAULT_DYNAMIC_POOL_SLAB_SIZE); // make 1 node - which'll effectively be the head in the pool allocators internal list (still a usable node) so set to 1
     memAllctr = &memallctr;
 
     // setup the header & tail nodes
@@ -169,12 +169,12 @@ DoublyLinkedList<T>::DoublyLinkedList(bool _isAligned, size_t _alignment)
     isAligned = _isAligned;
 
     // setup the header & tail nodes
-    head = memAllctr.Allocate(sizeof(Node), alignment);
+    head = RT_ALLOC(memAllctr, sizeof(Node), alignment);
     memAllctr.Construct<Node>(head, 0);
     head->next = 0;
     head->prev = 0;
 
-    tail = memAllctr.Allocate(sizeof(Node), alignment);
+    tail = RT_ALLOC(memAllctr, sizeof(Node), alignment);
     memAllctr.Construct<Node>(tail, 0);
     tail->next = 0;
     tail->prev = 0;
@@ -235,7 +235,7 @@ template<class T>
 void DoublyLinkedList<T>::InsertBefore(const Iterator &itr, const T &val)
 {
     // create new node
-    Node *temp = memAllctr.Allocate(sizeof(Node), alignment);
+    Node *temp = RT_ALLOC(memAllctr, sizeof(Node), alignment);
     memAllctr.Construct<Node>(temp, val);
 
     // insert into list
@@ -252,7 +252,7 @@ template<class T>
 void DoublyLinkedList<T>::InsertAfter(const Iterator &itr, const T &val)
 {
     // create new node
-    Node *temp = memAllctr.Allocate(sizeof(Node), alignment);
+    Node *temp = RT_ALLOC(memAllctr, sizeof(Node), alignment);
     memAllctr.Construct<Node>(temp, val);
 
     // insert into list
@@ -3,10 +3,15 @@
     -----------
     File        :    RtDynamicPoolAllocator.h
     Author      :    Jamie Taylor
-    Last Edit   :    03/08/12
+    Last Edit   :    17/10/26
     Desc        :    Dynamic pool memory allocator, will allocate memory for elements dynamically from the heap at runtime. This trades the speed of pre-allocated
                      memory for the flexibility of dynamic allocation. This also uses more memory as we need to make sure each element is aligned as opposed to 
                      simply aligning our pre-allocated buffer; this means memory consumption of ((elementSize + alignment) * numberOf) bytes at any one time.
+
+                     17/10/26 - Added slab growth, pass a non-zero elementsPerSlab and the pool will grow by allocating contiguous slabs of that many
+                                elements (one heap call, one alignment adjustment per slab) and carving them into the free list. Slabs are tracked
+                                so Clear() releases them in bulk, and Shrink() hands fully free slabs back to the heap. elementsPerSlab = 0 keeps
+                                the original one heap call per element behaviour.
 */
 #ifndef RT_DYNAMIC_POOL_ALLOCATOR_H
 #define RT_DYNAMIC_POOL_ALLOCATOR_H
@@ -15,6 +20,12 @@
 #include "../RtCommonHeaders.h"
 
 
+// elements per slab for containers that opt in to slab growth, can be overridden in RtConfiguration.h
+#ifndef DEFAULT_DYNAMIC_POOL_SLAB_SIZE
+    #define DEFAULT_DYNAMIC_POOL_SLAB_SIZE 64
+#endif // DEFAULT_DYNAMIC_POOL_SLAB_SIZE
+
+
 /**************************************************************************************************************************/
 // Definition
 /**************************************************************************************************************************/
@@ -23,7 +34,7 @@ class DynamicPoolAllocator
 {
 public:
     // Ctor
-    DynamicPoolAllocator(U32 _elementSize, U32 numberOf = DEFAULT_DYNAMIC_POOL_START_SIZE, U8 _alignment = 1);
+    DynamicPoolAllocator(U32 _elementSize, U32 numberOf = DEFAULT_DYNAMIC_POOL_START_SIZE, U8 _alignment = 1, U32 _elementsPerSlab = 0);
     // Dtor
     ~DynamicPoolAllocator();
 
@@ -37,6 +48,9 @@ public:
     template<class U>
     void Destruct(U *toDestruct);
 
+    // Slab mode only - release any slab whose elements are all back in the pool, returns the number of slabs released
+    U32 Shrink();
+
 private:
     // Stays in 'linked list' when free, memory holds data when in use 
     // and is 'recycled' to hold address of next element when put back in pool
@@ -45,8 +59,20 @@ private:
         PoolElement *next;
     };
 
+    // Header at the start of each slab, elements follow it (aligned)
+    struct Slab
+    {
+        Slab *next;
+        U8 *elements;
+    };
+
     // Aligned and unaligned allocation - dynamically allocate memory for pool elements
     T* Alloc();
+    // Allocate a new slab and push all of its elements onto the free list
+    void AddSlab();
+    // Find the slab holding an element, slabs must be sorted by address; null if not found
+    static Slab* FindSlab(Slab **sortedSlabs, U32 count, U32 slabBytes, U8 *element);
+    static int CompareSlabs(const void *lhs, const void *rhs);
     // Hand back dynamically allocated memory
     void Clear();
 
@@ -56,6 +82,14 @@ private:
     U32 elementSize;
     // head of the free element 'linked list'
     PoolElement *head;
+
+    // slab mode - 0 when allocating one element at a time
+    U32 elementsPerSlab;
+    // distance between elements within a slab, elementSize rounded up to the alignment
+    U32 elementStride;
+    // all slabs currently held
+    Slab *slabs;
+    U32 slabCount;
 };
 /**************************************************************************************************************************/
 
@@ -64,13 +98,27 @@ private:
 // Implementation 
 /**************************************************************************************************************************/
 template<class T>
-DynamicPoolAllocator<T>::DynamicPoolAllocator(U32 _elementSize, U32 numberOf, U8 _alignment)
+DynamicPoolAllocator<T>::DynamicPoolAllocator(U32 _elementSize, U32 numberOf, U8 _alignment, U32 _elementsPerSlab)
 {
     RT_SLOW_ASSERT(!(_alignment < 1)); // used to avoid having user specify isAligned when freeing
 
     elementSize = (_elementSize > sizeof(PoolElement)) ? _elementSize : sizeof(PoolElement); // - Added back 17.08 | sizeof(T) could arguably stand in for elementSize
     alignment = _alignment;
 
+    elementsPerSlab = _elementsPerSlab;
+    elementStride = (elementSize + (alignment - 1)) & ~(static_cast<U32>(alignment) - 1);
+    slabs = 0;
+    slabCount = 0;
+
+    // slab mode - grow a slab at a time until we have at least numberOf elements
+    if(elementsPerSlab > 0)
+    {
+        head = 0;
+        for(U32 i=0; i<numberOf; i+=elementsPerSlab)
+            AddSlab();
+        return;
+    }
+
     // setup x initial elements - starting with the head
     head  = reinterpret_cast<PoolElement*>(Alloc()); 
     head->next = 0;
@@ -102,7 +150,14 @@ T* DynamicPoolAllocator<T>::Allocate()
         head = head->next;
         return reinterpret_cast<T*>(temp);
     }
-    else //  but the  dynamic variant can grow
+    else if(elementsPerSlab > 0) // but the dynamic variant can grow - a slab at a time
+    {
+        AddSlab();
+        PoolElement *temp = head;
+        head = head->next;
+        return reinterpret_cast<T*>(temp);
+    }
+    else //  or an element at a time
         return Alloc();
 }
 /**************************************************************************************************************************/
@@ -129,6 +184,36 @@ T* DynamicPoolAllocator<T>::Alloc()
 }
 /**************************************************************************************************************************/
 
+// Allocate a slab of elementsPerSlab elements and carve it into the free list; not exposed to user
+template<class T>
+void DynamicPoolAllocator<T>::AddSlab()
+{
+    // one allocation for the header, the alignment adjustment and the elements
+    U8 *raw = reinterpret_cast<U8*>(operator new(sizeof(Slab) + alignment + (elementStride * elementsPerSlab)));
+
+    Slab *slab = reinterpret_cast<Slab*>(raw);
+    size_t temp = reinterpret_cast<size_t>(raw + sizeof(Slab));
+
+    // get the misalignment - mask = alignment-1
+    size_t misalignment = (temp & (alignment-1));
+    // only the slab start needs aligning, the stride keeps the rest aligned
+    temp += (misalignment != 0) ? (alignment - misalignment) : 0;
+    slab->elements = reinterpret_cast<U8*>(temp);
+
+    slab->next = slabs;
+    slabs = slab;
+    ++slabCount;
+
+    // push in reverse so allocation walks the slab front to back
+    for(U32 i=elementsPerSlab; i>0; --i)
+    {
+        PoolElement *element = reinterpret_cast<PoolElement*>(&slab->elements[(i - 1) * elementStride]);
+        element->next = head;
+        head = element;
+    }
+}
+/**************************************************************************************************************************/
+
 // Hand back a pool element; exposed to user
 template<class T>
 void DynamicPoolAllocator<T>::DeAllocate(T *putBack)
@@ -156,10 +241,122 @@ void DynamicPoolAllocator<T>::Destruct(U *toDestruct)
 }
 /**************************************************************************************************************************/
 
+// Release fully free slabs back to the heap; exposed to user
+// Walks the free list, so this is O(free elements * log(slabs)), not for use every frame
+template<class T>
+U32 DynamicPoolAllocator<T>::Shrink()
+{
+    if(elementsPerSlab == 0 || slabCount == 0)
+        return 0;
+
+    U32 slabBytes = elementStride * elementsPerSlab;
+
+    // sort the slabs by address so each free element can be matched to its slab with a binary search,
+    // Slab::next is re-used as a free element counter for the duration
+    Slab **sorted = reinterpret_cast<Slab**>(operator new(sizeof(Slab*) * slabCount));
+    U32 i = 0;
+    for(Slab *slab = slabs; slab != 0; slab = slab->next)
+        sorted[i++] = slab;
+
+    qsort(sorted, slabCount, sizeof(Slab*), &DynamicPoolAllocator<T>::CompareSlabs);
+
+    for(i=0; i<slabCount; ++i)
+        sorted[i]->next = 0;
+
+    for(PoolElement *element = head; element != 0; element = element->next)
+    {
+        Slab *slab = FindSlab(sorted, slabCount, slabBytes, reinterpret_cast<U8*>(element));
+        RT_SLOW_ASSERT(slab != 0);
+        slab->next = reinterpret_cast<Slab*>(reinterpret_cast<size_t>(slab->next) + 1);
+    }
+
+    // rebuild the free list without the elements of the slabs being released
+    PoolElement *keep = 0;
+    PoolElement *element = head;
+    while(element != 0)
+    {
+        PoolElement *next = element->next;
+        Slab *slab = FindSlab(sorted, slabCount, slabBytes, reinterpret_cast<U8*>(element));
+        if(reinterpret_cast<size_t>(slab->next) != elementsPerSlab)
+        {
+            element->next = keep;
+            keep = element;
+        }
+        element = next;
+    }
+    head = keep;
+
+    // release the free slabs and re-link the rest
+    U32 released = 0;
+    slabs = 0;
+    for(i=0; i<slabCount; ++i)
+    {
+        if(reinterpret_cast<size_t>(sorted[i]->next) == elementsPerSlab)
+        {
+            operator delete(reinterpret_cast<void*>(sorted[i]));
+            ++released;
+        }
+        else
+        {
+            sorted[i]->next = slabs;
+            slabs = sorted[i];
+        }
+    }
+    slabCount -= released;
+
+    operator delete(reinterpret_cast<void*>(sorted));
+
+    return released;
+}
+/**************************************************************************************************************************/
+
+// Binary search for the slab whose element range holds @element; not exposed to user
+template<class T>
+typename DynamicPoolAllocator<T>::Slab* DynamicPoolAllocator<T>::FindSlab(Slab **sortedSlabs, U32 count, U32 slabBytes, U8 *element)
+{
+    U32 low = 0, high = count;
+    while(low < high)
+    {
+        U32 mid = low + ((high - low) >> 1);
+        if(element < sortedSlabs[mid]->elements)
+            high = mid;
+        else if(element >= (sortedSlabs[mid]->elements + slabBytes))
+            low = mid + 1;
+        else
+            return sortedSlabs[mid];
+    }
+    return 0;
+}
+/**************************************************************************************************************************/
+
+// qsort callback, order slabs by address; not exposed to user
+template<class T>
+int DynamicPoolAllocator<T>::CompareSlabs(const void *lhs, const void *rhs)
+{
+    size_t l = reinterpret_cast<size_t>(*reinterpret_cast<Slab* const*>(lhs));
+    size_t r = reinterpret_cast<size_t>(*reinterpret_cast<Slab* const*>(rhs));
+    return (l < r) ? -1 : ((l > r) ? 1 : 0);
+}
+/**************************************************************************************************************************/
+
 // Release all memory/pool elements - including head; not exposed to user
 template<class T>
 void DynamicPoolAllocator<T>::Clear()
 {
+    // slab mode - elements don't own their memory, release the slabs in bulk
+    if(elementsPerSlab > 0)
+    {
+        while(slabs != 0)
+        {
+            Slab *temp = slabs;
+            slabs = slabs->next;
+            operator delete(reinterpret_cast<void*>(temp));
+        }
+        slabCount = 0;
+        head = 0;
+        return;
+    }
+
     U8 *toFree = 0;
     PoolElement *temp = 0;
     while(head != 0)
@@ -0,0 +1,559 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtHashMap.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Open addressing hash map in the style of Google's SwissTable.
+
+                     Every slot has a control byte alongside the entry array: EMPTY, DELETED or, for a full
+                     slot, the low 7 bits of its key's hash. Slots are probed 16 at a time - one SSE2 compare
+                     of the group's control bytes against the 7 bit hash finds every candidate in the group,
+                     so keys are only compared when 7 bits of their hash already match, and a group with an
+                     EMPTY byte ends the search. Groups are visited in triangular order (1, 2, 3... groups
+                     apart) which touches every group when the number of groups is a power of two.
+
+                     The table grows once 7/8 of the slots are used. Erased slots become EMPTY when their
+                     group already has an EMPTY slot (no probe can have continued past that group) and
+                     DELETED otherwise, DELETED slots are reclaimed by inserts and when the table is rebuilt.
+
+                     Hasher provides U64 Hash( const K& ) and bool Equal( const K&, const K& ), see
+                     DefaultHasher (integers, enums and pointers by value) and StringHasher (C strings by
+                     contents). The allocator hands out bytes, eg: HeapAllocator<U8>.
+
+                     Pointers to entries stay valid until the table grows (Insert/operator[]/Reserve), erasing
+                     during iteration is fine.
+
+===============================================================================
+*/
+
+
+#ifndef RT_HASH_MAP_H
+#define RT_HASH_MAP_H
+
+
+#include "RtCommonHeaders.h"
+#include "RtAssert.h"
+#include "RtTypeTraits.h"
+#include "RtAlgorithm.h"
+#include "RtUncopyable_V.h"
+#include "RtHeapAllocator.h"
+#include <emmintrin.h>
+#include <string.h>
+
+
+// slots probed per step, one SSE2 register of control bytes
+static const U32 HASH_MAP_GROUP_SIZE = 16;
+
+// control bytes, full slots hold 0-127 so the top bit marks both special values
+static const I8 HASH_MAP_EMPTY = static_cast<I8>( 0x80 );
+static const I8 HASH_MAP_DELETED = static_cast<I8>( 0xFE );
+
+
+/*
+================
+HashMixU64
+
+Finaliser from MurmurHash3, spreads every input bit across the whole result.
+================
+*/
+inline U64 HashMixU64( U64 key ) {
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    key *= 0xC4CEB9FE1A85EC53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+/*
+===============================================================================
+
+Hashers
+
+===============================================================================
+*/
+template<class K>
+struct DefaultHasher {
+    U64                 Hash( const K &key ) const { return HashMixU64( static_cast<U64>( key ) ); }
+    bool                Equal( const K &a, const K &b ) const { return ( a == b ); }
+};
+
+template<class K>
+struct DefaultHasher<K*> {
+    U64                 Hash( K *key ) const { return HashMixU64( static_cast<U64>( reinterpret_cast<size_t>( key ) ) ); }
+    bool                Equal( K *a, K *b ) const { return ( a == b ); }
+};
+
+// null terminated strings, compared by contents (FNV-1a)
+struct StringHasher {
+    U64 Hash( const I8 *key ) const {
+        U64 hash = 0xCBF29CE484222325ULL;
+        for( ; *key != '\0'; ++key ) {
+            hash ^= static_cast<U8>( *key );
+            hash *= 0x100000001B3ULL;
+        }
+        // FNV's low bits are weak, the control bytes use them
+        return HashMixU64( hash );
+    }
+    bool                Equal( const I8 *a, const I8 *b ) const { return ( strcmp( a, b ) == 0 ); }
+};
+
+
+/*
+===============================================================================
+
+Hash Map class
+
+===============================================================================
+*/
+template<class K, class V, class Hasher = DefaultHasher<K>, class Allocator = HeapAllocator<U8> >
+class HashMap : public Uncopyable {
+public:
+    struct Entry {
+                        Entry( const K &key_, const V &value_ ) : key( key_ ), value( value_ ) { }
+
+        K               key;
+        V               value;
+    };
+
+private:
+                        // shared by Iterator and ConstIterator
+                        template<class MapType, class EntryType>
+                        class IteratorBase {
+                        public:
+                                            IteratorBase( void ) { map = NULL; index = 0; }
+                                            IteratorBase( MapType *map_, U32 index_ ) { map = map_; index = index_; }
+
+                            bool            operator==( const IteratorBase &rhs ) const { return ( index == rhs.index && map == rhs.map ); }
+                            bool            operator!=( const IteratorBase &rhs ) const { return !( *this == rhs ); }
+
+                            EntryType &     operator*( void ) const { return map->entries[index]; }
+                            EntryType *     operator->( void ) const { return &map->entries[index]; }
+
+                            IteratorBase &  operator++( void ) { index = map->NextFull( index + 1 ); return *this; }
+                            IteratorBase    operator++( I32 notUsed ) { IteratorBase temp = *this; ++( *this ); return temp; }
+
+                        private:
+                            friend class HashMap;
+                            MapType       * map;
+                            U32             index;
+                        };
+
+public:
+    typedef IteratorBase<HashMap, Entry>                    Iterator;
+    typedef IteratorBase<const HashMap, const Entry>        ConstIterator;
+
+                        HashMap( void );
+                        ~HashMap( void );
+
+                        // null if the key isn't present
+    V *                 Find( const K &key );
+    const V *           Find( const K &key ) const;
+    bool                Contains( const K &key ) const { return ( Find( key ) != NULL ); }
+                        // false (and the existing value is left alone) if the key is already present
+    bool                Insert( const K &key, const V &value );
+                        // the value for @key, default constructed and inserted if it isn't present
+    V &                 operator[]( const K &key );
+                        // false if the key isn't present
+    bool                Erase( const K &key );
+                        // @itr may still be incremented afterwards
+    void                Erase( const Iterator &itr );
+
+                        // make room for @count entries without growing again
+    void                Reserve( U32 count );
+                        // remove every entry, keeps the memory
+    void                Clear( void );
+
+    U32                 Count( void ) const { return count; }
+    U32                 Capacity( void ) const { return capacity; }
+    bool                IsEmpty( void ) const { return ( count == 0 ); }
+
+    Iterator            Begin( void ) { return Iterator( this, NextFull( 0 ) ); }
+    Iterator            End( void ) { return Iterator( this, capacity ); }
+    ConstIterator       CBegin( void ) const { return ConstIterator( this, NextFull( 0 ) ); }
+    ConstIterator       CEnd( void ) const { return ConstIterator( this, capacity ); }
+
+private:
+                        // slot holding @key, capacity if it isn't present
+    U32                 FindSlot( const K &key, U64 hash ) const;
+                        // first EMPTY or DELETED slot on @hash's probe sequence
+    U32                 FindFreeSlot( U64 hash ) const;
+                        // claim a free slot for a key known not to be present, growing if needed
+    U32                 PrepareInsert( U64 hash );
+    void                SetControl( U32 slot, I8 control ) { controls[slot] = control; }
+    void                EraseSlot( U32 slot );
+                        // index of the first full slot at or after @index, capacity if none
+    U32                 NextFull( U32 index ) const;
+                        // move every entry into a new table of @newCapacity slots
+    void                Rehash( U32 newCapacity );
+    void                DestroyEntries( void );
+
+    static U32          MaxLoad( U32 capacity ) { return capacity - ( capacity >> 3 ); }
+    static I8           H2( U64 hash ) { return static_cast<I8>( hash & 0x7F ); }
+    static U32          H1( U64 hash ) { return static_cast<U32>( hash >> 7 ); }
+                        // bit per slot in the group at @controls
+    static U32          MatchByte( const I8 *controls, I8 value );
+    static U32          MatchFree( const I8 *controls );
+
+    Entry             * entries;
+                        // capacity bytes, 16 byte aligned
+    I8                * controls;
+    U32                 capacity;
+    U32                 count;
+                        // inserts into EMPTY slots left before the table has to grow
+    U32                 growthLeft;
+
+    Hasher              hasher;
+    Allocator           allctr;
+};
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::HashMap
+
+Nothing is allocated until the first insert.
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+HashMap<K, V, Hasher, Allocator>::HashMap( void ) {
+    entries = NULL;
+    controls = NULL;
+    capacity = 0;
+    count = 0;
+    growthLeft = 0;
+}
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::~HashMap
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+HashMap<K, V, Hasher, Allocator>::~HashMap( void ) {
+    if( capacity > 0 ) {
+        DestroyEntries( );
+        allctr.DeAllocate( reinterpret_cast<U8*>( entries ) );
+    }
+}
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::Find
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+V* HashMap<K, V, Hasher, Allocator>::Find( const K &key ) {
+    U32 slot = FindSlot( key, hasher.Hash( key ) );
+    return ( slot < capacity ) ? &entries[slot].value : NULL;
+}
+
+template<class K, class V, class Hasher, class Allocator>
+const V* HashMap<K, V, Hasher, Allocator>::Find( const K &key ) const {
+    U32 slot = FindSlot( key, hasher.Hash( key ) );
+    return ( slot < capacity ) ? &entries[slot].value : NULL;
+}
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::Insert
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+bool HashMap<K, V, Hasher, Allocator>::Insert( const K &key, const V &value ) {
+    U64 hash = hasher.Hash( key );
+    if( FindSlot( key, hash ) < capacity ) {
+        return false;
+    }
+
+    U32 slot = PrepareInsert( hash );
+    new( reinterpret_cast<void*>( &entries[slot] ) ) Entry( key, value );
+    return true;
+}
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::operator[]
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+V& HashMap<K, V, Hasher, Allocator>::operator[]( const K &key ) {
+    U64 hash = hasher.Hash( key );
+    U32 slot = FindSlot( key, hash );
+    if( slot < capacity ) {
+        return entries[slot].value;
+    }
+
+    slot = PrepareInsert( hash );
+    new( reinterpret_cast<void*>( &entries[slot] ) ) Entry( key, V( ) );
+    return entries[slot].value;
+}
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::Erase
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+bool HashMap<K, V, Hasher, Allocator>::Erase( const K &key ) {
+    U32 slot = FindSlot( key, hasher.Hash( key ) );
+    if( slot == capacity ) {
+        return false;
+    }
+
+    EraseSlot( slot );
+    return true;
+}
+
+template<class K, class V, class Hasher, class Allocator>
+void HashMap<K, V, Hasher, Allocator>::Erase( const Iterator &itr ) {
+    RT_ASSERT( itr.map == this && itr.index < capacity && controls[itr.index] >= 0 );
+    EraseSlot( itr.index );
+}
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::Reserve
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+void HashMap<K, V, Hasher, Allocator>::Reserve( U32 count_ ) {
+    U32 newCapacity = HASH_MAP_GROUP_SIZE;
+    while( MaxLoad( newCapacity ) < count_ ) {
+        newCapacity <<= 1;
+    }
+
+    if( newCapacity > capacity ) {
+        Rehash( newCapacity );
+    }
+}
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::Clear
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+void HashMap<K, V, Hasher, Allocator>::Clear( void ) {
+    if( capacity == 0 ) {
+        return;
+    }
+
+    DestroyEntries( );
+    memset( controls, HASH_MAP_EMPTY, capacity );
+    count = 0;
+    growthLeft = MaxLoad( capacity );
+}
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::MatchByte
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+U32 HashMap<K, V, Hasher, Allocator>::MatchByte( const I8 *controls_, I8 value ) {
+    __m128i group = _mm_load_si128( reinterpret_cast<const __m128i*>( controls_ ) );
+    return static_cast<U32>( _mm_movemask_epi8( _mm_cmpeq_epi8( group, _mm_set1_epi8( value ) ) ) );
+}
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::MatchFree
+
+EMPTY and DELETED are the only controls with the top bit set.
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+U32 HashMap<K, V, Hasher, Allocator>::MatchFree( const I8 *controls_ ) {
+    return static_cast<U32>( _mm_movemask_epi8( _mm_load_si128( reinterpret_cast<const __m128i*>( controls_ ) ) ) );
+}
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::FindSlot
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+U32 HashMap<K, V, Hasher, Allocator>::FindSlot( const K &key, U64 hash ) const {
+    if( capacity == 0 ) {
+        return 0;
+    }
+
+    U32 groupMask = ( capacity / HASH_MAP_GROUP_SIZE ) - 1;
+    U32 group = H1( hash ) & groupMask;
+    I8 h2 = H2( hash );
+
+    for( U32 probe=1; ; ++probe ) {
+        const I8 *groupControls = &controls[group * HASH_MAP_GROUP_SIZE];
+
+        for( U32 match=MatchByte( groupControls, h2 ); match!=0; match&=( match - 1 ) ) {
+            U32 slot = ( group * HASH_MAP_GROUP_SIZE ) + LowestSetBit( match );
+            if( hasher.Equal( entries[slot].key, key ) ) {
+                return slot;
+            }
+        }
+
+        if( MatchByte( groupControls, HASH_MAP_EMPTY ) != 0 ) {
+            return capacity;
+        }
+
+        // there's always an EMPTY slot somewhere, so this terminates
+        group = ( group + probe ) & groupMask;
+    }
+}
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::FindFreeSlot
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+U32 HashMap<K, V, Hasher, Allocator>::FindFreeSlot( U64 hash ) const {
+    U32 groupMask = ( capacity / HASH_MAP_GROUP_SIZE ) - 1;
+    U32 group = H1( hash ) & groupMask;
+
+    for( U32 probe=1; ; ++probe ) {
+        U32 match = MatchFree( &controls[group * HASH_MAP_GROUP_SIZE] );
+        if( match != 0 ) {
+            return ( group * HASH_MAP_GROUP_SIZE ) + LowestSetBit( match );
+        }
+        group = ( group + probe ) & groupMask;
+    }
+}
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::PrepareInsert
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+U32 HashMap<K, V, Hasher, Allocator>::PrepareInsert( U64 hash ) {
+    U32 slot = ( capacity > 0 ) ? FindFreeSlot( hash ) : 0;
+
+    // reusing a DELETED slot doesn't use up any growth
+    if( capacity == 0 || ( growthLeft == 0 && controls[slot] == HASH_MAP_EMPTY ) ) {
+        // mostly tombstones, rebuilding at the same size is enough
+        if( capacity > 0 && count < ( MaxLoad( capacity ) >> 1 ) ) {
+            Rehash( capacity );
+        }
+        else {
+            Rehash( ( capacity > 0 ) ? ( capacity << 1 ) : HASH_MAP_GROUP_SIZE );
+        }
+        slot = FindFreeSlot( hash );
+    }
+
+    if( controls[slot] == HASH_MAP_EMPTY ) {
+        --growthLeft;
+    }
+    SetControl( slot, H2( hash ) );
+    ++count;
+
+    return slot;
+}
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::EraseSlot
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+void HashMap<K, V, Hasher, Allocator>::EraseSlot( U32 slot ) {
+    entries[slot].~Entry( );
+    --count;
+
+    const I8 *groupControls = &controls[slot & ~( HASH_MAP_GROUP_SIZE - 1 )];
+    if( MatchByte( groupControls, HASH_MAP_EMPTY ) != 0 ) {
+        SetControl( slot, HASH_MAP_EMPTY );
+        ++growthLeft;
+    }
+    else {
+        SetControl( slot, HASH_MAP_DELETED );
+    }
+}
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::NextFull
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+U32 HashMap<K, V, Hasher, Allocator>::NextFull( U32 index ) const {
+    while( index < capacity ) {
+        U32 groupStart = index & ~( HASH_MAP_GROUP_SIZE - 1 );
+        // full slots in this group from index onward
+        U32 full = ~MatchFree( &controls[groupStart] ) & 0xFFFF;
+        full &= ~( ( 1U << ( index - groupStart ) ) - 1 );
+
+        if( full != 0 ) {
+            return groupStart + LowestSetBit( full );
+        }
+        index = groupStart + HASH_MAP_GROUP_SIZE;
+    }
+
+    return capacity;
+}
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::Rehash
+
+Controls follow the entries in a single allocation.
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+void HashMap<K, V, Hasher, Allocator>::Rehash( U32 newCapacity ) {
+    RT_ASSERT( newCapacity >= HASH_MAP_GROUP_SIZE && ( newCapacity & ( newCapacity - 1 ) ) == 0 );
+    RT_ASSERT( MaxLoad( newCapacity ) >= count );
+
+    Entry *oldEntries = entries;
+    I8 *oldControls = controls;
+    U32 oldCapacity = capacity;
+
+    size_t entryBytes = ( ( sizeof( Entry ) * newCapacity ) + 15 ) & ~static_cast<size_t>( 15 );
+    U8 *memory = RT_ALLOC( allctr, entryBytes + newCapacity, 16 );
+    RT_ASSERT( memory != NULL );
+
+    entries = reinterpret_cast<Entry*>( memory );
+    controls = reinterpret_cast<I8*>( memory + entryBytes );
+    capacity = newCapacity;
+    memset( controls, HASH_MAP_EMPTY, capacity );
+
+    // keys are known to be unique, just drop each into the first free slot
+    for( U32 i=0; i<oldCapacity; ++i ) {
+        if( oldControls[i] < 0 ) {
+            continue;
+        }
+
+        U64 hash = hasher.Hash( oldEntries[i].key );
+        U32 slot = FindFreeSlot( hash );
+        SetControl( slot, H2( hash ) );
+        Relocator<Entry>::RelocateDisjoint( &entries[slot], &oldEntries[i], 1 );
+    }
+
+    growthLeft = MaxLoad( capacity ) - count;
+
+    if( oldCapacity > 0 ) {
+        allctr.DeAllocate( reinterpret_cast<U8*>( oldEntries ) );
+    }
+}
+
+/*
+================
+HashMap<K, V, Hasher, Allocator>::DestroyEntries
+================
+*/
+template<class K, class V, class Hasher, class Allocator>
+void HashMap<K, V, Hasher, Allocator>::DestroyEntries( void ) {
+    if( RT_IS_TRIVIALLY_COPYABLE( Entry ) ) {
+        return;
+    }
+
+    for( U32 i=NextFull( 0 ); i<capacity; i=NextFull( i + 1 ) ) {
+        entries[i].~Entry( );
+    }
+}
+
+
+#endif // RT_HASH_MAP_H
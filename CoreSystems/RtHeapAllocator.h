@@ -5,7 +5,7 @@
     ==========
     File        :    RtHeapAllocator.h
     Author      :    Jamie Taylor
-    Last Edit   :    31/07/13
+    Last Edit   :    17/10/26
     Desc        :    Basic heap allocator - uses memory from the heap and thus shouldn't be heavily used.
 
                      Cutom allocators are used since they allow complete control over allocation&construction via
@@ -21,6 +21,12 @@
                                 alloc large blocks for arrays and free with alloc and deAlloc. Also 
                                 revamped to follow new id-inspired code conventions.
 
+                     17/10/26 - Allocations and de-allocations are reported to the memory tracker again (RT_MEMORY_TRACKER),
+                                only once a tracker exists.
+
+                     17/10/26 - Allocate takes the caller's file and line so the tracker can blame the real call site,
+                                use RT_ALLOC( allctr, bytes, alignment ) (RtMemoryCommon.h) to fill them in.
+
 ===============================================================================
 */
 
@@ -32,6 +38,7 @@
 #include "../RtCommonHeaders.h"
 #include "RtAssert.h"
 
+#include "RtMemoryCommon.h"
 #include "RtMemoryTracker.h"
 
 
@@ -48,8 +55,8 @@ public:
          HeapAllocator( void );
          ~HeapAllocator( void );
 
-    // Allocate - get uninitialized memory
-    T*   Allocate( size_t sizeInBytes, U8 alignment = 1 );
+    // Allocate - get uninitialized memory, file/line identify the caller for the memory tracker (see RT_ALLOC)
+    T*   Allocate( size_t sizeInBytes, U8 alignment = 1, const I8 *file = NULL, U32 line = 0 );
 
     // DeAllocate
     void DeAllocate( T *freeThis );
@@ -91,14 +98,21 @@ HeapAllocator<T>::Allocate
 ================
 */
 template<class T>
-T* HeapAllocator<T>::Allocate( size_t sizeInBytes, U8 alignment ) {
+T* HeapAllocator<T>::Allocate( size_t sizeInBytes, U8 alignment, const I8 *file, U32 line ) {
     RT_SLOW_ASSERT( ( alignment < 1 ) == false );
     size_t temp = reinterpret_cast<size_t>( operator new( ( sizeInBytes + alignment ) ) ); // use sizeInBytes, sizeof( void ) = illegal
 
-    // log the allocation if tracker enabled
+    // log the allocation against the caller if tracker enabled
 #ifdef RT_MEMORY_TRACKER
-    void *vp = reinterpret_cast<void*>( temp );
-    //MemoryTracker::GetSingletonReference( ).RecordAlloc( vp, file, line, source, usage, sizeInBytes, alignment );
+    MemoryTracker *tracker = MemoryTracker::GetSingletonPointer( );
+    if( tracker != NULL ) {
+        void *vp = reinterpret_cast<void*>( temp );
+        tracker->RecordAlloc( vp, file, line, sizeInBytes, alignment, DYNAMIC_RETAIL, ENGINE_GENERAL );
+    }
+#else
+    // only the tracker wants to know where it came from
+    static_cast<void>( file );
+    static_cast<void>( line );
 #endif // RT_MEMORY_TRACKER
         
     // get the misalignment
@@ -128,7 +142,10 @@ void HeapAllocator<T>::DeAllocate( T *freeThis ) {
 
     // log the de-allocation if tracker enabled
 #ifdef RT_MEMORY_TRACKER
-    //MemoryTracker::GetSingletonReference().RecordDeAlloc(temp);
+    MemoryTracker *tracker = MemoryTracker::GetSingletonPointer( );
+    if( tracker != NULL ) {
+        tracker->RecordDeAlloc( reinterpret_cast<void*>( temp ) );
+    }
 #endif // RT_MEMORY_TRACKER
 
     operator delete( reinterpret_cast<void*>( temp ) );
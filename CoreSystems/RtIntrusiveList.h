@@ -0,0 +1,316 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtIntrusiveList.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Intrusive linked lists - the links live inside the objects being listed rather than in
+                     nodes the list allocates, so inserting and removing never allocates or copies anything
+                     and removing an object from a doubly linked list is O(1) without searching for it.
+                     Meant for long-lived engine objects that register themselves with a manager.
+
+                     class Mixer {
+                         ...
+                         IntrusiveListLink deviceLink;
+                     };
+                     IntrusiveList<Mixer, &Mixer::deviceLink> mixers;
+
+                     An object can be in as many lists as it has links, but only in one list per link. The
+                     list doesn't own the objects, an object must be removed before it's destroyed.
+
+===============================================================================
+*/
+
+
+#ifndef RT_INTRUSIVE_LIST_H
+#define RT_INTRUSIVE_LIST_H
+
+
+#include "../PlatformIndependenceLayer/RtPlatform.h"
+#include "RtAssert.h"
+#include "RtUncopyable_V.h"
+
+
+/*
+================
+IntrusiveOwner
+
+Object that contains @link, found by subtracting the link's offset within T. Works out the offset
+from a made up (non-null) address, the same thing offsetof does.
+================
+*/
+template<class T, class L, L T::*LINK>
+inline T* IntrusiveOwner( L *link ) {
+    size_t offset = reinterpret_cast<size_t>( &( reinterpret_cast<T*>( 64 )->*LINK ) ) - 64;
+    return reinterpret_cast<T*>( reinterpret_cast<U8*>( link ) - offset );
+}
+
+
+/*
+===============================================================================
+
+Doubly linked intrusive list
+
+===============================================================================
+*/
+struct IntrusiveListLink {
+                        IntrusiveListLink( void ) { prev = next = NULL; }
+                        // copying an object doesn't copy its place in a list, the copy starts unlinked
+                        IntrusiveListLink( const IntrusiveListLink & /*ref*/ ) { prev = next = NULL; }
+    IntrusiveListLink & operator=( const IntrusiveListLink & /*rhs*/ ) { return *this; }
+
+    bool                IsLinked( void ) const { return ( next != NULL ); }
+
+    IntrusiveListLink * prev;
+    IntrusiveListLink * next;
+};
+
+template<class T, IntrusiveListLink T::*LINK>
+class IntrusiveList : public Uncopyable {
+public:
+                        IntrusiveList( void ) { head.prev = head.next = &head; count = 0; }
+                        // unlinks anything still in the list
+                        ~IntrusiveList( void ) { Clear( ); }
+
+    void                PushFront( T *object ) { InsertLink( &( object->*LINK ), &head, head.next ); }
+    void                PushBack( T *object ) { InsertLink( &( object->*LINK ), head.prev, &head ); }
+                        // @position must be in this list
+    void                InsertAfter( T *position, T *object ) { InsertLink( &( object->*LINK ), &( position->*LINK ), ( position->*LINK ).next ); }
+    void                InsertBefore( T *position, T *object ) { InsertLink( &( object->*LINK ), ( position->*LINK ).prev, &( position->*LINK ) ); }
+                        // @object must be in this list
+    void                Remove( T *object );
+                        // null if empty
+    T *                 PopFront( void );
+    T *                 PopBack( void );
+                        // unlink every object
+    void                Clear( void );
+
+                        // null if empty/at the end
+    T *                 GetFirst( void ) const { return ToObject( head.next ); }
+    T *                 GetLast( void ) const { return ToObject( head.prev ); }
+    T *                 GetNext( T *object ) const { return ToObject( ( object->*LINK ).next ); }
+    T *                 GetPrev( T *object ) const { return ToObject( ( object->*LINK ).prev ); }
+
+    U32                 Count( void ) const { return count; }
+    bool                IsEmpty( void ) const { return ( head.next == &head ); }
+
+private:
+    void                InsertLink( IntrusiveListLink *link, IntrusiveListLink *prev, IntrusiveListLink *next );
+    T *                 ToObject( IntrusiveListLink *link ) const;
+
+                        // sentinel, the list is circular through it
+    IntrusiveListLink   head;
+    U32                 count;
+};
+
+/*
+================
+IntrusiveList<T, LINK>::InsertLink
+================
+*/
+template<class T, IntrusiveListLink T::*LINK>
+void IntrusiveList<T, LINK>::InsertLink( IntrusiveListLink *link, IntrusiveListLink *prev, IntrusiveListLink *next ) {
+    RT_ASSERT( link->IsLinked( ) == false );
+
+    link->prev = prev;
+    link->next = next;
+    prev->next = link;
+    next->prev = link;
+    ++count;
+}
+
+/*
+================
+IntrusiveList<T, LINK>::Remove
+================
+*/
+template<class T, IntrusiveListLink T::*LINK>
+void IntrusiveList<T, LINK>::Remove( T *object ) {
+    IntrusiveListLink *link = &( object->*LINK );
+    RT_ASSERT( link->IsLinked( ) == true );
+
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    link->prev = link->next = NULL;
+    --count;
+}
+
+/*
+================
+IntrusiveList<T, LINK>::PopFront
+================
+*/
+template<class T, IntrusiveListLink T::*LINK>
+T* IntrusiveList<T, LINK>::PopFront( void ) {
+    T *object = GetFirst( );
+    if( object != NULL ) {
+        Remove( object );
+    }
+
+    return object;
+}
+
+/*
+================
+IntrusiveList<T, LINK>::PopBack
+================
+*/
+template<class T, IntrusiveListLink T::*LINK>
+T* IntrusiveList<T, LINK>::PopBack( void ) {
+    T *object = GetLast( );
+    if( object != NULL ) {
+        Remove( object );
+    }
+
+    return object;
+}
+
+/*
+================
+IntrusiveList<T, LINK>::Clear
+================
+*/
+template<class T, IntrusiveListLink T::*LINK>
+void IntrusiveList<T, LINK>::Clear( void ) {
+    IntrusiveListLink *link = head.next;
+    while( link != &head ) {
+        IntrusiveListLink *next = link->next;
+        link->prev = link->next = NULL;
+        link = next;
+    }
+
+    head.prev = head.next = &head;
+    count = 0;
+}
+
+/*
+================
+IntrusiveList<T, LINK>::ToObject
+================
+*/
+template<class T, IntrusiveListLink T::*LINK>
+T* IntrusiveList<T, LINK>::ToObject( IntrusiveListLink *link ) const {
+    if( link == &head ) {
+        return NULL;
+    }
+
+    return IntrusiveOwner<T, IntrusiveListLink, LINK>( link );
+}
+
+
+/*
+===============================================================================
+
+Singly linked intrusive list
+
+Half the link size, O(1) at the front only - removing anything else walks the list.
+
+===============================================================================
+*/
+struct IntrusiveSListLink {
+                        IntrusiveSListLink( void ) { next = NULL; }
+                        IntrusiveSListLink( const IntrusiveSListLink & /*ref*/ ) { next = NULL; }
+    IntrusiveSListLink & operator=( const IntrusiveSListLink & /*rhs*/ ) { return *this; }
+
+    IntrusiveSListLink * next;
+};
+
+template<class T, IntrusiveSListLink T::*LINK>
+class IntrusiveSList : public Uncopyable {
+public:
+                        IntrusiveSList( void ) { first = NULL; count = 0; }
+                        ~IntrusiveSList( void ) { Clear( ); }
+
+    void                PushFront( T *object );
+                        // null if empty
+    T *                 PopFront( void );
+                        // false if @object isn't in the list
+    bool                Remove( T *object );
+    void                Clear( void );
+
+    T *                 GetFirst( void ) const { return ToObject( first ); }
+    T *                 GetNext( T *object ) const { return ToObject( ( object->*LINK ).next ); }
+
+    U32                 Count( void ) const { return count; }
+    bool                IsEmpty( void ) const { return ( first == NULL ); }
+
+private:
+    T *                 ToObject( IntrusiveSListLink *link ) const { return ( link != NULL ) ? IntrusiveOwner<T, IntrusiveSListLink, LINK>( link ) : NULL; }
+
+    IntrusiveSListLink * first;
+    U32                 count;
+};
+
+/*
+================
+IntrusiveSList<T, LINK>::PushFront
+================
+*/
+template<class T, IntrusiveSListLink T::*LINK>
+void IntrusiveSList<T, LINK>::PushFront( T *object ) {
+    IntrusiveSListLink *link = &( object->*LINK );
+    link->next = first;
+    first = link;
+    ++count;
+}
+
+/*
+================
+IntrusiveSList<T, LINK>::PopFront
+================
+*/
+template<class T, IntrusiveSListLink T::*LINK>
+T* IntrusiveSList<T, LINK>::PopFront( void ) {
+    IntrusiveSListLink *link = first;
+    if( link == NULL ) {
+        return NULL;
+    }
+
+    first = link->next;
+    link->next = NULL;
+    --count;
+
+    return ToObject( link );
+}
+
+/*
+================
+IntrusiveSList<T, LINK>::Remove
+================
+*/
+template<class T, IntrusiveSListLink T::*LINK>
+bool IntrusiveSList<T, LINK>::Remove( T *object ) {
+    IntrusiveSListLink *link = &( object->*LINK );
+
+    for( IntrusiveSListLink **p=&first; *p!=NULL; p=&( *p )->next ) {
+        if( *p == link ) {
+            *p = link->next;
+            link->next = NULL;
+            --count;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+================
+IntrusiveSList<T, LINK>::Clear
+================
+*/
+template<class T, IntrusiveSListLink T::*LINK>
+void IntrusiveSList<T, LINK>::Clear( void ) {
+    while( first != NULL ) {
+        IntrusiveSListLink *next = first->next;
+        first->next = NULL;
+        first = next;
+    }
+
+    count = 0;
+}
+
+
+#endif // RT_INTRUSIVE_LIST_H
@@ -0,0 +1,375 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtJobSystem.cpp
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Work-stealing job system, see RtJobSystem.h.
+
+===============================================================================
+*/
+
+
+#include "RtJobSystem.h"
+#include "RtCachedPoolAllocator.h"
+
+
+template<> JobSystem *Singleton<JobSystem>::singletonInstance = NULL;
+
+// the worker running on this thread, null on threads that aren't workers
+static RT_THREAD_LOCAL void *currentWorker = NULL;
+
+
+/*
+================
+JobSystem::JobSystem
+================
+*/
+JobSystem::JobSystem( void ) : injected( JOB_INJECTION_QUEUE_CAPACITY ) {
+    workers = NULL;
+    workerCount = 0;
+    wakeUp = NULL;
+    sleeping = 0;
+    quit = 0;
+}
+
+/*
+================
+JobSystem::~JobSystem
+================
+*/
+JobSystem::~JobSystem( void ) {
+    Shutdown( );
+}
+
+/*
+================
+JobSystem::Startup
+================
+*/
+void JobSystem::Startup( U32 workerCount_ ) {
+    RT_ASSERT( workers == NULL );
+
+    workerCount = ( workerCount_ != 0 ) ? workerCount_ : GetHardwareThreadCount( );
+    wakeUp = NewSemaphore( 0 );
+    sleeping = 0;
+    quit = 0;
+
+    workers = reinterpret_cast<Worker*>( RT_ALLOC( memAllctr, workerCount * sizeof( Worker ), RT_CACHE_LINE_SIZE ) );
+    for( U32 i=0; i<workerCount; ++i ) {
+        Worker *worker = new( reinterpret_cast<void*>( &workers[i] ) ) Worker;
+        worker->system = this;
+        worker->thread = NULL;
+        worker->index = i;
+        worker->rngState = i + 1;
+    }
+
+    // the calling thread is worker 0, start the rest once they're all set up since they steal from each other
+    currentWorker = &workers[0];
+    for( U32 i=1; i<workerCount; ++i ) {
+        workers[i].thread = StartThread( WorkerMain, &workers[i] );
+        RT_ASSERT( workers[i].thread != NULL );
+    }
+}
+
+/*
+================
+JobSystem::Shutdown
+================
+*/
+void JobSystem::Shutdown( void ) {
+    if( workers == NULL ) {
+        return;
+    }
+
+    AtomicStore32( &quit, 1 );
+    SignalSemaphore( wakeUp, workerCount );
+    for( U32 i=1; i<workerCount; ++i ) {
+        JoinThread( workers[i].thread );
+    }
+
+    for( U32 i=0; i<workerCount; ++i ) {
+        workers[i].~Worker( );
+    }
+    memAllctr.DeAllocate( reinterpret_cast<U8*>( workers ) );
+    workers = NULL;
+    workerCount = 0;
+    currentWorker = NULL;
+
+    DeleteSemaphore( wakeUp );
+    wakeUp = NULL;
+
+    // anything submitted from outside that never ran
+    Job job;
+    while( injected.Pop( job ) == true ) {
+    }
+}
+
+/*
+================
+JobSystem::Run
+================
+*/
+void JobSystem::Run( JobFunction function, void *param, JobCounter *counter ) {
+    // nothing would ever run it
+    RT_ASSERT( workers != NULL );
+
+    Job job;
+    job.function = function;
+    job.param = param;
+    job.begin = job.end = 0;
+    job.counter = counter;
+
+    if( counter != NULL ) {
+        AtomicAdd32( &counter->count, 1 );
+    }
+
+    Submit( job );
+    WakeWorkers( 1 );
+}
+
+/*
+================
+JobSystem::ParallelFor
+================
+*/
+void JobSystem::ParallelFor( U32 count, U32 batchSize, JobFunction function, void *param ) {
+    RT_ASSERT( workers != NULL );
+
+    if( count == 0 ) {
+        return;
+    }
+
+    if( batchSize == 0 ) {
+        // a few batches per worker so the stealing can even things out (and no divide by zero if not started)
+        U32 batches = ( workerCount > 0 ) ? ( workerCount * 4 ) : 1;
+        batchSize = ( count + batches - 1 ) / batches;
+    }
+
+    U32 jobCount = ( count + batchSize - 1 ) / batchSize;
+    JobCounter counter;
+    AtomicAdd32( &counter.count, jobCount );
+
+    Job job;
+    job.function = function;
+    job.param = param;
+    job.counter = &counter;
+
+    for( U32 begin=0; begin<count; begin+=batchSize ) {
+        job.begin = begin;
+        job.end = ( ( count - begin ) > batchSize ) ? ( begin + batchSize ) : count;
+        Submit( job );
+    }
+
+    WakeWorkers( jobCount );
+    Wait( counter );
+}
+
+/*
+================
+JobSystem::Wait
+================
+*/
+void JobSystem::Wait( JobCounter &counter ) {
+    // not started, only jobs that have already finished can be waited on
+    RT_ASSERT( workers != NULL || counter.IsDone( ) == true );
+
+    Worker *worker = reinterpret_cast<Worker*>( currentWorker );
+    U32 idleSpins = 0;
+
+    while( counter.IsDone( ) == false ) {
+        Job job;
+        if( worker != NULL && GetJob( *worker, job ) == true ) {
+            Execute( *worker, job );
+            idleSpins = 0;
+        }
+        else if( ++idleSpins < JOB_IDLE_SPINS ) {
+            CpuPause( );
+        }
+        else {
+            // whatever we're waiting on is running on another thread
+            YieldThread( );
+        }
+    }
+}
+
+/*
+================
+JobSystem::Submit
+
+Workers push onto their own deque and run the job there and then if it's full, other threads go
+through the injection queue.
+================
+*/
+void JobSystem::Submit( const Job &job ) {
+    Worker *worker = reinterpret_cast<Worker*>( currentWorker );
+    if( worker != NULL ) {
+        if( worker->deque.Push( job ) == false ) {
+            Job copy = job;
+            Execute( *worker, copy );
+        }
+        return;
+    }
+
+    while( injected.Push( job ) == false ) {
+        YieldThread( );
+    }
+}
+
+/*
+================
+JobSystem::WakeWorkers
+
+The fence pairs with the one in Sleep (AtomicAdd32), either we see the sleeper or it sees the job.
+================
+*/
+void JobSystem::WakeWorkers( U32 jobCount ) {
+    MemoryFence( );
+
+    U32 asleep = AtomicLoad32( &sleeping );
+    if( asleep > 0 ) {
+        SignalSemaphore( wakeUp, ( jobCount < asleep ) ? jobCount : asleep );
+    }
+}
+
+/*
+================
+JobSystem::GetJob
+================
+*/
+bool JobSystem::GetJob( Worker &worker, Job &job ) {
+    if( worker.deque.Pop( job ) == true ) {
+        return true;
+    }
+
+    if( injected.Pop( job ) == true ) {
+        return true;
+    }
+
+    // xorshift, so workers don't all pile onto the same victim
+    U32 x = worker.rngState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    worker.rngState = x;
+
+    U32 start = x % workerCount;
+    for( U32 i=0; i<workerCount; ++i ) {
+        Worker &victim = workers[( start + i ) % workerCount];
+        if( &victim != &worker && victim.deque.Steal( job ) == true ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+================
+JobSystem::Execute
+================
+*/
+void JobSystem::Execute( Worker &worker, Job &job ) {
+    JobContext context;
+    context.workerIndex = worker.index;
+    context.scratch = &worker.scratch;
+
+    {
+        ScopedStackFrame<void> frame( worker.scratch );
+        job.function( job.param, job.begin, job.end, context );
+    }
+
+    if( job.counter != NULL ) {
+        AtomicAdd32( &job.counter->count, static_cast<U32>( -1 ) );
+    }
+}
+
+/*
+================
+JobSystem::HasWork
+================
+*/
+bool JobSystem::HasWork( void ) const {
+    if( injected.IsEmpty( ) == false ) {
+        return true;
+    }
+
+    for( U32 i=0; i<workerCount; ++i ) {
+        if( workers[i].deque.IsEmpty( ) == false ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+================
+JobSystem::Sleep
+
+Registers as sleeping before the final look for work, see WakeWorkers. Extra signals only cause
+a spurious wake up.
+================
+*/
+void JobSystem::Sleep( void ) {
+    AtomicAdd32( &sleeping, 1 );
+
+    if( HasWork( ) == false && AtomicLoad32( &quit ) == 0 ) {
+        WaitSemaphore( wakeUp );
+    }
+
+    AtomicAdd32( &sleeping, static_cast<U32>( -1 ) );
+}
+
+/*
+================
+JobSystem::WorkerMain
+================
+*/
+U32 JobSystem::WorkerMain( void *param ) {
+    Worker *worker = reinterpret_cast<Worker*>( param );
+    JobSystem *system = worker->system;
+    currentWorker = worker;
+
+    U32 idleSpins = 0;
+    while( AtomicLoad32( &system->quit ) == 0 ) {
+        Job job;
+        if( system->GetJob( *worker, job ) == true ) {
+            system->Execute( *worker, job );
+            idleSpins = 0;
+        }
+        else if( ++idleSpins < JOB_IDLE_SPINS ) {
+            CpuPause( );
+        }
+        else {
+            idleSpins = 0;
+            system->Sleep( );
+        }
+    }
+
+    // jobs may have used cached pools, give the slot back for the next thread
+    ReleasePoolCacheThread( );
+
+    currentWorker = NULL;
+    return 0;
+}
+
+/*
+================
+JobSystem::GetSingletonReference
+================
+*/
+JobSystem& JobSystem::GetSingletonReference( void ) {
+    return *singletonInstance;
+}
+
+/*
+================
+JobSystem::GetSingletonPointer
+================
+*/
+JobSystem* JobSystem::GetSingletonPointer( void ) {
+    return singletonInstance;
+}
@@ -0,0 +1,179 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtJobSystem.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Work-stealing job system. Startup creates a worker per hardware thread, the thread that
+                     calls Startup is worker 0 and the rest get a thread of their own. Each worker has a
+                     Chase-Lev deque (RtWorkStealingDeque.h): jobs a worker submits go on its own deque, idle
+                     workers steal from the others, and workers with nothing to do sleep on a semaphore.
+                     Threads that aren't workers submit through a shared MpmcQueue.
+
+                     Dependencies are expressed with counters - Run adds to the counter, every job finished
+                     takes one off, and Wait( counter ) keeps the calling worker busy running other jobs until
+                     it reaches zero. No fibers, a job that waits runs the other jobs on top of its own stack.
+
+                     Every job gets its worker's scratch stack (JobContext::scratch), anything allocated from
+                     it is released when the job returns.
+
+                     struct Particles { ... };
+                     void UpdateParticles( void *param, U32 begin, U32 end, JobContext &context ) {
+                         Particles *particles = reinterpret_cast<Particles*>( param );
+                         for( U32 i=begin; i<end; ++i ) ...
+                     }
+                     JobSystem::GetSingletonReference( ).ParallelFor( count, 0, UpdateParticles, &particles );
+
+===============================================================================
+*/
+
+
+#ifndef RT_JOB_SYSTEM_H
+#define RT_JOB_SYSTEM_H
+
+
+#include "RtCommonHeaders.h"
+#include "RtSingleton.h"
+#include "RtHeapAllocator.h"
+#include "RtStackAllocator.h"
+#include "RtConcurrentQueue.h"
+#include "RtWorkStealingDeque.h"
+#include "../PlatformIndependenceLayer/RtAtomic.h"
+#include "../PlatformIndependenceLayer/RtThread.h"
+
+
+// jobs each worker's deque can hold, a worker runs the job itself when its deque is full - can be overridden in RtConfiguration.h
+#ifndef JOB_QUEUE_CAPACITY
+    #define JOB_QUEUE_CAPACITY 4096
+#endif // JOB_QUEUE_CAPACITY
+
+// jobs submitted from non-worker threads waiting to be picked up - can be overridden in RtConfiguration.h
+#ifndef JOB_INJECTION_QUEUE_CAPACITY
+    #define JOB_INJECTION_QUEUE_CAPACITY 1024
+#endif // JOB_INJECTION_QUEUE_CAPACITY
+
+// address space reserved for each worker's scratch stack, committed as it's used - can be overridden in RtConfiguration.h
+#ifndef JOB_SCRATCH_RESERVE
+    #define JOB_SCRATCH_RESERVE ( 8 * 1024 * 1024 )
+#endif // JOB_SCRATCH_RESERVE
+
+// times an idle worker looks for work before going to sleep - can be overridden in RtConfiguration.h
+#ifndef JOB_IDLE_SPINS
+    #define JOB_IDLE_SPINS 256
+#endif // JOB_IDLE_SPINS
+
+
+/*
+================
+JobContext
+
+Handed to every job.
+================
+*/
+struct JobContext {
+    U32                 workerIndex;
+                        // rolled back when the job returns
+    StackAllocator<void> * scratch;
+};
+
+// @begin/@end is the job's range for ParallelFor, 0/0 for jobs started with Run
+typedef void ( *JobFunction )( void *param, U32 begin, U32 end, JobContext &context );
+
+/*
+================
+JobCounter
+
+Number of jobs still to finish, safe to reuse once it's back at zero.
+================
+*/
+struct JobCounter {
+                        JobCounter( void ) { count = 0; }
+
+    bool                IsDone( void ) const { return ( AtomicLoad32( &count ) == 0 ); }
+
+    volatile U32        count;
+};
+
+
+/*
+===============================================================================
+
+Job System class
+
+===============================================================================
+*/
+class JobSystem : public Singleton<JobSystem> {
+public:
+                                        JobSystem( void );
+                                        ~JobSystem( void );
+
+                                        // @workerCount includes the calling thread, 0 for one per hardware thread
+    void                                Startup( U32 workerCount = 0 );
+                                        // jobs still queued are dropped, wait on them first
+    void                                Shutdown( void );
+
+                                        // Run, ParallelFor and Wait need Startup to have been called, nothing runs jobs before that
+                                        // @counter (optional) is incremented now and decremented when the job finishes
+    void                                Run( JobFunction function, void *param, JobCounter *counter = NULL );
+                                        // call @function over [0, count) in ranges of @batchSize (0 picks one) and wait for them all
+    void                                ParallelFor( U32 count, U32 batchSize, JobFunction function, void *param );
+                                        // workers run other jobs while they wait, any other thread just waits
+    void                                Wait( JobCounter &counter );
+
+                                        // including the thread that called Startup
+    U32                                 GetWorkerCount( void ) const { return workerCount; }
+
+    static JobSystem                  & GetSingletonReference( void );
+    static JobSystem                  * GetSingletonPointer( void );
+
+private:
+                                        struct Job {
+                                            JobFunction     function;
+                                            void          * param;
+                                            U32             begin;
+                                            U32             end;
+                                            JobCounter    * counter;
+                                        };
+
+                                        // on its own cache line(s), thieves hammer the deque's top
+                                        struct RT_ALIGN( RT_CACHE_LINE_SIZE ) Worker {
+                                                            Worker( void ) : deque( JOB_QUEUE_CAPACITY ), scratch( STACK_VIRTUAL, JOB_SCRATCH_RESERVE ) { }
+
+                                            WorkStealingDeque<Job> deque;
+                                            StackAllocator<void> scratch;
+                                            JobSystem     * system;
+                                            ThreadHandle    thread;
+                                            U32             index;
+                                                            // picks the first worker to steal from
+                                            U32             rngState;
+                                        };
+
+    void                                Submit( const Job &job );
+                                        // wake up to @jobCount sleeping workers
+    void                                WakeWorkers( U32 jobCount );
+                                        // own deque, then the injection queue, then steal
+    bool                                GetJob( Worker &worker, Job &job );
+    void                                Execute( Worker &worker, Job &job );
+    bool                                HasWork( void ) const;
+    void                                Sleep( void );
+
+    static U32                          WorkerMain( void *param );
+
+    Worker                            * workers;
+    U32                                 workerCount;
+    MpmcQueue<Job>                      injected;
+
+    SemaphoreHandle                     wakeUp;
+    volatile U32                        sleeping;
+    volatile U32                        quit;
+
+    HeapAllocator<U8>                   memAllctr;
+
+                                        JobSystem( const JobSystem &ref );
+    JobSystem                         & operator=( const JobSystem &rhs );
+};
+
+
+#endif // RT_JOB_SYSTEM_H
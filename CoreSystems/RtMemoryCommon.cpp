@@ -5,55 +5,438 @@
     ==========
     File        :    RtMmeoryCommon.cpp
     Author      :    Jamie Taylor
-    Last Edit   :    25/03/13
+    Last Edit   :    17/10/26
     Desc        :    Common os/api independent memory operations.
 
+                     Every routine works the same way: the first and last vector of the range are loaded up
+                     front and stored unaligned at the end, and everything in between is done with aligned
+                     stores. Loading both ends before storing anything also makes the forward copy safe
+                     when the destination is below the source, so MoveMem only needs a second (backward)
+                     loop for the other direction.
+
 ===============================================================================
 */
 
 
 #include "RtMemoryCommon.h"
+#include "../PlatformIndependenceLayer/RtPlatformInfo.h"
+#include <emmintrin.h>
+#include <immintrin.h>
 
 
+/*
+===============================================================================
+
+Small ranges, shorter than a vector
+
+===============================================================================
+*/
+
 /*
 ================
-ZeroMem
+SetSmall
+================
+*/
+static void SetSmall( U8 *dest, U8 value, size_t bytes ) {
+    while( bytes-- ) {
+        *dest++ = value;
+    }
+}
+
+/*
+================
+CopySmall
 
-Set a portion of memory to zero.
+Forward if @dest is below @source, backward otherwise - safe for overlapping ranges.
 ================
 */
-void ZeroMem( void *memory, size_t bytesToSet ) {
-    I8 *p = reinterpret_cast<I8*>( memory );
-    while( bytesToSet-- ) {
-        *p++ = 0;
+static void CopySmall( U8 *dest, const U8 *source, size_t bytes ) {
+    if( dest <= source ) {
+        while( bytes-- ) {
+            *dest++ = *source++;
+        }
+    }
+    else {
+        while( bytes-- ) {
+            dest[bytes] = source[bytes];
+        }
+    }
+}
+
+
+/*
+===============================================================================
+
+SSE2
+
+===============================================================================
+*/
+
+/*
+================
+SetSSE2
+================
+*/
+static void SetSSE2( U8 *dest, U8 value, size_t bytes ) {
+    if( bytes < 16 ) {
+        SetSmall( dest, value, bytes );
+        return;
+    }
+
+    const __m128i v = _mm_set1_epi8( static_cast<char>( value ) );
+    U8 *end = dest + bytes - 16;
+    U8 *p = reinterpret_cast<U8*>( ( reinterpret_cast<size_t>( dest ) + 16 ) & ~static_cast<size_t>( 15 ) );
+
+    if( bytes >= MEMORY_NON_TEMPORAL_THRESHOLD ) {
+        for( ; ( p + 64 ) <= end; p += 64 ) {
+            _mm_stream_si128( reinterpret_cast<__m128i*>( p ), v );
+            _mm_stream_si128( reinterpret_cast<__m128i*>( p + 16 ), v );
+            _mm_stream_si128( reinterpret_cast<__m128i*>( p + 32 ), v );
+            _mm_stream_si128( reinterpret_cast<__m128i*>( p + 48 ), v );
+        }
+        _mm_sfence( );
+    }
+
+    for( ; ( p + 64 ) <= end; p += 64 ) {
+        _mm_store_si128( reinterpret_cast<__m128i*>( p ), v );
+        _mm_store_si128( reinterpret_cast<__m128i*>( p + 16 ), v );
+        _mm_store_si128( reinterpret_cast<__m128i*>( p + 32 ), v );
+        _mm_store_si128( reinterpret_cast<__m128i*>( p + 48 ), v );
+    }
+    for( ; p < end; p += 16 ) {
+        _mm_store_si128( reinterpret_cast<__m128i*>( p ), v );
     }
+
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( dest ), v );
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( end ), v );
 }
 
 /*
 ================
-SetMem
+CopyForwardSSE2
 
-Set a portion of memory to a specific value.
+Safe when @dest is below @source, each block is loaded before anything at or above it is stored.
 ================
 */
-void SetMem( void *memory, U32 value, size_t bytesToSet ) {
-    I8 *p = reinterpret_cast<I8*>( memory );
-    while( bytesToSet-- ) {
-        *p++ = static_cast<I8>( value );
+static void CopyForwardSSE2( U8 *dest, const U8 *source, size_t bytes ) {
+    if( bytes < 16 ) {
+        CopySmall( dest, source, bytes );
+        return;
     }
+
+    const __m128i head = _mm_loadu_si128( reinterpret_cast<const __m128i*>( source ) );
+    const __m128i tail = _mm_loadu_si128( reinterpret_cast<const __m128i*>( source + bytes - 16 ) );
+
+    U8 *end = dest + bytes - 16;
+    U8 *d = reinterpret_cast<U8*>( ( reinterpret_cast<size_t>( dest ) + 16 ) & ~static_cast<size_t>( 15 ) );
+    const U8 *s = source + ( d - dest );
+
+    // only for disjoint ranges, CopyMem is the only caller that gets this big
+    if( bytes >= MEMORY_NON_TEMPORAL_THRESHOLD ) {
+        for( ; ( d + 64 ) <= end; d += 64, s += 64 ) {
+            __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>( s ) );
+            __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i*>( s + 16 ) );
+            __m128i c = _mm_loadu_si128( reinterpret_cast<const __m128i*>( s + 32 ) );
+            __m128i e = _mm_loadu_si128( reinterpret_cast<const __m128i*>( s + 48 ) );
+            _mm_stream_si128( reinterpret_cast<__m128i*>( d ), a );
+            _mm_stream_si128( reinterpret_cast<__m128i*>( d + 16 ), b );
+            _mm_stream_si128( reinterpret_cast<__m128i*>( d + 32 ), c );
+            _mm_stream_si128( reinterpret_cast<__m128i*>( d + 48 ), e );
+        }
+        _mm_sfence( );
+    }
+
+    for( ; ( d + 64 ) <= end; d += 64, s += 64 ) {
+        __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>( s ) );
+        __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i*>( s + 16 ) );
+        __m128i c = _mm_loadu_si128( reinterpret_cast<const __m128i*>( s + 32 ) );
+        __m128i e = _mm_loadu_si128( reinterpret_cast<const __m128i*>( s + 48 ) );
+        _mm_store_si128( reinterpret_cast<__m128i*>( d ), a );
+        _mm_store_si128( reinterpret_cast<__m128i*>( d + 16 ), b );
+        _mm_store_si128( reinterpret_cast<__m128i*>( d + 32 ), c );
+        _mm_store_si128( reinterpret_cast<__m128i*>( d + 48 ), e );
+    }
+    for( ; d < end; d += 16, s += 16 ) {
+        _mm_store_si128( reinterpret_cast<__m128i*>( d ), _mm_loadu_si128( reinterpret_cast<const __m128i*>( s ) ) );
+    }
+
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( dest ), head );
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( end ), tail );
+}
+
+/*
+================
+CopyBackwardSSE2
+
+For @dest above an overlapping @source, works down from the end.
+================
+*/
+static void CopyBackwardSSE2( U8 *dest, const U8 *source, size_t bytes ) {
+    if( bytes < 16 ) {
+        CopySmall( dest, source, bytes );
+        return;
+    }
+
+    const __m128i head = _mm_loadu_si128( reinterpret_cast<const __m128i*>( source ) );
+    const __m128i tail = _mm_loadu_si128( reinterpret_cast<const __m128i*>( source + bytes - 16 ) );
+
+    U8 *start = dest + 16;
+    U8 *d = reinterpret_cast<U8*>( reinterpret_cast<size_t>( dest + bytes ) & ~static_cast<size_t>( 15 ) );
+    const ptrdiff_t offset = source - dest;
+
+    while( ( d - 64 ) >= start ) {
+        d -= 64;
+        __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>( d + offset ) );
+        __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i*>( d + offset + 16 ) );
+        __m128i c = _mm_loadu_si128( reinterpret_cast<const __m128i*>( d + offset + 32 ) );
+        __m128i e = _mm_loadu_si128( reinterpret_cast<const __m128i*>( d + offset + 48 ) );
+        _mm_store_si128( reinterpret_cast<__m128i*>( d + 48 ), e );
+        _mm_store_si128( reinterpret_cast<__m128i*>( d + 32 ), c );
+        _mm_store_si128( reinterpret_cast<__m128i*>( d + 16 ), b );
+        _mm_store_si128( reinterpret_cast<__m128i*>( d ), a );
+    }
+    while( d > start ) {
+        d -= 16;
+        _mm_store_si128( reinterpret_cast<__m128i*>( d ), _mm_loadu_si128( reinterpret_cast<const __m128i*>( d + offset ) ) );
+    }
+
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( dest + bytes - 16 ), tail );
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( dest ), head );
+}
+
+
+/*
+===============================================================================
+
+AVX2 - anything shorter than a ymm register goes to the SSE2 versions
+
+===============================================================================
+*/
+
+/*
+================
+SetAVX2
+================
+*/
+RT_TARGET_AVX2 static void SetAVX2( U8 *dest, U8 value, size_t bytes ) {
+    if( bytes < 32 ) {
+        SetSSE2( dest, value, bytes );
+        return;
+    }
+
+    const __m256i v = _mm256_set1_epi8( static_cast<char>( value ) );
+    U8 *end = dest + bytes - 32;
+    U8 *p = reinterpret_cast<U8*>( ( reinterpret_cast<size_t>( dest ) + 32 ) & ~static_cast<size_t>( 31 ) );
+
+    if( bytes >= MEMORY_NON_TEMPORAL_THRESHOLD ) {
+        for( ; ( p + 128 ) <= end; p += 128 ) {
+            _mm256_stream_si256( reinterpret_cast<__m256i*>( p ), v );
+            _mm256_stream_si256( reinterpret_cast<__m256i*>( p + 32 ), v );
+            _mm256_stream_si256( reinterpret_cast<__m256i*>( p + 64 ), v );
+            _mm256_stream_si256( reinterpret_cast<__m256i*>( p + 96 ), v );
+        }
+        _mm_sfence( );
+    }
+
+    for( ; ( p + 128 ) <= end; p += 128 ) {
+        _mm256_store_si256( reinterpret_cast<__m256i*>( p ), v );
+        _mm256_store_si256( reinterpret_cast<__m256i*>( p + 32 ), v );
+        _mm256_store_si256( reinterpret_cast<__m256i*>( p + 64 ), v );
+        _mm256_store_si256( reinterpret_cast<__m256i*>( p + 96 ), v );
+    }
+    for( ; p < end; p += 32 ) {
+        _mm256_store_si256( reinterpret_cast<__m256i*>( p ), v );
+    }
+
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( dest ), v );
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( end ), v );
+    _mm256_zeroupper( );
+}
+
+/*
+================
+CopyForwardAVX2
+================
+*/
+RT_TARGET_AVX2 static void CopyForwardAVX2( U8 *dest, const U8 *source, size_t bytes ) {
+    if( bytes < 32 ) {
+        CopyForwardSSE2( dest, source, bytes );
+        return;
+    }
+
+    const __m256i head = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( source ) );
+    const __m256i tail = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( source + bytes - 32 ) );
+
+    U8 *end = dest + bytes - 32;
+    U8 *d = reinterpret_cast<U8*>( ( reinterpret_cast<size_t>( dest ) + 32 ) & ~static_cast<size_t>( 31 ) );
+    const U8 *s = source + ( d - dest );
+
+    if( bytes >= MEMORY_NON_TEMPORAL_THRESHOLD ) {
+        for( ; ( d + 128 ) <= end; d += 128, s += 128 ) {
+            __m256i a = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( s ) );
+            __m256i b = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( s + 32 ) );
+            __m256i c = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( s + 64 ) );
+            __m256i e = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( s + 96 ) );
+            _mm256_stream_si256( reinterpret_cast<__m256i*>( d ), a );
+            _mm256_stream_si256( reinterpret_cast<__m256i*>( d + 32 ), b );
+            _mm256_stream_si256( reinterpret_cast<__m256i*>( d + 64 ), c );
+            _mm256_stream_si256( reinterpret_cast<__m256i*>( d + 96 ), e );
+        }
+        _mm_sfence( );
+    }
+
+    for( ; ( d + 128 ) <= end; d += 128, s += 128 ) {
+        __m256i a = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( s ) );
+        __m256i b = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( s + 32 ) );
+        __m256i c = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( s + 64 ) );
+        __m256i e = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( s + 96 ) );
+        _mm256_store_si256( reinterpret_cast<__m256i*>( d ), a );
+        _mm256_store_si256( reinterpret_cast<__m256i*>( d + 32 ), b );
+        _mm256_store_si256( reinterpret_cast<__m256i*>( d + 64 ), c );
+        _mm256_store_si256( reinterpret_cast<__m256i*>( d + 96 ), e );
+    }
+    for( ; d < end; d += 32, s += 32 ) {
+        _mm256_store_si256( reinterpret_cast<__m256i*>( d ), _mm256_loadu_si256( reinterpret_cast<const __m256i*>( s ) ) );
+    }
+
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( dest ), head );
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( end ), tail );
+    _mm256_zeroupper( );
+}
+
+/*
+================
+CopyBackwardAVX2
+================
+*/
+RT_TARGET_AVX2 static void CopyBackwardAVX2( U8 *dest, const U8 *source, size_t bytes ) {
+    if( bytes < 32 ) {
+        CopyBackwardSSE2( dest, source, bytes );
+        return;
+    }
+
+    const __m256i head = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( source ) );
+    const __m256i tail = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( source + bytes - 32 ) );
+
+    U8 *start = dest + 32;
+    U8 *d = reinterpret_cast<U8*>( reinterpret_cast<size_t>( dest + bytes ) & ~static_cast<size_t>( 31 ) );
+    const ptrdiff_t offset = source - dest;
+
+    while( ( d - 128 ) >= start ) {
+        d -= 128;
+        __m256i a = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( d + offset ) );
+        __m256i b = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( d + offset + 32 ) );
+        __m256i c = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( d + offset + 64 ) );
+        __m256i e = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( d + offset + 96 ) );
+        _mm256_store_si256( reinterpret_cast<__m256i*>( d + 96 ), e );
+        _mm256_store_si256( reinterpret_cast<__m256i*>( d + 64 ), c );
+        _mm256_store_si256( reinterpret_cast<__m256i*>( d + 32 ), b );
+        _mm256_store_si256( reinterpret_cast<__m256i*>( d ), a );
+    }
+    while( d > start ) {
+        d -= 32;
+        _mm256_store_si256( reinterpret_cast<__m256i*>( d ), _mm256_loadu_si256( reinterpret_cast<const __m256i*>( d + offset ) ) );
+    }
+
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( dest + bytes - 32 ), tail );
+    _mm256_storeu_si256( reinterpret_cast<__m256i*>( dest ), head );
+    _mm256_zeroupper( );
+}
+
+
+/*
+===============================================================================
+
+Dispatch
+
+===============================================================================
+*/
+struct MemoryOps {
+    void                ( *set )( U8 *dest, U8 value, size_t bytes );
+    void                ( *copyForward )( U8 *dest, const U8 *source, size_t bytes );
+    void                ( *copyBackward )( U8 *dest, const U8 *source, size_t bytes );
+    const I8          * name;
+};
+
+static const MemoryOps sse2Ops = { SetSSE2, CopyForwardSSE2, CopyBackwardSSE2, "SSE2" };
+static const MemoryOps avx2Ops = { SetAVX2, CopyForwardAVX2, CopyBackwardAVX2, "AVX2" };
+
+// picked on first use, threads racing to pick store the same pointer
+static const MemoryOps * volatile memoryOps = NULL;
+
+/*
+================
+GetMemoryOps
+================
+*/
+static const MemoryOps & GetMemoryOps( void ) {
+    const MemoryOps *ops = memoryOps;
+    if( ops == NULL ) {
+        ops = SupportsAVX2( ) ? &avx2Ops : &sse2Ops;
+        memoryOps = ops;
+    }
+
+    return *ops;
+}
+
+
+/*
+================
+ZeroMem
+================
+*/
+void ZeroMem( void *memory, size_t bytesToSet ) {
+    GetMemoryOps( ).set( reinterpret_cast<U8*>( memory ), 0, bytesToSet );
+}
+
+/*
+================
+SetMem
+================
+*/
+void SetMem( void *memory, U32 value, size_t bytesToSet ) {
+    GetMemoryOps( ).set( reinterpret_cast<U8*>( memory ), static_cast<U8>( value ), bytesToSet );
 }
 
 /*
 ================
 CopyMem
+================
+*/
+void CopyMem( const void *source, void *dest, size_t bytesToCopy ) {
+    GetMemoryOps( ).copyForward( reinterpret_cast<U8*>( dest ), reinterpret_cast<const U8*>( source ), bytesToCopy );
+}
+
+/*
+================
+MoveMem
 
-Copies one portion of memory to another
+The forward copy also covers a destination below the source, only a destination above an
+overlapping source needs to go backwards.
 ================
 */
-void CopyMem( void *source, const void *dest, size_t bytesToCopy ) {
-    I8 *src = reinterpret_cast<I8*>( source );
-    I8 *dst = reinterpret_cast<I8*>( const_cast<void*>( dest )  );
-    while( bytesToCopy-- ) {
-        *dst++ = *src++;
+void MoveMem( const void *source, void *dest, size_t bytesToCopy ) {
+    U8 *d = reinterpret_cast<U8*>( dest );
+    const U8 *s = reinterpret_cast<const U8*>( source );
+
+    if( d == s ) {
+        return;
+    }
+
+    const MemoryOps &ops = GetMemoryOps( );
+    if( d < s || ( s + bytesToCopy ) <= d ) {
+        ops.copyForward( d, s, bytesToCopy );
     }
+    else {
+        ops.copyBackward( d, s, bytesToCopy );
+    }
+}
+
+/*
+================
+GetMemoryOpsName
+================
+*/
+const I8 * GetMemoryOpsName( void ) {
+    return GetMemoryOps( ).name;
 }
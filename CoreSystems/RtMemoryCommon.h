@@ -5,9 +5,17 @@
     ==========
     File        :    RtMmeoryCommon.h
     Author      :    Jamie Taylor
-    Last Edit   :    25/03/13
+    Last Edit   :    17/10/26
     Desc        :    Common os/api independent memory operations.
 
+                     17/10/26 - Replaced the byte at a time loops with SSE2 and AVX2 versions, picked once at
+                                runtime from the cpuid feature bits (AVX2 also needs the os to save the ymm
+                                registers). Sizes from MEMORY_NON_TEMPORAL_THRESHOLD up use non-temporal stores
+                                so a big clear/copy doesn't flush the caches. Added MoveMem for overlapping
+                                ranges.
+
+                     17/10/26 - Added RT_ALLOC.
+
 ===============================================================================
 */
 
@@ -17,6 +25,18 @@
 
 
 #include "../PlatformIndependenceLayer/RtPlatform.h"
+#include <stddef.h>
+
+
+// sizes at or above this bypass the caches, roughly the size of a last level cache - can be overridden in RtConfiguration.h
+#ifndef MEMORY_NON_TEMPORAL_THRESHOLD
+    #define MEMORY_NON_TEMPORAL_THRESHOLD ( 4 * 1024 * 1024 )
+#endif // MEMORY_NON_TEMPORAL_THRESHOLD
+
+
+// allocate through allctr passing the calling file/line along, allocators that report to the memory tracker record
+// the allocation against them - allctr needs an Allocate( sizeInBytes, alignment, file, line ) like HeapAllocator's
+#define RT_ALLOC( allctr, sizeInBytes, alignment ) ( allctr ).Allocate( ( sizeInBytes ), ( alignment ), __FILE__, __LINE__ )
 
 
 /*
@@ -24,8 +44,6 @@
 
 Common memory operations
 
-Using while loops here saves 4 assembly/bytecode isntructions over for loops.
-
 ===============================================================================
 */
 
@@ -43,7 +61,7 @@ void ZeroMem( void *memory, size_t bytesToSet );
 ================
 SetMem
 
-Set a portion of memory to a specific value.
+Set a portion of memory to a specific value (the low byte of @value).
 ================
 */
 void SetMem( void *memory, U32 value, size_t bytesToSet );
@@ -52,10 +70,28 @@ void SetMem( void *memory, U32 value, size_t bytesToSet );
 ================
 CopyMem
 
-Copies one portion of memory to another
+Copies one portion of memory to another, the ranges must not overlap.
+================
+*/
+void CopyMem( const void *source, void *dest, size_t bytesToCopy );
+
+/*
+================
+MoveMem
+
+Copies one portion of memory to another, the ranges may overlap.
+================
+*/
+void MoveMem( const void *source, void *dest, size_t bytesToCopy );
+
+/*
+================
+GetMemoryOpsName
+
+Which implementation the memory operations picked, "SSE2" or "AVX2".
 ================
 */
-void CopyMem( void *source, const void *dest, size_t bytesToCopy );
+const I8 * GetMemoryOpsName( void );
 
 
 #endif // RT_MEMORY_COMMON_H
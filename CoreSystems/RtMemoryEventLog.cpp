@@ -0,0 +1,294 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtMemoryEventLog.cpp
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Binary log of allocation events, see RtMemoryEventLog.h.
+
+===============================================================================
+*/
+
+
+#include "RtMemoryEventLog.h"
+#include "RtAssert.h"
+#include "../PlatformIndependenceLayer/RtVirtualMemory.h"
+#include <string.h>
+
+
+// events are written to disk this many bytes at a time
+static const U32 MEMORY_EVENT_WRITE_BUFFER_SIZE = 256 * 1024;
+// slots in the known file set, must be a power of two - once it's full names are simply written again
+static const U32 MEMORY_EVENT_KNOWN_FILES = 4096;
+
+
+/*
+================
+MemoryEventLog::MemoryEventLog
+================
+*/
+MemoryEventLog::MemoryEventLog( void ) {
+    ring = NULL;
+    ringSize = 0;
+    startTime = 0;
+    head = 0;
+    producers = 0;
+    running = 0;
+    tail = 0;
+    writerThread = NULL;
+    file = NULL;
+    writeBuffer = NULL;
+    writeBufferUsed = 0;
+    knownFiles = NULL;
+}
+
+/*
+================
+MemoryEventLog::~MemoryEventLog
+================
+*/
+MemoryEventLog::~MemoryEventLog( void ) {
+    Close( );
+}
+
+/*
+================
+MemoryEventLog::Open
+
+Not thread-safe with respect to Open/Close, Record may be called at any time.
+================
+*/
+bool MemoryEventLog::Open( const I8 *fileName, U32 ringSize_ ) {
+    RT_SLOW_ASSERT( ( ringSize_ & ( ringSize_ - 1 ) ) == 0 );
+    Close( );
+
+    file = fopen( fileName, "wb" );
+    if( file == NULL ) {
+        return false;
+    }
+
+    // everything comes straight from the os so logging never shows up in its own log
+    ringSize = ringSize_;
+    ring = reinterpret_cast<EventSlot*>( AllocatePages( sizeof( EventSlot ) * ringSize ) );
+    writeBuffer = reinterpret_cast<U8*>( AllocatePages( MEMORY_EVENT_WRITE_BUFFER_SIZE ) );
+    knownFiles = reinterpret_cast<U64*>( AllocatePages( sizeof( U64 ) * MEMORY_EVENT_KNOWN_FILES ) );
+    RT_ASSERT( ring != NULL && writeBuffer != NULL && knownFiles != NULL );
+
+    for( U32 i=0; i<ringSize; ++i ) {
+        ring[i].sequence = i;
+    }
+    head = tail = 0;
+    writeBufferUsed = 0;
+
+    startTime = GetMonotonicMicroseconds( );
+
+    MemoryEventLogHeader header;
+    header.magic = MEMORY_EVENT_LOG_MAGIC;
+    header.version = MEMORY_EVENT_LOG_VERSION;
+    header.eventSize = sizeof( MemoryEvent );
+    header.reserved = 0;
+    header.startTime = startTime;
+    fwrite( &header, sizeof( header ), 1, file );
+
+    running = 1;
+    MemoryFence( );
+
+    writerThread = StartThread( WriterThreadEntry, this );
+    if( writerThread == NULL ) {
+        running = 0;
+        Close( );
+        return false;
+    }
+
+    return true;
+}
+
+/*
+================
+MemoryEventLog::Close
+================
+*/
+void MemoryEventLog::Close( void ) {
+    AtomicExchange32( &running, 0 );
+
+    // the writer drains whatever is left before it exits
+    if( writerThread != NULL ) {
+        JoinThread( writerThread );
+        writerThread = NULL;
+    }
+
+    if( file != NULL ) {
+        fclose( file );
+        file = NULL;
+    }
+
+    if( ring != NULL ) {
+        FreePages( ring, sizeof( EventSlot ) * ringSize );
+        FreePages( writeBuffer, MEMORY_EVENT_WRITE_BUFFER_SIZE );
+        FreePages( knownFiles, sizeof( U64 ) * MEMORY_EVENT_KNOWN_FILES );
+    }
+
+    ring = NULL;
+    writeBuffer = NULL;
+    knownFiles = NULL;
+}
+
+/*
+================
+MemoryEventLog::Record
+================
+*/
+void MemoryEventLog::Record( MEMORY_EVENT_TYPE type, void *p, const I8 *file_, U32 line, size_t bytes, U8 alignment, I8 source, I8 usage ) {
+    if( AtomicLoad32( &running ) == 0 ) {
+        return;
+    }
+
+    // Close waits for this to drop to zero, so the ring stays alive while we're using it
+    AtomicAdd32( &producers, 1 );
+    if( AtomicLoad32( &running ) == 0 ) {
+        AtomicAdd32( &producers, static_cast<U32>( -1 ) );
+        return;
+    }
+
+    U64 position = AtomicAdd64( &head, 1 );
+    EventSlot &slot = ring[position & ( ringSize - 1 )];
+
+    // only waits if the ring is full and the writer hasn't caught up yet
+    while( AtomicLoad64( &slot.sequence ) != position ) {
+        CpuPause( );
+    }
+
+    MemoryEvent &event = slot.event;
+    event.timestamp = GetMonotonicMicroseconds( ) - startTime;
+    event.pointer = static_cast<U64>( reinterpret_cast<size_t>( p ) );
+    event.bytes = static_cast<U64>( bytes );
+    event.file = static_cast<U64>( reinterpret_cast<size_t>( file_ ) );
+    event.line = line;
+    event.type = static_cast<U8>( type );
+    event.alignment = alignment;
+    event.source = source;
+    event.usage = usage;
+
+    // publish, sequence goes from position to position + 1
+    AtomicAdd64( &slot.sequence, 1 );
+
+    AtomicAdd32( &producers, static_cast<U32>( -1 ) );
+}
+
+/*
+================
+MemoryEventLog::WriterThreadEntry
+================
+*/
+U32 MemoryEventLog::WriterThreadEntry( void *param ) {
+    reinterpret_cast<MemoryEventLog*>( param )->WriterThread( );
+    return 0;
+}
+
+/*
+================
+MemoryEventLog::WriterThread
+================
+*/
+void MemoryEventLog::WriterThread( void ) {
+    for( ;; ) {
+        U32 written = 0;
+
+        for( ;; ) {
+            EventSlot &slot = ring[tail & ( ringSize - 1 )];
+            if( AtomicLoad64( &slot.sequence ) != ( tail + 1 ) ) {
+                break;
+            }
+
+            MemoryEvent event = slot.event;
+            // hand the slot back to the producer that will claim position tail + ringSize
+            AtomicAdd64( &slot.sequence, ringSize - 1 );
+            ++tail;
+            ++written;
+
+            if( event.file != 0 ) {
+                WriteFileName( event.file );
+            }
+            WriteEvent( event );
+        }
+
+        if( written == 0 ) {
+            FlushWriteBuffer( );
+
+            // once nobody can record any more and everything claimed has been written, we're done
+            if( AtomicLoad32( &running ) == 0 && AtomicLoad32( &producers ) == 0 && AtomicLoad64( &head ) == tail ) {
+                break;
+            }
+
+            SleepThread( 1 );
+        }
+    }
+
+    fflush( file );
+}
+
+/*
+================
+MemoryEventLog::WriteEvent
+================
+*/
+void MemoryEventLog::WriteEvent( const MemoryEvent &event ) {
+    if( ( writeBufferUsed + sizeof( MemoryEvent ) ) > MEMORY_EVENT_WRITE_BUFFER_SIZE ) {
+        FlushWriteBuffer( );
+    }
+
+    memcpy( &writeBuffer[writeBufferUsed], &event, sizeof( MemoryEvent ) );
+    writeBufferUsed += sizeof( MemoryEvent );
+}
+
+/*
+================
+MemoryEventLog::WriteFileName
+
+Writes the name behind @file unless it's been written already. File names are string literals
+(__FILE__) so the address is a stable id and the string outlives the log.
+================
+*/
+void MemoryEventLog::WriteFileName( U64 file_ ) {
+    U32 mask = MEMORY_EVENT_KNOWN_FILES - 1;
+    U32 slot = static_cast<U32>( ( file_ * 0x9E3779B97F4A7C15ULL ) >> 32 ) & mask;
+
+    for( U32 probes=0; probes<MEMORY_EVENT_KNOWN_FILES; ++probes ) {
+        if( knownFiles[slot] == file_ ) {
+            return;
+        }
+        if( knownFiles[slot] == 0 ) {
+            knownFiles[slot] = file_;
+            break;
+        }
+        slot = ( slot + 1 ) & mask;
+    }
+
+    const I8 *name = reinterpret_cast<const I8*>( static_cast<size_t>( file_ ) );
+    U32 length = static_cast<U32>( strlen( name ) );
+
+    MemoryEvent event;
+    memset( &event, 0, sizeof( event ) );
+    event.type = MEMORY_EVENT_FILE_NAME;
+    event.file = file_;
+    event.bytes = length;
+    WriteEvent( event );
+
+    // names can be longer than the write buffer in theory, write them directly
+    FlushWriteBuffer( );
+    fwrite( name, 1, length, file );
+}
+
+/*
+================
+MemoryEventLog::FlushWriteBuffer
+================
+*/
+void MemoryEventLog::FlushWriteBuffer( void ) {
+    if( writeBufferUsed > 0 ) {
+        fwrite( writeBuffer, 1, writeBufferUsed, file );
+        writeBufferUsed = 0;
+    }
+}
@@ -0,0 +1,135 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtMemoryEventLog.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Binary log of allocation events for offline analysis (see Tools/MemoryLogAnalyser).
+
+                     Any thread can Record() an event, it's copied into a bounded lock-free ring buffer and
+                     a background thread drains the ring to disk in large writes. Producers claim a slot
+                     with a single atomic add and each slot carries a sequence number saying whether it's
+                     free or full, so producers never wait on each other, only (if the ring fills up) on
+                     the writer.
+
+                     File layout: a MemoryEventLogHeader followed by MemoryEvents. File names are written
+                     once, the first time they're seen, as a MEMORY_EVENT_FILE_NAME event followed by
+                     event.bytes characters (no terminator). Later events refer to the name by event.file.
+
+===============================================================================
+*/
+
+
+#ifndef RT_MEMORY_EVENT_LOG_H
+#define RT_MEMORY_EVENT_LOG_H
+
+
+#include "../PlatformIndependenceLayer/RtPlatform.h"
+#include "../PlatformIndependenceLayer/RtAtomic.h"
+#include "../PlatformIndependenceLayer/RtThread.h"
+#include "RtUncopyable_V.h"
+#include <stdio.h>
+
+
+// number of events the ring buffer holds, must be a power of two - can be overridden in RtConfiguration.h
+#ifndef DEFAULT_MEMORY_EVENT_RING_SIZE
+    #define DEFAULT_MEMORY_EVENT_RING_SIZE 65536
+#endif // DEFAULT_MEMORY_EVENT_RING_SIZE
+
+
+// "RTML" and format version, bump the version whenever MemoryEvent changes
+static const U32 MEMORY_EVENT_LOG_MAGIC = 0x4C4D5452;
+static const U32 MEMORY_EVENT_LOG_VERSION = 1;
+
+enum MEMORY_EVENT_TYPE {
+    MEMORY_EVENT_ALLOC = 0,
+    MEMORY_EVENT_DEALLOC,
+    // introduces a file name, see file layout above
+    MEMORY_EVENT_FILE_NAME,
+};
+
+struct MemoryEventLogHeader {
+    U32                 magic;
+    U32                 version;
+                        // sizeof( MemoryEvent ) when the log was written
+    U32                 eventSize;
+    U32                 reserved;
+                        // GetMonotonicMicroseconds( ) when the log was opened
+    U64                 startTime;
+};
+
+// 40 bytes, laid out so there's no padding
+struct MemoryEvent {
+                        // microseconds since the log was opened
+    U64                 timestamp;
+    U64                 pointer;
+    U64                 bytes;
+                        // file id (the address of the file name string), 0 if unknown
+    U64                 file;
+    U32                 line;
+    U8                  type;
+    U8                  alignment;
+    I8                  source;
+    I8                  usage;
+};
+
+
+/*
+===============================================================================
+
+Memory Event Log class
+
+===============================================================================
+*/
+class MemoryEventLog : public Uncopyable {
+public:
+                        MemoryEventLog( void );
+                        ~MemoryEventLog( void );
+
+                        // start logging to @fileName, @ringSize must be a power of two - false if the file can't be opened
+    bool                Open( const I8 *fileName, U32 ringSize = DEFAULT_MEMORY_EVENT_RING_SIZE );
+                        // write out everything recorded so far and stop, events recorded after this are ignored
+    void                Close( void );
+    bool                IsOpen( void ) const { return ( AtomicLoad32( &running ) != 0 ); }
+
+                        // safe to call from any thread, does nothing if the log isn't open
+    void                Record( MEMORY_EVENT_TYPE type, void *p, const I8 *file, U32 line, size_t bytes, U8 alignment, I8 source, I8 usage );
+
+private:
+                        // a ring entry is free for producer n when sequence == n, and full for the writer when sequence == n + 1
+                        struct EventSlot {
+                            volatile U64    sequence;
+                            MemoryEvent     event;
+                        };
+
+    static U32          WriterThreadEntry( void *param );
+    void                WriterThread( void );
+
+                        // writer thread only
+    void                WriteEvent( const MemoryEvent &event );
+    void                WriteFileName( U64 file );
+    void                FlushWriteBuffer( void );
+
+    EventSlot         * ring;
+    U32                 ringSize;
+    U64                 startTime;
+
+    RT_ALIGN( RT_CACHE_LINE_SIZE ) volatile U64 head;
+                        // recorders that have checked running but not yet published their event
+    RT_ALIGN( RT_CACHE_LINE_SIZE ) volatile U32 producers;
+    volatile U32        running;
+
+                        // writer thread state
+    RT_ALIGN( RT_CACHE_LINE_SIZE ) U64 tail;
+    ThreadHandle        writerThread;
+    FILE              * file;
+    U8                * writeBuffer;
+    U32                 writeBufferUsed;
+                        // open addressed set of file ids already written, 0 = empty
+    U64               * knownFiles;
+};
+
+
+#endif // RT_MEMORY_EVENT_LOG_H
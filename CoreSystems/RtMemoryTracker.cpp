@@ -3,7 +3,7 @@
     -----------
     File        :    RtMemoryTracker.cpp
     Author      :    Jamie Taylor
-    Last Edit   :    12/08/12
+    Last Edit   :    17/10/26
     Desc        :    Basic memory tracker, at the base level it tracks the memory consumption and peak memory consumption
                      of each engine component peak memory usage for each engine component and/or each component of the application
                      being developed with the engine.
@@ -12,26 +12,44 @@
                      With RT_MEMORY_TRACKER_FULL enabled a hash table of AllocDesc structs will be maintained and flushed to a file
                      when the tracker shuts down.
 
-                    Use an open-hasing/chaining approach when hash-tables are done as we can't accurately predict table load.
+                    17/10/26 - Allocation records now live in an open-addressing table, see RtMemoryTracker.h.
+
+                    17/10/26 - Usage and peak usage are tracked exactly under the table lock rather than sampled.
+
+                    17/10/26 - Added the binary event log, see RtMemoryEventLog.h.
 */ 
 #include "RtMemoryTracker.h"
+#include "../PlatformIndependenceLayer/RtVirtualMemory.h"
 
 
 #ifdef RT_MEMORY_TRACKER
 
 
+    // table slot states, no real allocation lives at either address
+    static void * const EMPTY_SLOT = 0;
+    static void * const TOMBSTONE_SLOT = reinterpret_cast<void*>(1);
+
+    // spread the address bits over the table - the low bits are mostly alignment so drop them, then fibonacci hash
+    static inline U32 HashAddress(void *p)
+    {
+        U64 key = static_cast<U64>(reinterpret_cast<size_t>(p) >> 4);
+        return static_cast<U32>((key * 0x9E3779B97F4A7C15ULL) >> 32);
+    }
+
+
     /**************************************************************************************************************************/
     // Implementation
     /**************************************************************************************************************************/
     MemoryTracker::MemoryTracker()
     {
-        // ...
+        allocTable = 0;
+        tableCapacity = tableUsed = 0;
     }
     /**************************************************************************************************************************/
 
     MemoryTracker::~MemoryTracker()
     {
-        // ...
+        FreeTable();
     }
     /**************************************************************************************************************************/
 
@@ -40,87 +58,204 @@
         allocCount = 0;
             
         for(U32 i=0; i<ALLOC_SOURCE_COUNT; ++i)
+        {
             for(U32 j=0; j<ALLOC_USAGE_COUNT; ++j)
-                memoryUsage[i][j] = peakMemoryUsage[i][j] = 0;
+            {
+                liveMemoryUsage[i][j] = 0;
+                peakMemoryUsage[i][j] = 0;
+            }
+        }
+
+        ResizeTable(DEFAULT_MEMORY_TRACKER_TABLE_SIZE);
     }
     /**************************************************************************************************************************/
 
     void MemoryTracker::Shutdown()
     {
+        StopEventLog();
+
+        ScopedSpinLock lock(tableLock);
+
         std::cout << "-------------------------------------------------------" << std::endl; 
-        if(allocCount != 0 || !allocList.IsEmpty())
+        if(allocCount != 0)
         {
-            // --------------------------------------- TEMPORARY PLACE-HOLDER CODE ------------------------------------------------
-            // the only entries in the allocation list/record at this point will detail those allocations that were never matched with 
-            // a corresponding de-allocation, so print the allocDesc(s) to a file and notify user
+            // the only entries in the allocation table at this point will detail those allocations that were never matched with 
+            // a corresponding de-allocation, so print the allocDesc(s) and notify user
 
             std::cout << "Memory Leak(s) Detected: " << allocCount << std::endl;
             std::cout << "-------------------------------------------------------" << std::endl;
 
-            SinglyLinkedList<AllocDesc>::ConstIterator itr(allocList.CBegin());
-            while((&(*itr) != 0x0))
+            for(U32 i=0; i<tableCapacity; ++i)
             {
-                std::cout << "file : " << itr->file << std::endl;
-                std::cout << "line : " << itr->line << std::endl;
-                std::cout << "bytes: " << itr->bytes << std::endl;
+                const AllocDesc &desc = allocTable[i];
+                if(desc.p == EMPTY_SLOT || desc.p == TOMBSTONE_SLOT)
+                    continue;
+
+                std::cout << "file : " << (desc.file ? desc.file : "unknown") << std::endl;
+                std::cout << "line : " << desc.line << std::endl;
+                std::cout << "bytes: " << desc.bytes << std::endl;
                 std::cout << "-------------------------------------------------------\n" << std::endl;
-                ++itr;
             }
-            // write allocation info to file
         }
         else
         {
             std::cout << "No Memory Leak(s) Detected"    << std::endl;     
         }
         std::cout << "-------------------------------------------------------" << std::endl;
-        // --------------------------------------- TEMPORARY PLACE-HOLDER CODE ------------------------------------------------
+
+        FreeTable();
     }
     /**************************************************************************************************************************/
 
     // ENGINE_ALL, APPLICATION_ALL or ALL should be passed in via dest, since these two are primarily used to help us navigate the arrays
     void MemoryTracker::RecordAlloc(void *p,const I8 *file, U32 line, size_t bytes, U8 alignment, ALLOC_SOURCE source, ALLOC_USAGE usage)
     {
+        RT_SLOW_ASSERT(p != EMPTY_SLOT && p != TOMBSTONE_SLOT);
+
+        ScopedSpinLock lock(tableLock);
+
+        // not started up (or already shut down)
+        if(!allocTable)
+            return;
+
         ++allocCount;
-        memoryUsage[source][usage] += bytes;
-            
-        if(bytes > peakMemoryUsage[source][usage])
-            peakMemoryUsage[source][usage] = bytes;
 
-        AllocDesc thisAlloc(p, file, line, bytes, alignment, source, usage);
-        // --------------------------------------- TEMPORARY PLACE-HOLDER CODE ------------------------------------------------
-        allocList.PushFront(thisAlloc);
-        // --------------------------------------- TEMPORARY PLACE-HOLDER CODE ------------------------------------------------
+        // keep the table at most half full so probe sequences stay short
+        if(((tableUsed + 1) * 2) > tableCapacity)
+        {
+            // mostly tombstones? rebuild at the same size, otherwise double
+            U32 live = allocCount;
+            ResizeTable(((live * 4) > tableCapacity) ? (tableCapacity * 2) : tableCapacity);
+        }
+
+        U32 slot = FindSlot(p);
+        RT_SLOW_ASSERT(allocTable[slot].p != p); // recorded twice
+        if(allocTable[slot].p == EMPTY_SLOT)
+            ++tableUsed;
+
+        allocTable[slot] = AllocDesc(p, file, line, bytes, alignment, source, usage);
+
+        // records are serialised here, so the running total passes through every value and the peak is exact
+        U64 live = (liveMemoryUsage[source][usage] += bytes);
+        if(live > peakMemoryUsage[source][usage])
+            peakMemoryUsage[source][usage] = live;
+
+        // logged under the table lock so events for the same address are always in order
+        eventLog.Record(MEMORY_EVENT_ALLOC, p, file, line, bytes, alignment, static_cast<I8>(source), static_cast<I8>(usage));
     }
     /**************************************************************************************************************************/
 
     // ENGINE_ALL, APPLICATION_ALL or ALL should be passed in via dest, since these two are primarily used to help us navigate the arrays
     void MemoryTracker::RecordDeAlloc(void *p)
     {
+        ScopedSpinLock lock(tableLock);
+
+        if(!allocTable)
+            return;
+
+        U32 slot = FindSlot(p);
+        AllocDesc &desc = allocTable[slot];
+        if(desc.p != p)
+        {
+            // never recorded (or freed twice)
+            RT_SLOW_ASSERT(desc.p == p);
+            return;
+        }
+
         --allocCount;
-    
-        // --------------------------------------- TEMPORARY PLACE-HOLDER CODE ------------------------------------------------
-        // with the hash table this'll be replaced with a simple look up
-        SinglyLinkedList<AllocDesc>::Iterator itr(allocList.Begin());
-        while(itr->p != p)
-            ++itr;
-        memoryUsage[itr->source][itr->usage] -= (*itr).bytes; // hashTable[hashThis(p)].bytes;
-            
-        // remove entry from allocation list/record
-        // this will equate to marking the hash entry as 'DELETED'
-        allocList.Remove(itr);    
-        // --------------------------------------- TEMPORARY PLACE-HOLDER CODE ------------------------------------------------
+        size_t bytes = desc.bytes;
+        U32 source = desc.source;
+        U32 usage = desc.usage;
+        liveMemoryUsage[source][usage] -= bytes;
+        
+        // mark the entry as deleted, it still counts towards tableUsed until the next resize
+        desc = AllocDesc();
+        desc.p = TOMBSTONE_SLOT;
+
+        eventLog.Record(MEMORY_EVENT_DEALLOC, p, 0, 0, bytes, 0, static_cast<I8>(source), static_cast<I8>(usage));
+    }
+    /**************************************************************************************************************************/
+
+    bool MemoryTracker::StartEventLog(const I8 *fileName)
+    {
+        return eventLog.Open(fileName);
+    }
+    /**************************************************************************************************************************/
+
+    void MemoryTracker::StopEventLog()
+    {
+        eventLog.Close();
     }
     /**************************************************************************************************************************/
 
     size_t MemoryTracker::GetMemoryUsage(ALLOC_SOURCE memPool, ALLOC_USAGE system)
     {
-        return memoryUsage[memPool][system];
+        return static_cast<size_t>(AtomicLoad64(&liveMemoryUsage[memPool][system]));
     }
     /**************************************************************************************************************************/
 
     size_t MemoryTracker::GetPeakMemoryUsage(ALLOC_SOURCE memPool, ALLOC_USAGE system)
     {
-        return peakMemoryUsage[memPool][system];
+        return static_cast<size_t>(AtomicLoad64(&peakMemoryUsage[memPool][system]));
+    }
+    /**************************************************************************************************************************/
+
+    U32 MemoryTracker::FindSlot(void *p) const
+    {
+        U32 mask = tableCapacity - 1;
+        U32 slot = HashAddress(p) & mask;
+        U32 firstTombstone = tableCapacity;
+
+        // linear probe - the table is never full so this always hits an empty slot eventually
+        while(allocTable[slot].p != EMPTY_SLOT)
+        {
+            if(allocTable[slot].p == p)
+                return slot;
+
+            if(allocTable[slot].p == TOMBSTONE_SLOT && firstTombstone == tableCapacity)
+                firstTombstone = slot;
+
+            slot = (slot + 1) & mask;
+        }
+
+        return (firstTombstone != tableCapacity) ? firstTombstone : slot;
+    }
+    /**************************************************************************************************************************/
+
+    void MemoryTracker::ResizeTable(U32 newCapacity)
+    {
+        RT_SLOW_ASSERT((newCapacity & (newCapacity - 1)) == 0);
+
+        AllocDesc *oldTable = allocTable;
+        U32 oldCapacity = tableCapacity;
+
+        // straight from the os, zeroed pages = every slot EMPTY_SLOT
+        allocTable = reinterpret_cast<AllocDesc*>(AllocatePages(sizeof(AllocDesc) * newCapacity, true));
+        RT_ASSERT(allocTable != 0);
+        tableCapacity = newCapacity;
+        tableUsed = 0;
+
+        for(U32 i=0; i<oldCapacity; ++i)
+        {
+            if(oldTable[i].p == EMPTY_SLOT || oldTable[i].p == TOMBSTONE_SLOT)
+                continue;
+
+            allocTable[FindSlot(oldTable[i].p)] = oldTable[i];
+            ++tableUsed;
+        }
+
+        if(oldTable)
+            FreePages(oldTable, sizeof(AllocDesc) * oldCapacity);
+    }
+    /**************************************************************************************************************************/
+
+    void MemoryTracker::FreeTable()
+    {
+        if(allocTable)
+            FreePages(allocTable, sizeof(AllocDesc) * tableCapacity);
+
+        allocTable = 0;
+        tableCapacity = tableUsed = 0;
     }
     /**************************************************************************************************************************/
 
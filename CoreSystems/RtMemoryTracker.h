@@ -3,7 +3,7 @@
     -----------
     File        :    RtMemoryTracker.h
     Author      :    Jamie Taylor
-    Last Edit   :    12/08/12
+    Last Edit   :    17/10/26
     Desc        :    Basic memory tracker, at the base level it tracks the memory consumption and peak memory consumption
                      of each engine component peak memory usage for each engine component and/or each component of the application
                      being developed with the engine.
@@ -12,17 +12,35 @@
                      With RT_MEMORY_TRACKER_FULL enabled a hash table of AllocDesc structs will be maintained and flushed to a file
                      when the tracker shuts down.
 
-                     Use an open-hasing/chaining approach when hash-tables are done as we can't accurately predict table load.
-
                      LINK WITH SINGLETON?
+
+                     17/10/26 - Replaced the placeholder linked list with an open-addressing (linear probing) table keyed on the
+                                allocation address, RecordDeAlloc is now a lookup rather than a list walk. The table doubles
+                                when it's over half full (tombstones included) so probes stay short. Its memory comes straight
+                                from the os page allocator so the tracker never recurses into the allocators it's tracking.
+                                Record calls are guarded by a spin lock.
+
+                     17/10/26 - Usage and peak usage are exact. Every record already takes the table lock, so a running total
+                                per source/usage is kept under it and the peak is its maximum, no extra synchronisation and no
+                                sampling error. GetMemoryUsage()/GetPeakMemoryUsage() read them without the lock.
+
+                     17/10/26 - StartEventLog() streams every recorded allocation and de-allocation to a binary log file (see
+                                RtMemoryEventLog.h) for the offline analyser in Tools/MemoryLogAnalyser, Shutdown() stops it.
 */   
 #ifndef RT_MEMORY_TRACKER_H
 #define RT_MEMORY_TRACKER_H
 
 
 #include "../RtConfiguration.h"
-#include "RtSinglyLinkedList_DP_V.h"
 #include "RtSingleton.h"
+#include "RtSpinLock.h"
+#include "RtMemoryEventLog.h"
+
+
+// starting number of allocation table slots, must be a power of two - can be overridden in RtConfiguration.h
+#ifndef DEFAULT_MEMORY_TRACKER_TABLE_SIZE
+    #define DEFAULT_MEMORY_TRACKER_TABLE_SIZE 4096
+#endif // DEFAULT_MEMORY_TRACKER_TABLE_SIZE
 
 
 #ifdef RT_MEMORY_TRACKER
@@ -91,6 +109,10 @@
         void RecordAlloc(void *p, const I8 *file, U32 line, size_t bytes, U8 alignment, ALLOC_SOURCE source, ALLOC_USAGE usage);
         void RecordDeAlloc(void *p);
             
+        // stream allocation events to fileName until StopEventLog()/Shutdown() - false if the file can't be opened
+        bool StartEventLog(const I8 *fileName);
+        void StopEventLog();
+
         // get memory usage information for a particular system/component
         size_t GetMemoryUsage(ALLOC_SOURCE memPool, ALLOC_USAGE system);
         size_t GetPeakMemoryUsage(ALLOC_SOURCE memPool, ALLOC_USAGE system);
@@ -101,8 +123,10 @@
             
     private:
         U32 allocCount;
-        size_t memoryUsage[ALLOC_SOURCE_COUNT][ALLOC_USAGE_COUNT];
-        size_t peakMemoryUsage[ALLOC_SOURCE_COUNT][ALLOC_USAGE_COUNT];
+
+        // live bytes across every thread and the most there have ever been, only written with tableLock held
+        volatile U64 liveMemoryUsage[ALLOC_SOURCE_COUNT][ALLOC_USAGE_COUNT];
+        volatile U64 peakMemoryUsage[ALLOC_SOURCE_COUNT][ALLOC_USAGE_COUNT];
             
         struct AllocDesc
         {
@@ -110,23 +134,33 @@
                 { p = 0; file = 0; line = 0; bytes = 0; alignment = 0; source = ALLOC_SOURCE_NULL; usage = ALLOC_USAGE_NULL; }
 
             AllocDesc(void *_p, const I8 *_file, U32 _line, size_t _bytes, U8 _alignment, ALLOC_SOURCE _source, ALLOC_USAGE _usage) 
-                { p = _p; file = _file; line = _line; bytes = _bytes; alignment = _alignment; source = _source; usage = _usage; }
+                { p = _p; file = _file; line = _line; bytes = _bytes; alignment = _alignment; source = static_cast<I8>(_source); usage = static_cast<I8>(_usage); }
 
+            // ordered and packed so a table slot is 32 bytes (64 bit) and never straddles a cache line
             void *p;
             const I8 *file;
-            U32 line;
             size_t bytes;
+            U32 line;
             U8 alignment;
-            ALLOC_SOURCE source;
-            ALLOC_USAGE usage;
+            I8 source; // ALLOC_SOURCE
+            I8 usage;  // ALLOC_USAGE
         };
 
-        // FUNCTION() - WRITE ALLOCATION RECORDS TO FILE - NEEDS (FILE SYSTEM / LOG MANAGER(specify log file)?)
-
-        // --------------------------------------- TEMPORARY PLACE-HOLDER CODE ------------------------------------------------
-        // HASH TABLE<AllocDesc> (when finished) - use a singly-linked list for now (only temporary)
-        SinglyLinkedList<AllocDesc> allocList;
-        // --------------------------------------- TEMPORARY PLACE-HOLDER CODE ------------------------------------------------
+        // allocation events over time, for offline analysis
+        MemoryEventLog eventLog;
+
+        // allocation table - open addressing, keyed on AllocDesc::p
+        AllocDesc *allocTable;
+        // number of slots (power of two) and number of slots that aren't empty (live + tombstones)
+        U32 tableCapacity;
+        U32 tableUsed;
+        SpinLock tableLock;
+
+        // slot for p - either the one holding it or, if it isn't in the table, the first reusable one on its probe sequence
+        U32 FindSlot(void *p) const;
+        // re-insert every live entry into a table of newCapacity slots, drops tombstones
+        void ResizeTable(U32 newCapacity);
+        void FreeTable();
     };
     /**************************************************************************************************************************/
 
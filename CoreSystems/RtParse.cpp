@@ -0,0 +1,531 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtParse.cpp
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Number parsing, see RtParse.h.
+
+                     ParseF32 reads up to 19 significant digits into a U64 and a decimal exponent,
+                     then multiplies by a 128 bit approximation of the matching power of five - the
+                     top bits of the product are the float's mantissa (Daniel Lemire, "Number Parsing
+                     at a Gigabyte per Second", the fast_float library).
+
+===============================================================================
+*/
+
+
+#include "RtParse.h"
+#include <string.h>
+#include <stdlib.h>
+#if RT_COMPILER == RT_COMPILER_MSVC
+    #include <intrin.h>
+#endif // RT_COMPILER == RT_COMPILER_MSVC
+
+
+// decimal exponents below this are always zero as a float, above the other always infinity
+static const I32 F32_SMALLEST_POWER_OF_TEN       = -65;
+static const I32 F32_LARGEST_POWER_OF_TEN        = 38;
+static const I32 F32_MANTISSA_BITS               = 23;
+static const I32 F32_MINIMUM_EXPONENT            = -127;
+static const I32 F32_INFINITE_POWER              = 0xFF;
+// the only exponents where the product can land exactly halfway between two floats
+static const I32 F32_MIN_EXPONENT_ROUND_TO_EVEN  = -17;
+static const I32 F32_MAX_EXPONENT_ROUND_TO_EVEN  = 10;
+
+// mantissas this big or smaller and these powers of ten are exact as floats, so one multiply or divide is correctly rounded
+static const U64 F32_MAX_EXACT_MANTISSA          = static_cast<U64>( 1 ) << 24;
+static const I32 F32_MAX_EXACT_POWER_OF_TEN      = 10;
+static const F32 exactPowersOfTen[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+// a U64 holds any 19 digit number
+static const I32 MAX_MANTISSA_DIGITS             = 19;
+
+// the longest input the strtod fallback copies, longer ones keep the Eisel-Lemire result (at most 1ulp off)
+static const U32 FALLBACK_BUFFER_SIZE            = 128;
+
+// 5^q for q in [F32_SMALLEST_POWER_OF_TEN, F32_LARGEST_POWER_OF_TEN], normalised so the top bit is set
+// and truncated to 128 bits (high, low) - rounded up for negative q
+static const U64 powersOfFive[] = {
+    0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL, // 5^-65
+    0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL, // 5^-64
+    0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL, // 5^-63
+    0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL, // 5^-62
+    0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL, // 5^-61
+    0xcdb02555653131b6ULL, 0x3792f412cb06794dULL, // 5^-60
+    0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL, // 5^-59
+    0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL, // 5^-58
+    0xc8de047564d20a8bULL, 0xf245825a5a445275ULL, // 5^-57
+    0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL, // 5^-56
+    0x9ced737bb6c4183dULL, 0x55464dd69685606bULL, // 5^-55
+    0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL, // 5^-54
+    0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL, // 5^-53
+    0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL, // 5^-52
+    0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL, // 5^-51
+    0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL, // 5^-50
+    0x95a8637627989aadULL, 0xdde7001379a44aa8ULL, // 5^-49
+    0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL, // 5^-48
+    0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL, // 5^-47
+    0x9226712162ab070dULL, 0xcab3961304ca70e8ULL, // 5^-46
+    0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL, // 5^-45
+    0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL, // 5^-44
+    0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL, // 5^-43
+    0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL, // 5^-42
+    0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL, // 5^-41
+    0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL, // 5^-40
+    0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL, // 5^-39
+    0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL, // 5^-38
+    0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL, // 5^-37
+    0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL, // 5^-36
+    0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL, // 5^-35
+    0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL, // 5^-34
+    0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL, // 5^-33
+    0xcfb11ead453994baULL, 0x67de18eda5814af2ULL, // 5^-32
+    0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL, // 5^-31
+    0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL, // 5^-30
+    0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL, // 5^-29
+    0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL, // 5^-28
+    0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL, // 5^-27
+    0xc612062576589ddaULL, 0x95364afe032a819eULL, // 5^-26
+    0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL, // 5^-25
+    0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL, // 5^-24
+    0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL, // 5^-23
+    0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL, // 5^-22
+    0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL, // 5^-21
+    0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL, // 5^-20
+    0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL, // 5^-19
+    0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL, // 5^-18
+    0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL, // 5^-17
+    0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL, // 5^-16
+    0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL, // 5^-15
+    0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL, // 5^-14
+    0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL, // 5^-13
+    0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL, // 5^-12
+    0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL, // 5^-11
+    0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL, // 5^-10
+    0x89705f4136b4a597ULL, 0x31680a88f8953031ULL, // 5^-9
+    0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL, // 5^-8
+    0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL, // 5^-7
+    0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL, // 5^-6
+    0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL, // 5^-5
+    0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL, // 5^-4
+    0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL, // 5^-3
+    0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL, // 5^-2
+    0xccccccccccccccccULL, 0xcccccccccccccccdULL, // 5^-1
+    0x8000000000000000ULL, 0x0000000000000000ULL, // 5^0
+    0xa000000000000000ULL, 0x0000000000000000ULL, // 5^1
+    0xc800000000000000ULL, 0x0000000000000000ULL, // 5^2
+    0xfa00000000000000ULL, 0x0000000000000000ULL, // 5^3
+    0x9c40000000000000ULL, 0x0000000000000000ULL, // 5^4
+    0xc350000000000000ULL, 0x0000000000000000ULL, // 5^5
+    0xf424000000000000ULL, 0x0000000000000000ULL, // 5^6
+    0x9896800000000000ULL, 0x0000000000000000ULL, // 5^7
+    0xbebc200000000000ULL, 0x0000000000000000ULL, // 5^8
+    0xee6b280000000000ULL, 0x0000000000000000ULL, // 5^9
+    0x9502f90000000000ULL, 0x0000000000000000ULL, // 5^10
+    0xba43b74000000000ULL, 0x0000000000000000ULL, // 5^11
+    0xe8d4a51000000000ULL, 0x0000000000000000ULL, // 5^12
+    0x9184e72a00000000ULL, 0x0000000000000000ULL, // 5^13
+    0xb5e620f480000000ULL, 0x0000000000000000ULL, // 5^14
+    0xe35fa931a0000000ULL, 0x0000000000000000ULL, // 5^15
+    0x8e1bc9bf04000000ULL, 0x0000000000000000ULL, // 5^16
+    0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL, // 5^17
+    0xde0b6b3a76400000ULL, 0x0000000000000000ULL, // 5^18
+    0x8ac7230489e80000ULL, 0x0000000000000000ULL, // 5^19
+    0xad78ebc5ac620000ULL, 0x0000000000000000ULL, // 5^20
+    0xd8d726b7177a8000ULL, 0x0000000000000000ULL, // 5^21
+    0x878678326eac9000ULL, 0x0000000000000000ULL, // 5^22
+    0xa968163f0a57b400ULL, 0x0000000000000000ULL, // 5^23
+    0xd3c21bcecceda100ULL, 0x0000000000000000ULL, // 5^24
+    0x84595161401484a0ULL, 0x0000000000000000ULL, // 5^25
+    0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL, // 5^26
+    0xcecb8f27f4200f3aULL, 0x0000000000000000ULL, // 5^27
+    0x813f3978f8940984ULL, 0x4000000000000000ULL, // 5^28
+    0xa18f07d736b90be5ULL, 0x5000000000000000ULL, // 5^29
+    0xc9f2c9cd04674edeULL, 0xa400000000000000ULL, // 5^30
+    0xfc6f7c4045812296ULL, 0x4d00000000000000ULL, // 5^31
+    0x9dc5ada82b70b59dULL, 0xf020000000000000ULL, // 5^32
+    0xc5371912364ce305ULL, 0x6c28000000000000ULL, // 5^33
+    0xf684df56c3e01bc6ULL, 0xc732000000000000ULL, // 5^34
+    0x9a130b963a6c115cULL, 0x3c7f400000000000ULL, // 5^35
+    0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL, // 5^36
+    0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL, // 5^37
+    0x96769950b50d88f4ULL, 0x1314448000000000ULL, // 5^38
+};
+
+
+/*
+================
+U128
+================
+*/
+struct U128 {
+    U64 high;
+    U64 low;
+};
+
+/*
+================
+Multiply64
+================
+*/
+static inline U128 Multiply64( U64 a, U64 b ) {
+    U128 result;
+#if RT_COMPILER == RT_COMPILER_GCC && defined( __SIZEOF_INT128__ )
+    unsigned __int128 product = static_cast<unsigned __int128>( a ) * b;
+    result.high = static_cast<U64>( product >> 64 );
+    result.low = static_cast<U64>( product );
+#elif RT_COMPILER == RT_COMPILER_MSVC && RT_ARCHITECTURE == RT_ARCHITECTURE_64
+    result.low = _umul128( a, b, &result.high );
+#else
+    U64 aLow = a & 0xFFFFFFFF, aHigh = a >> 32;
+    U64 bLow = b & 0xFFFFFFFF, bHigh = b >> 32;
+    U64 lowLow = aLow * bLow, lowHigh = aLow * bHigh, highLow = aHigh * bLow, highHigh = aHigh * bHigh;
+    U64 middle = ( lowLow >> 32 ) + ( lowHigh & 0xFFFFFFFF ) + ( highLow & 0xFFFFFFFF );
+    result.low = ( middle << 32 ) | ( lowLow & 0xFFFFFFFF );
+    result.high = highHigh + ( lowHigh >> 32 ) + ( highLow >> 32 ) + ( middle >> 32 );
+#endif // RT_COMPILER
+    return result;
+}
+
+/*
+================
+CountLeadingZeros64
+
+@value must be non-zero.
+================
+*/
+static inline I32 CountLeadingZeros64( U64 value ) {
+#if RT_COMPILER == RT_COMPILER_GCC
+    return __builtin_clzll( value );
+#elif RT_COMPILER == RT_COMPILER_MSVC && RT_ARCHITECTURE == RT_ARCHITECTURE_64
+    unsigned long index;
+    _BitScanReverse64( &index, value );
+    return 63 - static_cast<I32>( index );
+#else
+    I32 count = 0;
+    while( ( value & ( static_cast<U64>( 1 ) << 63 ) ) == 0 ) {
+        value <<= 1;
+        ++count;
+    }
+    return count;
+#endif // RT_COMPILER
+}
+
+/*
+================
+IsEightDigits
+
+The 8 characters (little endian) are all '0' to '9'.
+================
+*/
+static inline bool IsEightDigits( U64 chars ) {
+    return ( ( chars & 0xF0F0F0F0F0F0F0F0ULL ) | ( ( ( chars + 0x0606060606060606ULL ) & 0xF0F0F0F0F0F0F0F0ULL ) >> 4 ) ) == 0x3333333333333333ULL;
+}
+
+/*
+================
+ParseEightDigits
+
+Converts 8 digits at once, pairs then fours then all eight.
+================
+*/
+static inline U32 ParseEightDigits( U64 chars ) {
+    const U64 mask = 0x000000FF000000FFULL;
+    const U64 mul1 = 0x000F424000000064ULL; // 100 + ( 1000000 << 32 )
+    const U64 mul2 = 0x0000271000000001ULL; // 1 + ( 10000 << 32 )
+
+    chars -= 0x3030303030303030ULL;
+    chars = ( chars * 10 ) + ( chars >> 8 );
+    chars = ( ( ( chars & mask ) * mul1 ) + ( ( ( chars >> 16 ) & mask ) * mul2 ) ) >> 32;
+    return static_cast<U32>( chars );
+}
+
+/*
+================
+LoadEightChars
+================
+*/
+static inline U64 LoadEightChars( const I8 *p ) {
+    U64 chars;
+    memcpy( &chars, p, sizeof( chars ) );
+    return chars;
+}
+
+/*
+================
+ParseDigits
+
+Appends the digits at @p to @mantissa, only the first MAX_MANTISSA_DIGITS significant digits are
+kept. Returns where the digits end, @digits is how many were kept, @dropped how many weren't and
+@truncated whether any of those were non-zero.
+================
+*/
+static const I8 * ParseDigits( const I8 *p, const I8 *end, U64 &mantissa, I32 &digits, I64 &dropped, bool &truncated ) {
+    for( ;; ) {
+        if( ( mantissa != 0 ) && ( ( digits + 8 ) <= MAX_MANTISSA_DIGITS ) && ( ( end - p ) >= 8 ) ) {
+            U64 chars = LoadEightChars( p );
+            if( IsEightDigits( chars ) == true ) {
+                mantissa = ( mantissa * 100000000 ) + ParseEightDigits( chars );
+                digits += 8;
+                p += 8;
+                continue;
+            }
+        }
+
+        if( p == end ) {
+            return p;
+        }
+
+        U32 digit = static_cast<U32>( static_cast<U8>( *p ) - '0' );
+        if( digit > 9 ) {
+            return p;
+        }
+
+        if( digits < MAX_MANTISSA_DIGITS ) {
+            mantissa = ( mantissa * 10 ) + digit;
+            // leading zeros aren't significant
+            digits += ( mantissa != 0 ) ? 1 : 0;
+        }
+        else {
+            ++dropped;
+            truncated |= ( digit != 0 );
+        }
+        ++p;
+    }
+}
+
+/*
+================
+EiselLemire
+
+Float bits (without the sign) for @mantissa * 10^@exponent, @mantissa is non-zero.
+================
+*/
+static U32 EiselLemire( U64 mantissa, I32 exponent ) {
+    if( exponent < F32_SMALLEST_POWER_OF_TEN ) {
+        return 0;
+    }
+    if( exponent > F32_LARGEST_POWER_OF_TEN ) {
+        return static_cast<U32>( F32_INFINITE_POWER ) << F32_MANTISSA_BITS;
+    }
+
+    I32 leadingZeros = CountLeadingZeros64( mantissa );
+    mantissa <<= leadingZeros;
+
+    // the product only needs the mantissa bits plus a few for rounding, the second (low) half of the
+    // power is only needed if those bits could still change
+    const U64 *power = &powersOfFive[( exponent - F32_SMALLEST_POWER_OF_TEN ) * 2];
+    const U64 precisionMask = 0xFFFFFFFFFFFFFFFFULL >> ( F32_MANTISSA_BITS + 3 );
+    U128 product = Multiply64( mantissa, power[0] );
+    if( ( product.high & precisionMask ) == precisionMask ) {
+        U128 second = Multiply64( mantissa, power[1] );
+        product.low += second.high;
+        if( second.high > product.low ) {
+            ++product.high;
+        }
+    }
+
+    I32 upperBit = static_cast<I32>( product.high >> 63 );
+    I32 shift = upperBit + 64 - F32_MANTISSA_BITS - 3;
+    U64 bits = product.high >> shift;
+    // floor( log2( 10^exponent ) ) + 63
+    I32 power2 = ( ( ( 152170 + 65536 ) * exponent ) >> 16 ) + 63 + upperBit - leadingZeros - F32_MINIMUM_EXPONENT;
+
+    if( power2 <= 0 ) {
+        // subnormal
+        if( ( -power2 + 1 ) >= 64 ) {
+            return 0;
+        }
+        bits >>= -power2 + 1;
+        bits += bits & 1;
+        bits >>= 1;
+        // rounding up can make it normal again, which the exponent field takes care of
+        return static_cast<U32>( bits );
+    }
+
+    // exactly halfway, round to even rather than up
+    if( ( product.low <= 1 ) && ( exponent >= F32_MIN_EXPONENT_ROUND_TO_EVEN ) && ( exponent <= F32_MAX_EXPONENT_ROUND_TO_EVEN ) &&
+        ( ( bits & 3 ) == 1 ) && ( ( bits << shift ) == product.high ) ) {
+        bits &= ~static_cast<U64>( 1 );
+    }
+
+    bits += bits & 1;
+    bits >>= 1;
+    if( bits >= ( static_cast<U64>( 2 ) << F32_MANTISSA_BITS ) ) {
+        bits = static_cast<U64>( 1 ) << F32_MANTISSA_BITS;
+        ++power2;
+    }
+    bits &= ~( static_cast<U64>( 1 ) << F32_MANTISSA_BITS );
+
+    if( power2 >= F32_INFINITE_POWER ) {
+        return static_cast<U32>( F32_INFINITE_POWER ) << F32_MANTISSA_BITS;
+    }
+
+    return static_cast<U32>( bits ) | ( static_cast<U32>( power2 ) << F32_MANTISSA_BITS );
+}
+
+/*
+================
+ParseF32
+================
+*/
+bool ParseF32( const I8 *str, U32 length, F32 &value ) {
+    const I8 *p = str;
+    const I8 *end = str + length;
+
+    bool negative = false;
+    if( ( p != end ) && ( ( *p == '-' ) || ( *p == '+' ) ) ) {
+        negative = ( *p == '-' );
+        ++p;
+    }
+
+    U64 mantissa = 0;
+    I32 digits = 0;
+    I64 exponent = 0;
+    bool truncated = false;
+
+    // digits dropped before the point are still powers of ten
+    const I8 *integerStart = p;
+    p = ParseDigits( p, end, mantissa, digits, exponent, truncated );
+    bool anyDigits = ( p != integerStart );
+
+    if( ( p != end ) && ( *p == '.' ) ) {
+        ++p;
+        const I8 *fractionStart = p;
+        I64 dropped = 0;
+        p = ParseDigits( p, end, mantissa, digits, dropped, truncated );
+        anyDigits |= ( p != fractionStart );
+
+        // every fraction digit that wasn't dropped (leading zeros included) is another power of ten down
+        exponent -= ( p - fractionStart ) - dropped;
+    }
+
+    if( anyDigits == false ) {
+        return false;
+    }
+
+    if( ( p != end ) && ( ( *p == 'e' ) || ( *p == 'E' ) ) ) {
+        ++p;
+        bool negativeExponent = false;
+        if( ( p != end ) && ( ( *p == '-' ) || ( *p == '+' ) ) ) {
+            negativeExponent = ( *p == '-' );
+            ++p;
+        }
+
+        if( ( p == end ) || ( static_cast<U32>( static_cast<U8>( *p ) - '0' ) > 9 ) ) {
+            return false;
+        }
+
+        I64 explicitExponent = 0;
+        for( ; ( p != end ) && ( static_cast<U32>( static_cast<U8>( *p ) - '0' ) <= 9 ); ++p ) {
+            // anything this big is zero or infinity already, stop before it overflows
+            if( explicitExponent < 0x10000 ) {
+                explicitExponent = ( explicitExponent * 10 ) + ( *p - '0' );
+            }
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+
+    if( p != end ) {
+        return false;
+    }
+
+    U32 bits = 0;
+    if( mantissa == 0 ) {
+        bits = 0;
+    }
+    else if( ( truncated == false ) && ( mantissa <= F32_MAX_EXACT_MANTISSA ) &&
+             ( exponent >= -F32_MAX_EXACT_POWER_OF_TEN ) && ( exponent <= F32_MAX_EXACT_POWER_OF_TEN ) ) {
+        F32 result = static_cast<F32>( mantissa );
+        result = ( exponent < 0 ) ? ( result / exactPowersOfTen[-exponent] ) : ( result * exactPowersOfTen[exponent] );
+        value = negative ? -result : result;
+        return true;
+    }
+    else {
+        // clamp, anything outside the range is zero or infinity either way
+        I32 exponent32 = ( exponent < -0x10000 ) ? -0x10000 : ( ( exponent > 0x10000 ) ? 0x10000 : static_cast<I32>( exponent ) );
+        bits = EiselLemire( mantissa, exponent32 );
+
+        // the dropped digits put the value somewhere between mantissa and mantissa + 1, if those round
+        // differently we can't tell which it is without all of the digits
+        if( ( truncated == true ) && ( bits != EiselLemire( mantissa + 1, exponent32 ) ) && ( length < FALLBACK_BUFFER_SIZE ) ) {
+            I8 buffer[FALLBACK_BUFFER_SIZE];
+            memcpy( buffer, str, length );
+            buffer[length] = '\0';
+            value = strtof( buffer, NULL );
+            return true;
+        }
+    }
+
+    bits |= negative ? 0x80000000 : 0;
+    memcpy( &value, &bits, sizeof( value ) );
+    return true;
+}
+
+/*
+================
+ParseU32
+================
+*/
+bool ParseU32( const I8 *str, U32 length, U32 &value ) {
+    const I8 *p = str;
+    const I8 *end = str + length;
+
+    if( p == end ) {
+        return false;
+    }
+
+    U64 result = 0;
+    if( ( end - p ) >= 8 ) {
+        U64 chars = LoadEightChars( p );
+        if( IsEightDigits( chars ) == true ) {
+            result = ParseEightDigits( chars );
+            p += 8;
+        }
+    }
+
+    // at most 10 digits fit, plus any leading zeros
+    for( ; p != end; ++p ) {
+        U32 digit = static_cast<U32>( static_cast<U8>( *p ) - '0' );
+        if( digit > 9 ) {
+            return false;
+        }
+        result = ( result * 10 ) + digit;
+        if( result > 0xFFFFFFFFULL ) {
+            return false;
+        }
+    }
+
+    value = static_cast<U32>( result );
+    return true;
+}
+
+/*
+================
+ParseI32
+================
+*/
+bool ParseI32( const I8 *str, U32 length, I32 &value ) {
+    bool negative = false;
+    if( ( length > 0 ) && ( ( *str == '-' ) || ( *str == '+' ) ) ) {
+        negative = ( *str == '-' );
+        ++str;
+        --length;
+    }
+
+    U32 magnitude;
+    if( ParseU32( str, length, magnitude ) == false ) {
+        return false;
+    }
+
+    // one more on the negative side
+    if( magnitude > ( negative ? 0x80000000U : 0x7FFFFFFFU ) ) {
+        return false;
+    }
+
+    value = negative ? static_cast<I32>( 0U - magnitude ) : static_cast<I32>( magnitude );
+    return true;
+}
@@ -0,0 +1,55 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtParse.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Number parsing straight from a (not null terminated) string, such as a token
+                     view. No copies, no allocations and no locale, unlike atof/atoi/strtod.
+
+                     ParseF32 is correctly rounded (round to nearest, ties to even), it uses the
+                     Eisel-Lemire algorithm with a fast path for short mantissas and small exponents.
+
+===============================================================================
+*/
+
+
+#ifndef RT_PARSE_H
+#define RT_PARSE_H
+
+
+#include "../PlatformIndependenceLayer/RtPlatform.h"
+
+
+/*
+================
+ParseF32
+
+[+-]digits[.digits][(e|E)[+-]digits], either side of the point can be empty but not both.
+Returns false, leaving @value alone, unless all @length characters make up the number.
+================
+*/
+bool ParseF32( const I8 *str, U32 length, F32 &value );
+
+/*
+================
+ParseU32
+
+Digits only, false on overflow.
+================
+*/
+bool ParseU32( const I8 *str, U32 length, U32 &value );
+
+/*
+================
+ParseI32
+
+[+-]digits, false on overflow.
+================
+*/
+bool ParseI32( const I8 *str, U32 length, I32 &value );
+
+
+#endif // RT_PARSE_H
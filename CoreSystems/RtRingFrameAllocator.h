@@ -0,0 +1,217 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtRingFrameAllocator.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    N-buffered frame allocator, the general form of the double buffered allocator. Keeps N
+                     stacks and moves on to the next one at the end of each frame, so anything allocated in
+                     frame k stays valid until frame k+N starts reusing that stack.
+
+                     The gpu (or async jobs) can still be reading frame k's data when the cpu gets round to
+                     frame k+N, so a stack isn't simply cleared when it comes back around. Each frame is
+                     closed with a fence value (EndFrame), and BeginFrame is only allowed to reset the next
+                     stack once the caller reports that fence as completed. Fence values are expected to
+                     increase every frame.
+
+                     for( ;; ) {
+                         while( frameAllocator.BeginFrame( gpu.GetCompletedFence( ) ) == false ) {
+                             gpu.WaitForFence( ... );
+                         }
+                         ... frameAllocator.Allocate( ... ) ...
+                         frameAllocator.EndFrame( gpu.Signal( ) );
+                     }
+
+===============================================================================
+*/
+
+
+#ifndef RT_RING_FRAME_ALLOCATOR_H
+#define RT_RING_FRAME_ALLOCATOR_H
+
+
+#include "../RtCommonHeaders.h"
+#include "RtAssert.h"
+#include "RtStackAllocator.h"
+
+
+/*
+===============================================================================
+
+Ring Frame Allocator class
+
+===============================================================================
+*/
+template<U32 N, class T = void>
+class RingFrameAllocator {
+public:
+                        // each frame gets sizeInBytes, carved from @mem (N * sizeInBytes bytes from @offset) or from a buffer of our own if @mem is null
+    explicit            RingFrameAllocator( size_t sizeInBytes, U8 *mem = NULL, size_t offset = 0 );
+                        ~RingFrameAllocator( void );
+
+                        // make an allocation from the current frame's stack
+    void              * Allocate( size_t sizeInBytes, U8 alignment = 1 );
+
+                        // construct & destruct - not necessary for POD and void
+    template<class U>
+    void                Construct( U *posInMem, const U &val = 0 );
+    template<class U>
+    void                Destruct( U *toDestruct );
+
+                        // reset the next stack and start allocating from it, returns false (and leaves it alone)
+                        // if the frame that last used it hasn't retired, i.e. @completedFence is behind its fence
+    bool                BeginFrame( U64 completedFence );
+                        // close the current frame, its stack is kept until @frameFence completes
+    void                EndFrame( U64 frameFence );
+
+                        // would BeginFrame succeed with @completedFence
+    bool                IsNextFrameRetired( U64 completedFence ) const;
+
+    U32                 GetCurrentFrameIndex( void ) const { return currFrame; }
+    size_t              GetRemainingSpace( void ) const { return frames[currFrame].GetRemainingSpace( ); }
+
+private:
+    StackAllocator<T>   frames[N];
+                        // fence the last frame using each stack was closed with
+    U64                 fences[N];
+
+    U32                 currFrame;
+                        // between a successful BeginFrame and EndFrame
+    bool                frameOpen;
+
+                        // what operator new handed us if we weren't given a buffer
+    U8                * localMemory;
+
+                        RingFrameAllocator( const RingFrameAllocator &ref ) { /* do nothing - forbidden op */ }
+    void                operator=( const RingFrameAllocator &rhs ) { /* do nothing - forbidden op */ }
+};
+
+
+/*
+================
+RingFrameAllocator<N, T>::RingFrameAllocator
+================
+*/
+template<U32 N, class T>
+RingFrameAllocator<N, T>::RingFrameAllocator( size_t sizeInBytes, U8 *mem, size_t offset ) {
+    RT_SLOW_ASSERT( N >= 2 );
+
+    localMemory = NULL;
+    if( mem == NULL ) {
+        localMemory = reinterpret_cast<U8*>( operator new( sizeInBytes * N ) );
+        mem = localMemory;
+        offset = 0;
+    }
+
+    // the stacks never own the memory, so the temporaries going out of scope is harmless
+    for( U32 i=0; i<N; ++i ) {
+        StackAllocator<T> stck( sizeInBytes, mem, offset + ( sizeInBytes * i ) );
+        frames[i] = stck;
+        fences[i] = 0;
+    }
+
+    // start with the first stack, open - there is nothing for it to wait on
+    currFrame = 0;
+    frameOpen = true;
+}
+
+/*
+================
+RingFrameAllocator<N, T>::~RingFrameAllocator
+================
+*/
+template<U32 N, class T>
+RingFrameAllocator<N, T>::~RingFrameAllocator( void ) {
+    for( U32 i=0; i<N; ++i ) {
+        frames[i].Clear( );
+    }
+
+    if( localMemory != NULL ) {
+        operator delete( reinterpret_cast<void*>( localMemory ) );
+    }
+}
+
+/*
+================
+RingFrameAllocator<N, T>::Allocate
+================
+*/
+template<U32 N, class T>
+void* RingFrameAllocator<N, T>::Allocate( size_t sizeInBytes, U8 alignment ) {
+    // the current stack may still be in use by a frame in flight
+    RT_SLOW_ASSERT( frameOpen == true );
+    return frames[currFrame].Allocate( sizeInBytes, alignment );
+}
+
+/*
+================
+RingFrameAllocator<N, T>::Construct
+================
+*/
+template<U32 N, class T>
+template<class U>
+void RingFrameAllocator<N, T>::Construct( U *posInMem, const U &val ) {
+    frames[currFrame].Construct( posInMem, val );
+}
+
+/*
+================
+RingFrameAllocator<N, T>::Destruct
+================
+*/
+template<U32 N, class T>
+template<class U>
+void RingFrameAllocator<N, T>::Destruct( U *toDestruct ) {
+    frames[currFrame].Destruct( toDestruct );
+}
+
+/*
+================
+RingFrameAllocator<N, T>::BeginFrame
+================
+*/
+template<U32 N, class T>
+bool RingFrameAllocator<N, T>::BeginFrame( U64 completedFence ) {
+    if( frameOpen == true ) {
+        // already open, e.g. the very first frame
+        return true;
+    }
+
+    if( IsNextFrameRetired( completedFence ) == false ) {
+        return false;
+    }
+
+    frames[currFrame].Clear( );
+    frameOpen = true;
+    return true;
+}
+
+/*
+================
+RingFrameAllocator<N, T>::EndFrame
+================
+*/
+template<U32 N, class T>
+void RingFrameAllocator<N, T>::EndFrame( U64 frameFence ) {
+    RT_SLOW_ASSERT( frameOpen == true );
+
+    fences[currFrame] = frameFence;
+    currFrame = ( currFrame + 1 ) % N;
+    frameOpen = false;
+}
+
+/*
+================
+RingFrameAllocator<N, T>::IsNextFrameRetired
+================
+*/
+template<U32 N, class T>
+bool RingFrameAllocator<N, T>::IsNextFrameRetired( U64 completedFence ) const {
+    // currFrame has already moved on in EndFrame, its fence is from frame k-N
+    return ( completedFence >= fences[currFrame] );
+}
+
+
+#endif // RT_RING_FRAME_ALLOCATOR_H
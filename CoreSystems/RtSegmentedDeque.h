@@ -0,0 +1,575 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtSegmentedDeque.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Unrolled linked list/segmented deque - elements are stored in chunks of CHUNK_ELEMENTS
+                     contiguous elements and the chunks are linked together. Walking it touches one pointer
+                     per chunk rather than one per element, so traversal runs at close to array speed while
+                     keeping list-like inserts and removes.
+
+                     Push/pop at either end is O(1), inserting or removing in the middle shifts at most one
+                     chunk's worth of elements (a full chunk is split in two, sparse neighbours are merged).
+                     Elements never move between chunks except on a split/merge, so pointers and iterators
+                     stay valid across pushes and pops at the ends; anything that inserts or removes in the
+                     middle of a chunk invalidates iterators into that chunk (and End( )).
+
+                     Chunks come from a slab backed DynamicPoolAllocator, so growing is one heap call per
+                     SEGMENTED_DEQUE_CHUNKS_PER_SLAB chunks and freed chunks are recycled.
+
+                     Iterators follow the linked lists (RtDoublyLinkedList_H_V.h), End( ) is one past the
+                     last element:
+
+                     for( SegmentedDeque<Foo>::Iterator itr=deque.Begin( ); itr!=deque.End( ); ++itr ) {
+                         ...
+                     }
+
+===============================================================================
+*/
+
+
+#ifndef RT_SEGMENTED_DEQUE_H
+#define RT_SEGMENTED_DEQUE_H
+
+
+#include "RtCommonHeaders.h"
+#include "RtAssert.h"
+#include "RtTypeTraits.h"
+#include "RtDynamicPoolAllocator.h"
+
+
+// elements per chunk, can be overridden in RtConfiguration.h
+#ifndef SEGMENTED_DEQUE_CHUNK_ELEMENTS
+    #define SEGMENTED_DEQUE_CHUNK_ELEMENTS 64
+#endif // SEGMENTED_DEQUE_CHUNK_ELEMENTS
+
+// chunks allocated together when the chunk pool grows, can be overridden in RtConfiguration.h
+#ifndef SEGMENTED_DEQUE_CHUNKS_PER_SLAB
+    #define SEGMENTED_DEQUE_CHUNKS_PER_SLAB 4
+#endif // SEGMENTED_DEQUE_CHUNKS_PER_SLAB
+
+// minimum alignment of each chunk's element storage (T's own alignment is used if it's bigger), can be overridden in RtConfiguration.h
+#ifndef SEGMENTED_DEQUE_CHUNK_ALIGNMENT
+    #define SEGMENTED_DEQUE_CHUNK_ALIGNMENT 16
+#endif // SEGMENTED_DEQUE_CHUNK_ALIGNMENT
+
+
+/*
+===============================================================================
+
+Segmented deque class
+
+===============================================================================
+*/
+template<class T, U32 CHUNK_ELEMENTS = SEGMENTED_DEQUE_CHUNK_ELEMENTS>
+class SegmentedDeque {
+private:
+    // element storage alignment, whichever is bigger of T's own and SEGMENTED_DEQUE_CHUNK_ALIGNMENT
+    enum { ELEMENT_ALIGNMENT = ( AlignOf<T>::value > SEGMENTED_DEQUE_CHUNK_ALIGNMENT ) ? AlignOf<T>::value : SEGMENTED_DEQUE_CHUNK_ALIGNMENT };
+    // the links below, then padding so the elements start on ELEMENT_ALIGNMENT (chunks are allocated on it too)
+    enum { LINK_BYTES = ( sizeof( void* ) * 2 ) + ( sizeof( U32 ) * 2 ) };
+    enum { ELEMENT_OFFSET = ( LINK_BYTES + ELEMENT_ALIGNMENT - 1 ) & ~( ELEMENT_ALIGNMENT - 1 ) };
+
+    // elements live in [begin, end), pushing at the back fills upwards and pushing at the front fills
+    // downwards - a chunk in the list is never empty
+    struct Chunk {
+        T *                 Elements( void ) { return reinterpret_cast<T*>( reinterpret_cast<U8*>( this ) + ELEMENT_OFFSET ); }
+        const T *           Elements( void ) const { return reinterpret_cast<const T*>( reinterpret_cast<const U8*>( this ) + ELEMENT_OFFSET ); }
+        U32                 Count( void ) const { return end - begin; }
+
+        Chunk             * prev;
+        Chunk             * next;
+        U32                 begin;
+        U32                 end;
+        // header padding then the elements
+        U8                  storage[( ELEMENT_OFFSET - LINK_BYTES ) + ( CHUNK_ELEMENTS * sizeof( T ) )];
+    };
+
+public:
+    class ConstIterator;
+    class Iterator {
+    public:
+                            Iterator( void ) { chunk = NULL; index = 0; }
+
+        bool                operator==( const Iterator &ref ) const { return ( chunk == ref.chunk && index == ref.index ); }
+        bool                operator!=( const Iterator &ref ) const { return !( *this == ref ); }
+        bool                operator==( const ConstIterator &ref ) const { return ( chunk == ref.chunk && index == ref.index ); }
+        bool                operator!=( const ConstIterator &ref ) const { return !( *this == ref ); }
+
+        T &                 operator*( void ) const { return chunk->Elements( )[index]; }
+        T *                 operator->( void ) const { return &chunk->Elements( )[index]; }
+
+        Iterator &          operator++( void ) { SegmentedDeque::Advance( chunk, index ); return *this; }
+        Iterator            operator++( I32 notUsed ) { Iterator temp = *this; SegmentedDeque::Advance( chunk, index ); return temp; }
+        Iterator &          operator--( void ) { SegmentedDeque::Retreat( chunk, index ); return *this; }
+        Iterator            operator--( I32 notUsed ) { Iterator temp = *this; SegmentedDeque::Retreat( chunk, index ); return temp; }
+
+    private:
+        friend class SegmentedDeque<T, CHUNK_ELEMENTS>;
+        friend class ConstIterator;
+                            Iterator( Chunk *_chunk, U32 _index ) { chunk = _chunk; index = _index; }
+
+        Chunk             * chunk;
+        U32                 index;
+    };
+
+    class ConstIterator {
+    public:
+                            ConstIterator( void ) { chunk = NULL; index = 0; }
+                            ConstIterator( const Iterator &itr ) { chunk = itr.chunk; index = itr.index; }
+
+        bool                operator==( const ConstIterator &ref ) const { return ( chunk == ref.chunk && index == ref.index ); }
+        bool                operator!=( const ConstIterator &ref ) const { return !( *this == ref ); }
+        bool                operator==( const Iterator &ref ) const { return ( chunk == ref.chunk && index == ref.index ); }
+        bool                operator!=( const Iterator &ref ) const { return !( *this == ref ); }
+
+        const T &           operator*( void ) const { return chunk->Elements( )[index]; }
+        const T *           operator->( void ) const { return &chunk->Elements( )[index]; }
+
+        ConstIterator &     operator++( void ) { SegmentedDeque::Advance( chunk, index ); return *this; }
+        ConstIterator       operator++( I32 notUsed ) { ConstIterator temp = *this; SegmentedDeque::Advance( chunk, index ); return temp; }
+        ConstIterator &     operator--( void ) { SegmentedDeque::Retreat( chunk, index ); return *this; }
+        ConstIterator       operator--( I32 notUsed ) { ConstIterator temp = *this; SegmentedDeque::Retreat( chunk, index ); return temp; }
+
+    private:
+        friend class SegmentedDeque<T, CHUNK_ELEMENTS>;
+        friend class Iterator;
+                            ConstIterator( const Chunk *_chunk, U32 _index ) { chunk = _chunk; index = _index; }
+
+        const Chunk       * chunk;
+        U32                 index;
+    };
+
+                        SegmentedDeque( void );
+                        SegmentedDeque( const SegmentedDeque<T, CHUNK_ELEMENTS> &ref );
+                        ~SegmentedDeque( void );
+
+    SegmentedDeque &    operator=( const SegmentedDeque<T, CHUNK_ELEMENTS> &rhs );
+
+    void                PushFront( const T &value );
+    void                PushBack( const T &value );
+    void                PopFront( void );
+    void                PopBack( void );
+
+                        // insert before @itr (End( ) appends), returns the new element
+    Iterator            Insert( const Iterator &itr, const T &value );
+                        // returns the element that followed the removed one
+    Iterator            Remove( const Iterator &itr );
+
+    const T &           GetFirst( void ) const { return first->Elements( )[first->begin]; }
+    T &                 GetFirst( void ) { return first->Elements( )[first->begin]; }
+    const T &           GetLast( void ) const { return last->Elements( )[last->end-1]; }
+    T &                 GetLast( void ) { return last->Elements( )[last->end-1]; }
+
+    Iterator            Begin( void ) { return ( first != NULL ) ? Iterator( first, first->begin ) : Iterator( ); }
+    ConstIterator       CBegin( void ) const { return ( first != NULL ) ? ConstIterator( first, first->begin ) : ConstIterator( ); }
+    Iterator            End( void ) { return ( last != NULL ) ? Iterator( last, last->end ) : Iterator( ); }
+    ConstIterator       CEnd( void ) const { return ( last != NULL ) ? ConstIterator( last, last->end ) : ConstIterator( ); }
+
+    U32                 Count( void ) const { return count; }
+    U32                 ChunkCount( void ) const { return chunkCount; }
+    bool                IsEmpty( void ) const { return ( count == 0 ); }
+
+                        // destroy every element and hand the chunks back to the heap
+    void                Clear( void );
+
+private:
+    template<class C>
+    static void         Advance( C *&chunk, U32 &index );
+    template<class C>
+    static void         Retreat( C *&chunk, U32 &index );
+
+                        // new empty chunk linked in after @prev (at the front if null), its elements start at @start
+    Chunk *             AddChunk( Chunk *prev, U32 start );
+    void                FreeChunk( Chunk *chunk );
+                        // move @chunk's elements down to index 0
+    void                Compact( Chunk *chunk );
+                        // move the upper half of a full chunk into a new chunk after it
+    void                Split( Chunk *chunk );
+                        // fold @chunk->next into @chunk if they fit in half a chunk together
+    void                MergeNext( Chunk *chunk );
+
+    Chunk             * first;
+    Chunk             * last;
+    U32                 count;
+    U32                 chunkCount;
+    DynamicPoolAllocator<Chunk> chunkPool;
+};
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::SegmentedDeque
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+SegmentedDeque<T, CHUNK_ELEMENTS>::SegmentedDeque( void ) :
+    chunkPool( sizeof( Chunk ), 0, ELEMENT_ALIGNMENT, SEGMENTED_DEQUE_CHUNKS_PER_SLAB ) {
+    RT_ASSERT( CHUNK_ELEMENTS >= 2 );
+    // the padding maths assumes the links are packed
+    RT_SLOW_ASSERT( ( reinterpret_cast<size_t>( &reinterpret_cast<Chunk*>( 64 )->storage ) - 64 ) == LINK_BYTES );
+
+    first = last = NULL;
+    count = 0;
+    chunkCount = 0;
+}
+
+template<class T, U32 CHUNK_ELEMENTS>
+SegmentedDeque<T, CHUNK_ELEMENTS>::SegmentedDeque( const SegmentedDeque<T, CHUNK_ELEMENTS> &ref ) :
+    chunkPool( sizeof( Chunk ), 0, ELEMENT_ALIGNMENT, SEGMENTED_DEQUE_CHUNKS_PER_SLAB ) {
+    first = last = NULL;
+    count = 0;
+    chunkCount = 0;
+
+    *this = ref;
+}
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::~SegmentedDeque
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+SegmentedDeque<T, CHUNK_ELEMENTS>::~SegmentedDeque( void ) {
+    Clear( );
+}
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::operator=
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+SegmentedDeque<T, CHUNK_ELEMENTS>& SegmentedDeque<T, CHUNK_ELEMENTS>::operator=( const SegmentedDeque<T, CHUNK_ELEMENTS> &rhs ) {
+    if( this == &rhs ) {
+        return *this;
+    }
+
+    Clear( );
+    for( ConstIterator itr=rhs.CBegin( ); itr!=rhs.CEnd( ); ++itr ) {
+        PushBack( *itr );
+    }
+
+    return *this;
+}
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::PushFront
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+void SegmentedDeque<T, CHUNK_ELEMENTS>::PushFront( const T &value ) {
+    if( first == NULL || first->begin == 0 ) {
+        AddChunk( NULL, CHUNK_ELEMENTS );
+    }
+
+    --first->begin;
+    new( reinterpret_cast<void*>( &first->Elements( )[first->begin] ) ) T( value );
+    ++count;
+}
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::PushBack
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+void SegmentedDeque<T, CHUNK_ELEMENTS>::PushBack( const T &value ) {
+    if( last == NULL || last->end == CHUNK_ELEMENTS ) {
+        AddChunk( last, 0 );
+    }
+
+    new( reinterpret_cast<void*>( &last->Elements( )[last->end] ) ) T( value );
+    ++last->end;
+    ++count;
+}
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::PopFront
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+void SegmentedDeque<T, CHUNK_ELEMENTS>::PopFront( void ) {
+    RT_ASSERT( count > 0 );
+
+    first->Elements( )[first->begin].~T( );
+    ++first->begin;
+    --count;
+
+    if( first->begin == first->end ) {
+        FreeChunk( first );
+    }
+}
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::PopBack
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+void SegmentedDeque<T, CHUNK_ELEMENTS>::PopBack( void ) {
+    RT_ASSERT( count > 0 );
+
+    --last->end;
+    last->Elements( )[last->end].~T( );
+    --count;
+
+    if( last->begin == last->end ) {
+        FreeChunk( last );
+    }
+}
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::Insert
+
+Opens a gap on whichever side of the chunk has room, splitting the chunk first if it's full.
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+typename SegmentedDeque<T, CHUNK_ELEMENTS>::Iterator SegmentedDeque<T, CHUNK_ELEMENTS>::Insert( const Iterator &itr, const T &value ) {
+    if( itr == End( ) ) {
+        PushBack( value );
+        return Iterator( last, last->end - 1 );
+    }
+
+    Chunk *chunk = itr.chunk;
+    U32 index = itr.index;
+
+    if( chunk->Count( ) == CHUNK_ELEMENTS ) {
+        Split( chunk );
+        if( index >= chunk->end ) {
+            // now in the upper half, which starts at 0
+            index -= chunk->end;
+            chunk = chunk->next;
+        }
+    }
+
+    T *elements = chunk->Elements( );
+    if( chunk->end < CHUNK_ELEMENTS ) {
+        Relocator<T>::Relocate( &elements[index+1], &elements[index], chunk->end - index );
+        ++chunk->end;
+    }
+    else {
+        Relocator<T>::Relocate( &elements[chunk->begin-1], &elements[chunk->begin], index - chunk->begin );
+        --chunk->begin;
+        --index;
+    }
+
+    new( reinterpret_cast<void*>( &elements[index] ) ) T( value );
+    ++count;
+
+    return Iterator( chunk, index );
+}
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::Remove
+
+Closes the gap from whichever side has fewer elements to move. The following element's offset from
+the start of the chunk is the same either way, so it's tracked as an offset through any merge.
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+typename SegmentedDeque<T, CHUNK_ELEMENTS>::Iterator SegmentedDeque<T, CHUNK_ELEMENTS>::Remove( const Iterator &itr ) {
+    RT_ASSERT( itr.chunk != NULL && itr != End( ) );
+
+    Chunk *chunk = itr.chunk;
+    U32 index = itr.index;
+    U32 offset = index - chunk->begin;
+    T *elements = chunk->Elements( );
+
+    elements[index].~T( );
+    --count;
+
+    if( ( index - chunk->begin ) < ( chunk->end - index - 1 ) ) {
+        Relocator<T>::Relocate( &elements[chunk->begin+1], &elements[chunk->begin], index - chunk->begin );
+        ++chunk->begin;
+    }
+    else {
+        Relocator<T>::Relocate( &elements[index], &elements[index+1], chunk->end - index - 1 );
+        --chunk->end;
+    }
+
+    if( chunk->begin == chunk->end ) {
+        Chunk *next = chunk->next;
+        FreeChunk( chunk );
+        return ( next != NULL ) ? Iterator( next, next->begin ) : End( );
+    }
+
+    MergeNext( chunk );
+
+    if( offset < chunk->Count( ) ) {
+        return Iterator( chunk, chunk->begin + offset );
+    }
+
+    return ( chunk->next != NULL ) ? Iterator( chunk->next, chunk->next->begin ) : End( );
+}
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::Clear
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+void SegmentedDeque<T, CHUNK_ELEMENTS>::Clear( void ) {
+    while( first != NULL ) {
+        Relocator<T>::Destroy( &first->Elements( )[first->begin], first->Count( ) );
+        FreeChunk( first );
+    }
+
+    count = 0;
+    chunkPool.Shrink( );
+}
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::Advance
+
+Steps past the end of the last chunk to End( ).
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+template<class C>
+void SegmentedDeque<T, CHUNK_ELEMENTS>::Advance( C *&chunk, U32 &index ) {
+    ++index;
+    if( index == chunk->end && chunk->next != NULL ) {
+        chunk = chunk->next;
+        index = chunk->begin;
+    }
+}
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::Retreat
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+template<class C>
+void SegmentedDeque<T, CHUNK_ELEMENTS>::Retreat( C *&chunk, U32 &index ) {
+    if( index == chunk->begin ) {
+        chunk = chunk->prev;
+        index = chunk->end;
+    }
+    --index;
+}
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::AddChunk
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+typename SegmentedDeque<T, CHUNK_ELEMENTS>::Chunk* SegmentedDeque<T, CHUNK_ELEMENTS>::AddChunk( Chunk *prev, U32 start ) {
+    Chunk *chunk = chunkPool.Allocate( );
+    chunk->begin = chunk->end = start;
+    chunk->prev = prev;
+    chunk->next = ( prev != NULL ) ? prev->next : first;
+
+    if( chunk->prev != NULL ) {
+        chunk->prev->next = chunk;
+    }
+    else {
+        first = chunk;
+    }
+    if( chunk->next != NULL ) {
+        chunk->next->prev = chunk;
+    }
+    else {
+        last = chunk;
+    }
+
+    ++chunkCount;
+    return chunk;
+}
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::FreeChunk
+
+Unlinks and frees the chunk, its elements must already be destroyed or moved out.
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+void SegmentedDeque<T, CHUNK_ELEMENTS>::FreeChunk( Chunk *chunk ) {
+    if( chunk->prev != NULL ) {
+        chunk->prev->next = chunk->next;
+    }
+    else {
+        first = chunk->next;
+    }
+    if( chunk->next != NULL ) {
+        chunk->next->prev = chunk->prev;
+    }
+    else {
+        last = chunk->prev;
+    }
+
+    chunkPool.DeAllocate( chunk );
+    --chunkCount;
+}
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::Compact
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+void SegmentedDeque<T, CHUNK_ELEMENTS>::Compact( Chunk *chunk ) {
+    if( chunk->begin == 0 ) {
+        return;
+    }
+
+    T *elements = chunk->Elements( );
+    Relocator<T>::Relocate( elements, &elements[chunk->begin], chunk->Count( ) );
+    chunk->end -= chunk->begin;
+    chunk->begin = 0;
+}
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::Split
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+void SegmentedDeque<T, CHUNK_ELEMENTS>::Split( Chunk *chunk ) {
+    RT_SLOW_ASSERT( chunk->begin == 0 && chunk->end == CHUNK_ELEMENTS );
+
+    const U32 half = CHUNK_ELEMENTS / 2;
+    Chunk *upper = AddChunk( chunk, 0 );
+
+    Relocator<T>::RelocateDisjoint( upper->Elements( ), &chunk->Elements( )[half], CHUNK_ELEMENTS - half );
+    upper->end = CHUNK_ELEMENTS - half;
+    chunk->end = half;
+}
+
+/*
+================
+SegmentedDeque<T, CHUNK_ELEMENTS>::MergeNext
+
+Keeps removes from leaving a trail of nearly empty chunks - every pair of neighbours ends up more
+than half a chunk full between them.
+================
+*/
+template<class T, U32 CHUNK_ELEMENTS>
+void SegmentedDeque<T, CHUNK_ELEMENTS>::MergeNext( Chunk *chunk ) {
+    Chunk *next = chunk->next;
+    if( next == NULL || ( chunk->Count( ) + next->Count( ) ) > ( CHUNK_ELEMENTS / 2 ) ) {
+        return;
+    }
+
+    if( ( chunk->end + next->Count( ) ) > CHUNK_ELEMENTS ) {
+        Compact( chunk );
+    }
+
+    Relocator<T>::RelocateDisjoint( &chunk->Elements( )[chunk->end], &next->Elements( )[next->begin], next->Count( ) );
+    chunk->end += next->Count( );
+    FreeChunk( next );
+}
+
+
+#endif // RT_SEGMENTED_DEQUE_H
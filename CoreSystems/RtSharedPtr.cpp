@@ -0,0 +1,76 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtSharedPtr.cpp
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Control block pool for SharedPtr, see RtSharedPtr.h.
+
+===============================================================================
+*/
+
+
+#include "RtSharedPtr.h"
+#include "RtCachedPoolAllocator.h"
+
+
+// control blocks the pool starts with, it grows as needed - can be overridden in RtConfiguration.h
+#ifndef SHARED_CONTROL_BLOCK_POOL_SIZE
+    #define SHARED_CONTROL_BLOCK_POOL_SIZE 256
+#endif // SHARED_CONTROL_BLOCK_POOL_SIZE
+
+
+typedef CachedPoolAllocator<SharedControlBlock> SharedControlBlockPool;
+
+static void * volatile controlBlockPool = NULL;
+
+
+/*
+================
+GetControlBlockPool
+
+Created by whichever thread gets here first and never destroyed, SharedPtrs held by other statics
+can still be released during shutdown.
+================
+*/
+static SharedControlBlockPool * GetControlBlockPool( void ) {
+    void *pool = AtomicLoadPointer( &controlBlockPool );
+    if( pool != NULL ) {
+        return reinterpret_cast<SharedControlBlockPool*>( pool );
+    }
+
+    // the per-thread caches are cache line aligned, which plain new doesn't honour
+    HeapAllocator<U8> allctr;
+    void *memory = RT_ALLOC( allctr, sizeof( SharedControlBlockPool ), RT_CACHE_LINE_SIZE );
+    SharedControlBlockPool *created = new( memory ) SharedControlBlockPool( sizeof( SharedControlBlock ), SHARED_CONTROL_BLOCK_POOL_SIZE, sizeof( void* ) );
+
+    pool = AtomicCompareExchangePointer( &controlBlockPool, created, NULL );
+    if( pool != NULL ) {
+        // another thread beat us to it
+        created->~SharedControlBlockPool( );
+        allctr.DeAllocate( reinterpret_cast<U8*>( memory ) );
+        return reinterpret_cast<SharedControlBlockPool*>( pool );
+    }
+
+    return created;
+}
+
+/*
+================
+AllocateSharedControlBlock
+================
+*/
+SharedControlBlock * AllocateSharedControlBlock( void ) {
+    return GetControlBlockPool( )->Allocate( );
+}
+
+/*
+================
+FreeSharedControlBlock
+================
+*/
+void FreeSharedControlBlock( SharedControlBlock *block ) {
+    GetControlBlockPool( )->DeAllocate( block );
+}
@@ -0,0 +1,571 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtSharedPtr.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Reference counted shared pointer and its weak counterpart, replaces the first attempt
+                     (RtSharedPtr_V_T.h) which kept a plain count inside each handle.
+
+                     Every object shared this way has one SharedControlBlock holding an atomic strong count
+                     (SharedPtrs) and weak count (WeakPtrs, plus one for as long as any SharedPtr is left).
+                     The object is destroyed when the strong count reaches zero and the block is freed when
+                     the weak count does, so a WeakPtr can always safely ask whether the object still exists.
+
+                     The counts can be changed from any thread, so handles to the same object can be copied,
+                     destroyed and Lock( )ed on different threads at once. A single SharedPtr/WeakPtr object
+                     is no more thread-safe than a plain pointer - don't assign to one on one thread while
+                     another reads it.
+
+                     SharedPtr<Mesh> mesh( meshAllctr.Allocate( ), meshAllctr );     // block from a pool
+                     SharedPtr<Mesh> mesh = MakeShared<Mesh>( "crate.obj" );         // one allocation
+                     WeakPtr<Mesh> weak( mesh );
+                     SharedPtr<Mesh> locked = weak.Lock( );                          // null if it's gone
+
+                     Control blocks for objects handed in by pointer come from a shared CachedPoolAllocator,
+                     MakeShared puts the block and the object in a single heap allocation instead.
+
+                     17/10/26 - MakeShared aligns the object (and the allocation) to the type's own alignment when
+                                that's more than 16.
+
+===============================================================================
+*/
+
+
+#ifndef RT_SHARED_PTR_H
+#define RT_SHARED_PTR_H
+
+
+#include "RtCommonHeaders.h"
+#include "RtAssert.h"
+#include "RtTypeTraits.h"
+#include "RtHeapAllocator.h"
+#include "../PlatformIndependenceLayer/RtAtomic.h"
+
+
+/*
+================
+SharedControlBlock
+================
+*/
+struct SharedControlBlock {
+    volatile U32        strong;
+                        // WeakPtrs, plus one while strong > 0
+    volatile U32        weak;
+                        // run when strong reaches zero, then when weak does
+    void                ( *destroyObject )( SharedControlBlock *block );
+    void                ( *freeBlock )( SharedControlBlock *block );
+                        // what destroyObject needs, not necessarily the SharedPtr's pointer (which may be a base class)
+    void              * object;
+    void              * allocator;
+};
+
+// pooled control blocks, see RtSharedPtr.cpp
+SharedControlBlock *    AllocateSharedControlBlock( void );
+void                    FreeSharedControlBlock( SharedControlBlock *block );
+
+/*
+================
+SharedControlBlockAddStrong
+================
+*/
+inline void SharedControlBlockAddStrong( SharedControlBlock *block ) {
+    AtomicAdd32( &block->strong, 1 );
+}
+
+/*
+================
+SharedControlBlockReleaseWeak
+================
+*/
+inline void SharedControlBlockReleaseWeak( SharedControlBlock *block ) {
+    if( AtomicAdd32( &block->weak, static_cast<U32>( -1 ) ) == 1 ) {
+        block->freeBlock( block );
+    }
+}
+
+/*
+================
+SharedControlBlockReleaseStrong
+================
+*/
+inline void SharedControlBlockReleaseStrong( SharedControlBlock *block ) {
+    if( AtomicAdd32( &block->strong, static_cast<U32>( -1 ) ) == 1 ) {
+        block->destroyObject( block );
+        // the weak reference all the SharedPtrs shared
+        SharedControlBlockReleaseWeak( block );
+    }
+}
+
+/*
+================
+SharedControlBlockTryAddStrong
+
+Add a strong reference unless the count has already hit zero, for WeakPtr::Lock.
+================
+*/
+inline bool SharedControlBlockTryAddStrong( SharedControlBlock *block ) {
+    U32 strong = AtomicLoad32( &block->strong );
+    while( strong != 0 ) {
+        U32 seen = AtomicCompareExchange32( &block->strong, strong + 1, strong );
+        if( seen == strong ) {
+            return true;
+        }
+        strong = seen;
+    }
+
+    return false;
+}
+
+
+template<class T> class WeakPtr;
+
+/*
+===============================================================================
+
+Shared pointer class
+
+===============================================================================
+*/
+template<class T>
+class SharedPtr {
+public:
+                        SharedPtr( void ) { object = NULL; block = NULL; }
+                        // takes ownership of @object, deleted with delete
+    explicit            SharedPtr( T *object_ );
+                        // takes ownership of @object, which came from @allctr - @allctr must outlive every SharedPtr to it
+    template<class Allocator>
+                        SharedPtr( T *object_, Allocator &allctr );
+                        SharedPtr( const SharedPtr<T> &ref );
+                        // from a SharedPtr to a derived class
+    template<class U>
+                        SharedPtr( const SharedPtr<U> &ref );
+                        ~SharedPtr( void ) { Release( ); }
+
+    SharedPtr &         operator=( const SharedPtr<T> &rhs );
+    template<class U>
+    SharedPtr &         operator=( const SharedPtr<U> &rhs );
+#if RT_HAS_RVALUE_REFERENCES
+                        SharedPtr( SharedPtr<T> &&ref ) { object = ref.object; block = ref.block; ref.object = NULL; ref.block = NULL; }
+    SharedPtr &         operator=( SharedPtr<T> &&rhs );
+#endif // RT_HAS_RVALUE_REFERENCES
+
+    bool                operator==( const SharedPtr<T> &rhs ) const { return ( object == rhs.object ); }
+    bool                operator!=( const SharedPtr<T> &rhs ) const { return ( object != rhs.object ); }
+    T &                 operator*( void ) const { return *object; }
+    T *                 operator->( void ) const { return object; }
+    T *                 Get( void ) const { return object; }
+
+    bool                IsValid( void ) const { return ( object != NULL ); }
+    bool                IsUnique( void ) const { return ( GetRefCount( ) == 1 ); }
+                        // approximate if other threads are copying/releasing handles to the same object
+    U32                 GetRefCount( void ) const { return ( block != NULL ) ? AtomicLoad32( &block->strong ) : 0; }
+
+                        // drop our reference, the pointer is null afterwards
+    void                Reset( void );
+    void                Swap( SharedPtr<T> &swapWith );
+
+private:
+    template<class U> friend class SharedPtr;
+    template<class U> friend class WeakPtr;
+    template<class U> friend SharedPtr<U> MakeSharedFromBlock( SharedControlBlock *block, U *object );
+
+                        // adopts a reference already counted in @block
+                        SharedPtr( SharedControlBlock *block_, T *object_ ) { object = object_; block = block_; }
+
+    void                Release( void );
+
+    static void         DeleteObject( SharedControlBlock *block ) { delete reinterpret_cast<T*>( block->object ); }
+    template<class Allocator>
+    static void         DeAllocateObject( SharedControlBlock *block );
+
+    T                 * object;
+    SharedControlBlock * block;
+};
+
+/*
+================
+SharedPtr<T>::SharedPtr
+================
+*/
+template<class T>
+SharedPtr<T>::SharedPtr( T *object_ ) {
+    object = object_;
+    block = NULL;
+    if( object == NULL ) {
+        return;
+    }
+
+    block = AllocateSharedControlBlock( );
+    block->strong = 1;
+    block->weak = 1;
+    block->destroyObject = DeleteObject;
+    block->freeBlock = FreeSharedControlBlock;
+    block->object = object;
+    block->allocator = NULL;
+}
+
+template<class T>
+template<class Allocator>
+SharedPtr<T>::SharedPtr( T *object_, Allocator &allctr ) {
+    object = object_;
+    block = NULL;
+    if( object == NULL ) {
+        return;
+    }
+
+    block = AllocateSharedControlBlock( );
+    block->strong = 1;
+    block->weak = 1;
+    block->destroyObject = DeAllocateObject<Allocator>;
+    block->freeBlock = FreeSharedControlBlock;
+    block->object = object;
+    block->allocator = &allctr;
+}
+
+template<class T>
+SharedPtr<T>::SharedPtr( const SharedPtr<T> &ref ) {
+    object = ref.object;
+    block = ref.block;
+    if( block != NULL ) {
+        SharedControlBlockAddStrong( block );
+    }
+}
+
+template<class T>
+template<class U>
+SharedPtr<T>::SharedPtr( const SharedPtr<U> &ref ) {
+    object = ref.object;
+    block = ref.block;
+    if( block != NULL ) {
+        SharedControlBlockAddStrong( block );
+    }
+}
+
+/*
+================
+SharedPtr<T>::operator=
+================
+*/
+template<class T>
+SharedPtr<T>& SharedPtr<T>::operator=( const SharedPtr<T> &rhs ) {
+    // take the new reference first, @rhs may be the last thing keeping our object alive
+    SharedPtr<T> temp( rhs );
+    Swap( temp );
+    return *this;
+}
+
+template<class T>
+template<class U>
+SharedPtr<T>& SharedPtr<T>::operator=( const SharedPtr<U> &rhs ) {
+    SharedPtr<T> temp( rhs );
+    Swap( temp );
+    return *this;
+}
+
+#if RT_HAS_RVALUE_REFERENCES
+template<class T>
+SharedPtr<T>& SharedPtr<T>::operator=( SharedPtr<T> &&rhs ) {
+    SharedPtr<T> temp( Move( rhs ) );
+    Swap( temp );
+    return *this;
+}
+#endif // RT_HAS_RVALUE_REFERENCES
+
+/*
+================
+SharedPtr<T>::Reset
+================
+*/
+template<class T>
+void SharedPtr<T>::Reset( void ) {
+    Release( );
+    object = NULL;
+    block = NULL;
+}
+
+/*
+================
+SharedPtr<T>::Swap
+================
+*/
+template<class T>
+void SharedPtr<T>::Swap( SharedPtr<T> &swapWith ) {
+    T *tempObject = object;
+    SharedControlBlock *tempBlock = block;
+
+    object = swapWith.object;
+    block = swapWith.block;
+
+    swapWith.object = tempObject;
+    swapWith.block = tempBlock;
+}
+
+/*
+================
+SharedPtr<T>::Release
+================
+*/
+template<class T>
+void SharedPtr<T>::Release( void ) {
+    if( block != NULL ) {
+        SharedControlBlockReleaseStrong( block );
+    }
+}
+
+/*
+================
+SharedPtr<T>::DeAllocateObject
+================
+*/
+template<class T>
+template<class Allocator>
+void SharedPtr<T>::DeAllocateObject( SharedControlBlock *block ) {
+    T *object = reinterpret_cast<T*>( block->object );
+    Allocator *allctr = reinterpret_cast<Allocator*>( block->allocator );
+
+    object->~T( );
+    allctr->DeAllocate( object );
+}
+
+/*
+================
+MakeSharedFromBlock
+
+Wraps a block that already holds one strong reference, for MakeShared.
+================
+*/
+template<class T>
+SharedPtr<T> MakeSharedFromBlock( SharedControlBlock *block, T *object ) {
+    return SharedPtr<T>( block, object );
+}
+
+
+/*
+===============================================================================
+
+Weak pointer class
+
+Doesn't keep the object alive, Lock( ) for a SharedPtr to it (null if it's already been destroyed).
+
+===============================================================================
+*/
+template<class T>
+class WeakPtr {
+public:
+                        WeakPtr( void ) { object = NULL; block = NULL; }
+                        WeakPtr( const SharedPtr<T> &ref );
+                        WeakPtr( const WeakPtr<T> &ref );
+                        ~WeakPtr( void ) { Release( ); }
+
+    WeakPtr &           operator=( const WeakPtr<T> &rhs );
+    WeakPtr &           operator=( const SharedPtr<T> &rhs );
+
+                        // a SharedPtr keeping the object alive, or a null one if the object is gone
+    SharedPtr<T>        Lock( void ) const;
+                        // true once the object has been destroyed, a false result can be out of date by the time it's read
+    bool                IsExpired( void ) const { return ( block == NULL || AtomicLoad32( &block->strong ) == 0 ); }
+
+    void                Reset( void );
+    void                Swap( WeakPtr<T> &swapWith );
+
+private:
+    void                Release( void );
+
+    T                 * object;
+    SharedControlBlock * block;
+};
+
+/*
+================
+WeakPtr<T>::WeakPtr
+================
+*/
+template<class T>
+WeakPtr<T>::WeakPtr( const SharedPtr<T> &ref ) {
+    object = ref.object;
+    block = ref.block;
+    if( block != NULL ) {
+        AtomicAdd32( &block->weak, 1 );
+    }
+}
+
+template<class T>
+WeakPtr<T>::WeakPtr( const WeakPtr<T> &ref ) {
+    object = ref.object;
+    block = ref.block;
+    if( block != NULL ) {
+        AtomicAdd32( &block->weak, 1 );
+    }
+}
+
+/*
+================
+WeakPtr<T>::operator=
+================
+*/
+template<class T>
+WeakPtr<T>& WeakPtr<T>::operator=( const WeakPtr<T> &rhs ) {
+    WeakPtr<T> temp( rhs );
+    Swap( temp );
+    return *this;
+}
+
+template<class T>
+WeakPtr<T>& WeakPtr<T>::operator=( const SharedPtr<T> &rhs ) {
+    WeakPtr<T> temp( rhs );
+    Swap( temp );
+    return *this;
+}
+
+/*
+================
+WeakPtr<T>::Lock
+================
+*/
+template<class T>
+SharedPtr<T> WeakPtr<T>::Lock( void ) const {
+    if( block == NULL || SharedControlBlockTryAddStrong( block ) == false ) {
+        return SharedPtr<T>( );
+    }
+
+    return MakeSharedFromBlock( block, object );
+}
+
+/*
+================
+WeakPtr<T>::Reset
+================
+*/
+template<class T>
+void WeakPtr<T>::Reset( void ) {
+    Release( );
+    object = NULL;
+    block = NULL;
+}
+
+/*
+================
+WeakPtr<T>::Swap
+================
+*/
+template<class T>
+void WeakPtr<T>::Swap( WeakPtr<T> &swapWith ) {
+    T *tempObject = object;
+    SharedControlBlock *tempBlock = block;
+
+    object = swapWith.object;
+    block = swapWith.block;
+
+    swapWith.object = tempObject;
+    swapWith.block = tempBlock;
+}
+
+/*
+================
+WeakPtr<T>::Release
+================
+*/
+template<class T>
+void WeakPtr<T>::Release( void ) {
+    if( block != NULL ) {
+        SharedControlBlockReleaseWeak( block );
+    }
+}
+
+
+/*
+===============================================================================
+
+MakeShared
+
+Construct a T from up to four arguments in the same heap allocation as its control block.
+
+===============================================================================
+*/
+template<class T>
+struct SharedInplace {
+                        // at least 16, more for over-aligned types (AVX vectors, cache line aligned structs)
+    enum { OBJECT_ALIGNMENT = ( AlignOf<T>::value > 16 ) ? AlignOf<T>::value : 16 };
+
+                        // the block comes first, the object follows at an offset aligned for it
+    static U32          ObjectOffset( void ) { return ( sizeof( SharedControlBlock ) + ( OBJECT_ALIGNMENT - 1 ) ) & ~( OBJECT_ALIGNMENT - 1 ); }
+    static T *          GetObject( SharedControlBlock *block ) { return reinterpret_cast<T*>( reinterpret_cast<U8*>( block ) + ObjectOffset( ) ); }
+
+    static SharedControlBlock * Allocate( void );
+    static void         DestroyObject( SharedControlBlock *block ) { GetObject( block )->~T( ); }
+    static void         FreeBlock( SharedControlBlock *block );
+};
+
+/*
+================
+SharedInplace<T>::Allocate
+
+Counts and callbacks filled in, the object still has to be constructed.
+================
+*/
+template<class T>
+SharedControlBlock* SharedInplace<T>::Allocate( void ) {
+    HeapAllocator<U8> allctr;
+    SharedControlBlock *block = reinterpret_cast<SharedControlBlock*>( RT_ALLOC( allctr, ObjectOffset( ) + sizeof( T ), OBJECT_ALIGNMENT ) );
+    RT_SLOW_ASSERT( ( reinterpret_cast<size_t>( GetObject( block ) ) & ( AlignOf<T>::value - 1 ) ) == 0 );
+
+    block->strong = 1;
+    block->weak = 1;
+    block->destroyObject = DestroyObject;
+    block->freeBlock = FreeBlock;
+    block->object = GetObject( block );
+    block->allocator = NULL;
+    return block;
+}
+
+/*
+================
+SharedInplace<T>::FreeBlock
+================
+*/
+template<class T>
+void SharedInplace<T>::FreeBlock( SharedControlBlock *block ) {
+    HeapAllocator<U8> allctr;
+    allctr.DeAllocate( reinterpret_cast<U8*>( block ) );
+}
+
+/*
+================
+MakeShared
+================
+*/
+template<class T>
+SharedPtr<T> MakeShared( void ) {
+    SharedControlBlock *block = SharedInplace<T>::Allocate( );
+    return MakeSharedFromBlock( block, new( block->object ) T( ) );
+}
+
+template<class T, class A1>
+SharedPtr<T> MakeShared( const A1 &a1 ) {
+    SharedControlBlock *block = SharedInplace<T>::Allocate( );
+    return MakeSharedFromBlock( block, new( block->object ) T( a1 ) );
+}
+
+template<class T, class A1, class A2>
+SharedPtr<T> MakeShared( const A1 &a1, const A2 &a2 ) {
+    SharedControlBlock *block = SharedInplace<T>::Allocate( );
+    return MakeSharedFromBlock( block, new( block->object ) T( a1, a2 ) );
+}
+
+template<class T, class A1, class A2, class A3>
+SharedPtr<T> MakeShared( const A1 &a1, const A2 &a2, const A3 &a3 ) {
+    SharedControlBlock *block = SharedInplace<T>::Allocate( );
+    return MakeSharedFromBlock( block, new( block->object ) T( a1, a2, a3 ) );
+}
+
+template<class T, class A1, class A2, class A3, class A4>
+SharedPtr<T> MakeShared( const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4 ) {
+    SharedControlBlock *block = SharedInplace<T>::Allocate( );
+    return MakeSharedFromBlock( block, new( block->object ) T( a1, a2, a3, a4 ) );
+}
+
+
+#endif // RT_SHARED_PTR_H
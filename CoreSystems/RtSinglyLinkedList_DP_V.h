@@ -157,7 +157,8 @@ SinglyLinkedList<T>::SinglyLinkedList(bool _isAligned, U8 _alignment)
     // we cannot simply have the pool allocator as a member as its ctor relies on param values we won't have
     // at compile time and since we want to avoid dynamic allcation where possible, we construct the allocator here,
     // and declare it static so it will stay in memory, we then set the pointer to it to work around scope issues
-    static DynamicPoolAllocator<Node> memallctr(sizeof(Node), 1, alignment); // make 1 node - which'll effectively be the head in the pool allocators internal list (still a usable node) so set to 1
+    // nodes are carved from contiguous slabs so traversal stays cache friendly
+    static DynamicPoolAllocator<Node> memallctr(sizeof(Node), 1, alignment, DEFAULT_DYNAMIC_POOL_SLAB_SIZE); // make 1 node - which'll effectively be the head in the pool allocators internal list (still a usable node) so set to 1
     memAllctr = &memallctr;
 
     // setup head and first element
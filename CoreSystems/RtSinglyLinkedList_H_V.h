@@ -158,7 +158,7 @@ SinglyLinkedList<T>::SinglyLinkedList(/*ALLOC_SOURCE _memSource, ALLOC_USAGE _me
     //memUsage  = _memUsage;
 
     // set head
-    head = memAllctr.Allocate(sizeof(Node), alignment);
+    head = RT_ALLOC(memAllctr, sizeof(Node), alignment);
     //- COMMENTED OUT AFTER CHANGING HEAP.CONSTRUCT FROM U& TO U*Node temp; // default ctor - safe/dummy/null
     memAllctr.Construct<Node>(head/*, temp*/);
     head->next = 0;
@@ -214,7 +214,7 @@ template<class T>
 void SinglyLinkedList<T>::InsertAfter(const Iterator &itr, const T &val)
 {
     // create new node
-    Node *temp = memAllctr.Allocate(sizeof(Node), alignment);
+    Node *temp = RT_ALLOC(memAllctr, sizeof(Node), alignment);
     memAllctr.Construct<Node>(temp/*, &val*/);
 
     // insert into list
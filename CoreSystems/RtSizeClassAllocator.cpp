@@ -0,0 +1,159 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtSizeClassAllocator.cpp
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    General purpose allocator built on the pool allocators, see RtSizeClassAllocator.h.
+
+===============================================================================
+*/
+
+
+#include "RtSizeClassAllocator.h"
+#include "RtDynamicPoolAllocator.h"
+#include "RtSpinLock.h"
+#include "../PlatformIndependenceLayer/RtVirtualMemory.h"
+
+
+// size class value stored for allocations that went straight to the os
+static const U8 LARGE_ALLOCATION = 0xFF;
+// each pool grows by roughly this many bytes at a time
+static const U32 SIZE_CLASS_SLAB_BYTES = 64 * 1024;
+// slab starts are aligned to this, every block in a class is aligned to at least this much
+static const U8 SIZE_CLASS_BLOCK_ALIGNMENT = 16;
+
+// one pool per size class, each on its own cache line(s) so the locks don't false share
+struct RT_ALIGN( RT_CACHE_LINE_SIZE ) SizeClass {
+    SpinLock                       lock;
+    DynamicPoolAllocator<void>   * pool;
+    union {
+        U8                         storage[sizeof( DynamicPoolAllocator<void> )];
+        void                     * forAlignment;
+    };
+};
+
+static SizeClass sizeClasses[SizeClassHeap::SIZE_CLASS_COUNT];
+
+
+/*
+================
+GetSizeClassIndex
+
+Index of the smallest size class that can hold @sizeInBytes.
+================
+*/
+static U32 GetSizeClassIndex( size_t sizeInBytes ) {
+    if( sizeInBytes <= ( 1 << SizeClassHeap::MIN_SIZE_CLASS_SHIFT ) ) {
+        return 0;
+    }
+
+    // ceil( log2( sizeInBytes ) ) via the index of the highest set bit of ( sizeInBytes - 1 )
+    U32 value = static_cast<U32>( sizeInBytes - 1 );
+#if RT_COMPILER == RT_COMPILER_MSVC
+    unsigned long highestBit;
+    _BitScanReverse( &highestBit, value );
+    U32 shift = static_cast<U32>( highestBit ) + 1;
+#elif RT_COMPILER == RT_COMPILER_GCC
+    U32 shift = 32 - static_cast<U32>( __builtin_clz( value ) );
+#endif // RT_COMPILER
+
+    return shift - SizeClassHeap::MIN_SIZE_CLASS_SHIFT;
+}
+
+/*
+================
+SizeClassHeap::Allocate
+================
+*/
+void* SizeClassHeap::Allocate( size_t sizeInBytes, U8 alignment ) {
+    RT_SLOW_ASSERT( ( alignment < 1 ) == false );
+
+    // worst case we need two header bytes and up to (alignment - 1) bytes of padding
+    size_t required = sizeInBytes + alignment + 1;
+
+    size_t raw = 0;
+    U8 sizeClass = LARGE_ALLOCATION;
+
+    if( required <= ( 1 << MAX_SIZE_CLASS_SHIFT ) ) {
+        U32 index = GetSizeClassIndex( required );
+        sizeClass = static_cast<U8>( index );
+
+        SizeClass &thisClass = sizeClasses[index];
+        ScopedSpinLock lock( thisClass.lock );
+
+        if( thisClass.pool == NULL ) {
+            U32 blockSize = 1 << ( index + MIN_SIZE_CLASS_SHIFT );
+            thisClass.pool = new( thisClass.storage ) DynamicPoolAllocator<void>( blockSize, 0, SIZE_CLASS_BLOCK_ALIGNMENT, SIZE_CLASS_SLAB_BYTES / blockSize );
+        }
+
+        raw = reinterpret_cast<size_t>( thisClass.pool->Allocate( ) );
+    }
+    else {
+        // too big for the pools, go to the os - the mapping size is kept at the start of the mapping
+        required += sizeof( size_t );
+        void *pages = AllocatePages( required );
+        if( pages == NULL ) {
+            return NULL;
+        }
+
+        *reinterpret_cast<size_t*>( pages ) = required;
+        raw = reinterpret_cast<size_t>( pages ) + sizeof( size_t );
+    }
+
+    // align, leaving room for the two header bytes
+    size_t temp = raw + 2;
+    size_t misalignment = ( temp & ( alignment-1 ) ); // alignment-1 = mask
+    temp += ( misalignment != 0 ) ? ( alignment - misalignment ) : 0;
+
+    // store the size class and the adjustment in the two bytes immediately preceeding the adjusted address
+    U8 *header = reinterpret_cast<U8*>( temp - 2 );
+    header[0] = sizeClass;
+    header[1] = static_cast<U8>( temp - raw );
+
+    return reinterpret_cast<void*>( temp );
+}
+
+/*
+================
+SizeClassHeap::DeAllocate
+================
+*/
+void SizeClassHeap::DeAllocate( void *freeThis ) {
+    if( freeThis == NULL ) {
+        return;
+    }
+
+    U8 *temp = reinterpret_cast<U8*>( freeThis );
+    U8 sizeClass = *( temp - 2 );
+    U8 *raw = temp - *( temp - 1 );
+
+    if( sizeClass == LARGE_ALLOCATION ) {
+        U8 *pages = raw - sizeof( size_t );
+        FreePages( pages, *reinterpret_cast<size_t*>( pages ) );
+        return;
+    }
+
+    RT_SLOW_ASSERT( sizeClass < SIZE_CLASS_COUNT );
+
+    SizeClass &thisClass = sizeClasses[sizeClass];
+    ScopedSpinLock lock( thisClass.lock );
+    thisClass.pool->DeAllocate( reinterpret_cast<void*>( raw ) );
+}
+
+/*
+================
+SizeClassHeap::Shutdown
+================
+*/
+void SizeClassHeap::Shutdown( void ) {
+    for( U32 i=0; i<SIZE_CLASS_COUNT; ++i ) {
+        ScopedSpinLock lock( sizeClasses[i].lock );
+        if( sizeClasses[i].pool != NULL ) {
+            sizeClasses[i].pool->~DynamicPoolAllocator<void>( );
+            sizeClasses[i].pool = NULL;
+        }
+    }
+}
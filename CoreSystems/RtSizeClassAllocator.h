@@ -0,0 +1,155 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtSizeClassAllocator.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    General purpose allocator built on the pool allocators. Requests are rounded up to a
+                     power of two size class (16, 32, 64 ... 4096 bytes) and served from that class's pool,
+                     anything bigger goes straight to the os a page at a time.
+
+                     Each size class has its own pool and its own lock, so there's no single heap lock for
+                     threads to fight over and picking a class is a bit scan, allocation cost is O(1).
+
+                     SizeClassAllocator<T> has the same interface as HeapAllocator<T> and holds no state of
+                     its own, every instance shares the same SizeClassHeap, so memory allocated through one
+                     instance can be freed through another.
+
+                     Each allocation keeps two bytes in front of the returned address, the size class and
+                     the alignment adjustment (the heap allocator keeps one).
+
+===============================================================================
+*/
+
+
+#ifndef RT_SIZE_CLASS_ALLOCATOR_H
+#define RT_SIZE_CLASS_ALLOCATOR_H
+
+
+#include "../RtCommonHeaders.h"
+#include "RtAssert.h"
+#include "RtMemoryCommon.h"
+
+
+/*
+===============================================================================
+
+Size Class Heap class
+
+Shared state behind every SizeClassAllocator.
+
+===============================================================================
+*/
+class SizeClassHeap {
+public:
+                        // smallest and largest pooled size classes, as powers of two (16 & 4096 bytes)
+    static const U32    MIN_SIZE_CLASS_SHIFT = 4;
+    static const U32    MAX_SIZE_CLASS_SHIFT = 12;
+    static const U32    SIZE_CLASS_COUNT = ( MAX_SIZE_CLASS_SHIFT - MIN_SIZE_CLASS_SHIFT ) + 1;
+
+                        // pools are created on first use
+    static void       * Allocate( size_t sizeInBytes, U8 alignment );
+    static void         DeAllocate( void *freeThis );
+
+                        // release every pool, nothing allocated from the heap may be used after this
+    static void         Shutdown( void );
+
+private:
+                        SizeClassHeap( void ) { }
+};
+
+
+/*
+===============================================================================
+
+Size Class Allocator class
+
+===============================================================================
+*/
+template<typename T = void>
+class SizeClassAllocator {
+public:
+         SizeClassAllocator( void );
+         ~SizeClassAllocator( void );
+
+    // Allocate - get uninitialized memory, file/line are accepted for RT_ALLOC but not tracked
+    T*   Allocate( size_t sizeInBytes, U8 alignment = 1, const I8 *file = NULL, U32 line = 0 );
+
+    // DeAllocate
+    void DeAllocate( T *freeThis );
+
+    // Construct & destruct- don't use on POD or void
+    template<class U>
+    void Construct( U *posInMem, const U &val = 0 );
+    template<class U>
+    void Destruct( U *toDestruct );
+};
+
+
+/*
+================
+SizeClassAllocator<T>::SizeClassAllocator
+================
+*/
+template<class T>
+SizeClassAllocator<T>::SizeClassAllocator( void ) {
+    // ...
+}
+
+/*
+================
+SizeClassAllocator<T>::~SizeClassAllocator
+================
+*/
+template<class T>
+SizeClassAllocator<T>::~SizeClassAllocator( void ) {
+    // ...
+}
+
+/*
+================
+SizeClassAllocator<T>::Allocate
+================
+*/
+template<class T>
+T* SizeClassAllocator<T>::Allocate( size_t sizeInBytes, U8 alignment, const I8 * /*file*/, U32 /*line*/ ) {
+    return reinterpret_cast<T*>( SizeClassHeap::Allocate( sizeInBytes, alignment ) );
+}
+
+/*
+================
+SizeClassAllocator<T>::DeAllocate
+================
+*/
+template<class T>
+void SizeClassAllocator<T>::DeAllocate( T *freeThis ) {
+    SizeClassHeap::DeAllocate( reinterpret_cast<void*>( freeThis ) );
+}
+
+/*
+================
+SizeClassAllocator<T>::Construct
+================
+*/
+template<class T>
+template<class U>
+void SizeClassAllocator<T>::Construct( U *posInMem, const U &val ) {
+    // use placement new
+    new( reinterpret_cast<void*>( posInMem ) ) U( val );
+}
+
+/*
+================
+SizeClassAllocator<T>::Destruct
+================
+*/
+template<class T>
+template<class U>
+void SizeClassAllocator<T>::Destruct( U *toDestruct ) {
+    toDestruct->~U( );
+}
+
+
+#endif // RT_SIZE_CLASS_ALLOCATOR_H
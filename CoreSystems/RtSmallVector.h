@@ -0,0 +1,486 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtSmallVector.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Vector with room for N elements inside the object itself, the allocator is only used once
+                     more than N elements are added. Meant for the many small collections (materials per mesh,
+                     delimiter sets and so on) that rarely hold more than a handful of elements, they cost no
+                     heap allocation and sit next to whatever owns them.
+
+                     Same interface as Vector (RtVector.h). Resize/Clear move the elements back into the inline
+                     storage when they fit.
+
+===============================================================================
+*/
+
+
+#ifndef RT_SMALL_VECTOR_H
+#define RT_SMALL_VECTOR_H
+
+
+#include "RtCommonHeaders.h"
+#include "RtAssert.h"
+#include "RtMemoryCommon.h"
+#include "RtTypeTraits.h"
+#include "RtAlgorithm.h"
+#include "../PlatformIndependenceLayer/RtAtomic.h" // RT_ALIGN
+
+
+// alignment of the inline storage and so the most a SmallVector can be asked for - can be overridden in RtConfiguration.h
+#ifndef SMALL_VECTOR_INLINE_ALIGNMENT
+    #define SMALL_VECTOR_INLINE_ALIGNMENT 16
+#endif // SMALL_VECTOR_INLINE_ALIGNMENT
+
+
+/*
+===============================================================================
+
+Small Vector class
+
+===============================================================================
+*/
+template<class T, U32 N, class Allocator>
+class SmallVector {
+public:
+                        // @alignment applies to the inline and the allocator's storage alike, so it can't be more than
+                        // SMALL_VECTOR_INLINE_ALIGNMENT (raise that for over-aligned elements)
+                        SmallVector( bool isAligned = false, size_t alignment = 0 );
+                        SmallVector( const SmallVector<T, N, Allocator> &ref );
+                        ~SmallVector( void );
+
+    void                operator=( const SmallVector<T, N, Allocator> &rhs );
+    bool                operator==( const SmallVector<T, N, Allocator> &rhs ) const;
+    bool                operator!=( const SmallVector<T, N, Allocator> &rhs ) const;
+    T &                 operator[]( U32 index ) { return data[index]; }
+    const T &           operator[]( U32 index ) const { return data[index]; }
+
+                        // construct every element up to capacity as @defaultValue
+    void                InitToDefault( const T &defaultValue );
+
+    void                PushBack( const T &value );
+                        // construct the new last element in place from up to four constructor arguments, returns it
+    T &                 EmplaceBack( void );
+    template<class A1>
+    T &                 EmplaceBack( const A1 &a1 );
+    template<class A1, class A2>
+    T &                 EmplaceBack( const A1 &a1, const A2 &a2 );
+    template<class A1, class A2, class A3>
+    T &                 EmplaceBack( const A1 &a1, const A2 &a2, const A3 &a3 );
+    template<class A1, class A2, class A3, class A4>
+    T &                 EmplaceBack( const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4 );
+    void                PushFront( const T &value );
+    void                Insert( U32 index, const T &value );
+                        // remove @count elements starting at @index
+    void                Remove( U32 index, U32 count = 1 );
+    void                PopBack( void );
+
+    const T &           GetFirst( void ) const { return data[0]; }
+    T &                 GetFirst( void ) { return data[0]; }
+    const T &           GetLast( void ) const { return data[occupied-1]; }
+    T &                 GetLast( void ) { return data[occupied-1]; }
+
+                        // index of the element, -1 if it isn't there
+    U32                 LinearSearch( const T &lookingFor ) const;
+    U32                 ReverseLinearSearch( const T &lookingFor ) const;
+
+                        // operator< or @compare( a, b ) returning true if a must come before b - not stable
+    void                Sort( void ) { ::Sort( data, occupied, Less<T>( ) ); }
+    template<class Compare>
+    void                Sort( Compare compare ) { ::Sort( data, occupied, compare ); }
+                        // for sorted vectors (using the same comparator), see RtAlgorithm.h
+    U32                 LowerBound( const T &value ) const { return ::LowerBound( data, occupied, value, Less<T>( ) ); }
+    template<class Compare>
+    U32                 LowerBound( const T &value, Compare compare ) const { return ::LowerBound( data, occupied, value, compare ); }
+    U32                 BinarySearch( const T &lookingFor ) const { return ::BinarySearch( data, occupied, lookingFor, Less<T>( ) ); }
+    template<class Compare>
+    U32                 BinarySearch( const T &lookingFor, Compare compare ) const { return ::BinarySearch( data, occupied, lookingFor, compare ); }
+
+    U32                 Capacity( void ) const { return capacity; }
+    U32                 Occupied( void ) const { return occupied; }
+    bool                IsEmpty( void ) const { return ( occupied == 0 ); }
+    bool                IsAligned( void ) const { return isAligned; }
+    size_t              Alignment( void ) const { return alignment; }
+                        // true while the elements are stored in the object itself
+    bool                IsInline( void ) const { return ( data == InlineData( ) ); }
+
+                        // never shrinks below N, elements beyond @newSize are destroyed
+    void                Resize( U32 newSize );
+                        // destroy the elements and release any allocator storage
+    void                Clear( void );
+
+private:
+    T *                 InlineData( void ) { return reinterpret_cast<T*>( inlineStorage.bytes ); }
+    const T *           InlineData( void ) const { return reinterpret_cast<const T*>( inlineStorage.bytes ); }
+                        // make room for at least one more element
+    void                Grow( void );
+
+    T                 * data;
+    U32                 capacity;
+    U32                 occupied;
+    size_t              alignment;
+    bool                isAligned;
+
+                        // raw bytes so nothing is constructed until it's added
+                        union InlineStorage {
+                            U8      bytes[N * sizeof( T )];
+                            U64     alignU64;
+                            F64     alignF64;
+                            void  * alignPointer;
+                        };
+    RT_ALIGN( SMALL_VECTOR_INLINE_ALIGNMENT ) InlineStorage inlineStorage;
+
+    Allocator           allctr;
+};
+
+/*
+================
+SmallVector<T, N, Allocator>::SmallVector
+================
+*/
+template<class T, U32 N, class Allocator>
+SmallVector<T, N, Allocator>::SmallVector( bool isAligned_, size_t alignment_ ) {
+    isAligned = isAligned_;
+    // the engine allocators treat an alignment of 1 as 'unaligned', 0 isn't valid
+    alignment = ( isAligned_ && alignment_ > 0 ) ? alignment_ : 1;
+    // the elements start out in the inline storage, it's only this aligned
+    RT_ASSERT( alignment <= SMALL_VECTOR_INLINE_ALIGNMENT );
+
+    data = InlineData( );
+    capacity = N;
+    occupied = 0;
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::SmallVector
+================
+*/
+template<class T, U32 N, class Allocator>
+SmallVector<T, N, Allocator>::SmallVector( const SmallVector<T, N, Allocator> &ref ) {
+    isAligned = ref.isAligned;
+    alignment = ref.alignment;
+    data = InlineData( );
+    capacity = N;
+    occupied = 0;
+
+    *this = ref;
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::~SmallVector
+================
+*/
+template<class T, U32 N, class Allocator>
+SmallVector<T, N, Allocator>::~SmallVector( void ) {
+    Clear( );
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::operator=
+================
+*/
+template<class T, U32 N, class Allocator>
+void SmallVector<T, N, Allocator>::operator=( const SmallVector<T, N, Allocator> &rhs ) {
+    if( &rhs == this ) {
+        return;
+    }
+
+    Clear( );
+    isAligned = rhs.isAligned;
+    alignment = rhs.alignment;
+
+    if( rhs.occupied > capacity ) {
+        Resize( rhs.occupied );
+    }
+
+    for( U32 i=0; i<rhs.occupied; ++i ) {
+        new( reinterpret_cast<void*>( &data[i] ) ) T( rhs.data[i] );
+    }
+    occupied = rhs.occupied;
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::operator==
+================
+*/
+template<class T, U32 N, class Allocator>
+bool SmallVector<T, N, Allocator>::operator==( const SmallVector<T, N, Allocator> &rhs ) const {
+    if( occupied != rhs.occupied ) {
+        return false;
+    }
+
+    for( U32 i=0; i<occupied; ++i ) {
+        if( !( data[i] == rhs.data[i] ) ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::operator!=
+================
+*/
+template<class T, U32 N, class Allocator>
+bool SmallVector<T, N, Allocator>::operator!=( const SmallVector<T, N, Allocator> &rhs ) const {
+    return !( *this == rhs );
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::InitToDefault
+================
+*/
+template<class T, U32 N, class Allocator>
+void SmallVector<T, N, Allocator>::InitToDefault( const T &defaultValue ) {
+    Relocator<T>::Destroy( data, occupied );
+
+    for( U32 i=0; i<capacity; ++i ) {
+        new( reinterpret_cast<void*>( &data[i] ) ) T( defaultValue );
+    }
+    occupied = capacity;
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::PushBack
+================
+*/
+template<class T, U32 N, class Allocator>
+void SmallVector<T, N, Allocator>::PushBack( const T &value ) {
+    if( occupied == capacity ) {
+        // value may live in the vector, copy it before the storage moves
+        T temp( value );
+        Grow( );
+        new( reinterpret_cast<void*>( &data[occupied] ) ) T( Move( temp ) );
+    }
+    else {
+        new( reinterpret_cast<void*>( &data[occupied] ) ) T( value );
+    }
+
+    ++occupied;
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::EmplaceBack
+
+The arguments must not refer to elements of the vector, they may move when it grows.
+================
+*/
+template<class T, U32 N, class Allocator>
+T& SmallVector<T, N, Allocator>::EmplaceBack( void ) {
+    if( occupied == capacity ) {
+        Grow( );
+    }
+
+    return *( new( reinterpret_cast<void*>( &data[occupied++] ) ) T( ) );
+}
+
+template<class T, U32 N, class Allocator>
+template<class A1>
+T& SmallVector<T, N, Allocator>::EmplaceBack( const A1 &a1 ) {
+    if( occupied == capacity ) {
+        Grow( );
+    }
+
+    return *( new( reinterpret_cast<void*>( &data[occupied++] ) ) T( a1 ) );
+}
+
+template<class T, U32 N, class Allocator>
+template<class A1, class A2>
+T& SmallVector<T, N, Allocator>::EmplaceBack( const A1 &a1, const A2 &a2 ) {
+    if( occupied == capacity ) {
+        Grow( );
+    }
+
+    return *( new( reinterpret_cast<void*>( &data[occupied++] ) ) T( a1, a2 ) );
+}
+
+template<class T, U32 N, class Allocator>
+template<class A1, class A2, class A3>
+T& SmallVector<T, N, Allocator>::EmplaceBack( const A1 &a1, const A2 &a2, const A3 &a3 ) {
+    if( occupied == capacity ) {
+        Grow( );
+    }
+
+    return *( new( reinterpret_cast<void*>( &data[occupied++] ) ) T( a1, a2, a3 ) );
+}
+
+template<class T, U32 N, class Allocator>
+template<class A1, class A2, class A3, class A4>
+T& SmallVector<T, N, Allocator>::EmplaceBack( const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4 ) {
+    if( occupied == capacity ) {
+        Grow( );
+    }
+
+    return *( new( reinterpret_cast<void*>( &data[occupied++] ) ) T( a1, a2, a3, a4 ) );
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::PushFront
+================
+*/
+template<class T, U32 N, class Allocator>
+void SmallVector<T, N, Allocator>::PushFront( const T &value ) {
+    Insert( 0, value );
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::Insert
+
+Inserting past the end appends.
+================
+*/
+template<class T, U32 N, class Allocator>
+void SmallVector<T, N, Allocator>::Insert( U32 index, const T &value ) {
+    // value may live in the vector
+    T temp( value );
+
+    if( occupied == capacity ) {
+        Grow( );
+    }
+
+    if( index >= occupied ) {
+        index = occupied;
+    }
+    else {
+        Relocator<T>::Relocate( &data[index+1], &data[index], occupied-index );
+    }
+
+    new( reinterpret_cast<void*>( &data[index] ) ) T( Move( temp ) );
+    ++occupied;
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::Remove
+
+Doesn't release any memory, see Resize/Clear.
+================
+*/
+template<class T, U32 N, class Allocator>
+void SmallVector<T, N, Allocator>::Remove( U32 index, U32 count ) {
+    RT_ASSERT( index < occupied );
+
+    if( index + count > occupied ) {
+        count = occupied - index;
+    }
+
+    U32 upto = index + count;
+    Relocator<T>::Destroy( &data[index], count );
+    Relocator<T>::Relocate( &data[index], &data[upto], occupied-upto );
+    occupied -= count;
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::PopBack
+================
+*/
+template<class T, U32 N, class Allocator>
+void SmallVector<T, N, Allocator>::PopBack( void ) {
+    RT_SLOW_ASSERT( occupied > 0 );
+    data[--occupied].~T( );
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::LinearSearch
+================
+*/
+template<class T, U32 N, class Allocator>
+U32 SmallVector<T, N, Allocator>::LinearSearch( const T &lookingFor ) const {
+    return ::LinearSearch( data, occupied, lookingFor );
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::ReverseLinearSearch
+================
+*/
+template<class T, U32 N, class Allocator>
+U32 SmallVector<T, N, Allocator>::ReverseLinearSearch( const T &lookingFor ) const {
+    return ::ReverseLinearSearch( data, occupied, lookingFor );
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::Resize
+================
+*/
+template<class T, U32 N, class Allocator>
+void SmallVector<T, N, Allocator>::Resize( U32 newSize ) {
+    if( newSize < N ) {
+        newSize = N;
+    }
+
+    U32 upto = ( occupied < newSize ) ? occupied : newSize;
+    Relocator<T>::Destroy( &data[upto], occupied - upto );
+    occupied = upto;
+
+    if( newSize == capacity ) {
+        return;
+    }
+
+    T *old = data;
+    data = ( newSize == N ) ? InlineData( ) : RT_ALLOC( allctr, newSize * sizeof( T ), static_cast<U8>( alignment ) );
+    RT_ASSERT( data != NULL );
+
+    Relocator<T>::RelocateDisjoint( data, old, occupied );
+
+    if( old != InlineData( ) ) {
+        allctr.DeAllocate( old );
+    }
+
+    capacity = newSize;
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::Clear
+================
+*/
+template<class T, U32 N, class Allocator>
+void SmallVector<T, N, Allocator>::Clear( void ) {
+    Relocator<T>::Destroy( data, occupied );
+    occupied = 0;
+
+    if( data != InlineData( ) ) {
+        allctr.DeAllocate( data );
+        data = InlineData( );
+        capacity = N;
+    }
+}
+
+/*
+================
+SmallVector<T, N, Allocator>::Grow
+
+1.5x, same as Vector.
+================
+*/
+template<class T, U32 N, class Allocator>
+void SmallVector<T, N, Allocator>::Grow( void ) {
+    U32 newCapacity = capacity + ( capacity >> 1 );
+
+    if( newCapacity < occupied + 1 ) {
+        newCapacity = occupied + 1;
+    }
+
+    Resize( newCapacity );
+}
+
+
+#endif // RT_SMALL_VECTOR_H
@@ -0,0 +1,76 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtSpinLock.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Basic test-and-test-and-set spin lock. Only meant for guarding very short critical
+                     sections (a handful of pointer updates) where an os mutex would cost more than the work.
+
+                     ScopedSpinLock locks on construction and unlocks on destruction.
+
+===============================================================================
+*/
+
+
+#ifndef RT_SPIN_LOCK_H
+#define RT_SPIN_LOCK_H
+
+
+#include "../PlatformIndependenceLayer/RtAtomic.h"
+#include "RtUncopyable_V.h"
+
+
+/*
+===============================================================================
+
+Spin lock class
+
+===============================================================================
+*/
+class SpinLock : public Uncopyable {
+public:
+                    SpinLock( void ) { lockFlag = 0; }
+                    ~SpinLock( void ) { }
+
+    void            Lock( void ) {
+                        for( ;; ) {
+                            if( AtomicExchange32( &lockFlag, 1 ) == 0 ) {
+                                return;
+                            }
+                            // spin on a plain read so we don't bounce the cache line between cores
+                            while( AtomicLoad32( &lockFlag ) != 0 ) {
+                                CpuPause( );
+                            }
+                        }
+                    }
+
+    bool            TryLock( void ) { return ( AtomicExchange32( &lockFlag, 1 ) == 0 ); }
+
+    void            Unlock( void ) { AtomicStore32( &lockFlag, 0 ); }
+
+private:
+    volatile U32    lockFlag;
+};
+
+
+/*
+===============================================================================
+
+Scoped spin lock class
+
+===============================================================================
+*/
+class ScopedSpinLock : public Uncopyable {
+public:
+    explicit        ScopedSpinLock( SpinLock &lock_ ) : lock( lock_ ) { lock.Lock( ); }
+                    ~ScopedSpinLock( void ) { lock.Unlock( ); }
+
+private:
+    SpinLock      & lock;
+};
+
+
+#endif // RT_SPIN_LOCK_H
@@ -3,14 +3,44 @@
     -----------
     File        :    StackAllocator.h
     Author      :    Jamie Taylor
-    Last Edit   :    30/06/12
+    Last Edit   :    17/10/26
     Desc        :    Stack fashioned memory allocator.
+
+                     17/10/26 - Added STACK_VIRTUAL mode, a (large) range of address space is reserved up front and pages are
+                                committed as the top advances, so the stack only fails when the reservation runs out and its
+                                resident set follows actual use. If releaseAboveInBytes is non-zero, Clear() hands back any
+                                committed pages above that high-water mark.
+
+                     17/10/26 - Added markers, GetMarker()/FreeToMarker() roll the stack back to an earlier point in one go and
+                                ScopedStackFrame does it automatically on scope exit. AllocateNoHeader() skips the adjustment byte
+                                for callers that only ever free to markers, it can't be passed to DeAllocate().
 */
 #ifndef RT_STACK_ALLOCATOR_H
 #define RT_STACK_ALLOCATOR_H
 
 
 #include "../RtCommonHeaders.h"
+#include "../PlatformIndependenceLayer/RtVirtualMemory.h"
+
+
+// pages are committed at least this many bytes at a time in STACK_VIRTUAL mode
+#ifndef STACK_ALLOCATOR_COMMIT_STEP
+    #define STACK_ALLOCATOR_COMMIT_STEP (64 * 1024)
+#endif // STACK_ALLOCATOR_COMMIT_STEP
+
+
+/**************************************************************************************************************************/
+// Enums
+/**************************************************************************************************************************/
+// where the stack gets its memory from
+enum STACK_ALLOCATOR_MODE
+{
+    // a fixed buffer - passed in or allocated via global new
+    STACK_FIXED = 0,
+    // reserved address space, committed on demand
+    STACK_VIRTUAL,
+};
+/**************************************************************************************************************************/
 
 
 /**************************************************************************************************************************/
@@ -20,10 +50,15 @@ template<class T = void> // default to void for standard 'raw' memory allocator
 class StackAllocator
 {
 public:
+    // A point in the stack that can be rolled back to (byte offset from the stack base)
+    typedef size_t Marker;
+
     // Default ctor - to aid in creating double buffered allocators
     StackAllocator();
     // Ctor
     StackAllocator(size_t sizeInBytes, U8 *mem, size_t offset = 0);
+    // Virtual memory backed ctor - reserve reserveInBytes of address space, keep at most releaseAboveInBytes committed across Clear() (0 = keep everything)
+    StackAllocator(STACK_ALLOCATOR_MODE mode, size_t reserveInBytes, size_t releaseAboveInBytes = 0);
     // Dtor
     ~StackAllocator();
 
@@ -32,6 +67,13 @@ public:
     // Aligned and unaligned de-allocation
     void DeAllocate(T *freeThis);
 
+    // Aligned and unaligned allocation without the adjustment byte - free with FreeToMarker()/Clear() only
+    T* AllocateNoHeader(size_t sizeInBytes, U8 alignment = 1);
+
+    // Get the current top as a marker, free everything allocated since
+    Marker GetMarker() const;
+    void FreeToMarker(Marker marker);
+
     // Construct & destruct - not necessary for POD and void
     template<class U>
     void Construct(U *posInMem, const U &val = 0);
@@ -45,8 +87,13 @@ public:
     size_t GetTop() const;
     // Get remaining space in bytes
     size_t GetRemainingSpace() const;
+    // Get the number of bytes currently backed by memory (the whole buffer in STACK_FIXED mode)
+    size_t GetCommittedSize() const;
 
 private:
+    // STACK_VIRTUAL - make sure everything below newTop is committed
+    void CommitUpTo(U8 *newTop);
+
     // pointer to the dynamically allocated memory (new/malloc...)
     U8 *stack;
     // pointer to the current stack top
@@ -55,6 +102,12 @@ private:
     U8 *limit; // void* ?
     // were we maybe passed part of a global buffer, or are we allocating our own memory via global new?
     bool usingLocal;
+
+    // STACK_VIRTUAL - everything below committed is backed by memory, limit marks the end of the reservation
+    STACK_ALLOCATOR_MODE mode;
+    U8 *committed;
+    // high-water mark for Clear(), 0 to never release
+    size_t releaseAbove;
 };
 /**************************************************************************************************************************/
 
@@ -69,6 +122,10 @@ StackAllocator<T>::StackAllocator()
     top = 0;
     limit = 0;
     usingLocal = false;
+
+    mode = STACK_FIXED;
+    committed = 0;
+    releaseAbove = 0;
 }
 /**************************************************************************************************************************/
 
@@ -89,13 +146,37 @@ StackAllocator<T>::StackAllocator(size_t sizeInBytes, U8 *mem, size_t offset)
         limit = &stack[sizeInBytes];
         usingLocal = true;
     }
+
+    mode = STACK_FIXED;
+    committed = limit;
+    releaseAbove = 0;
+}
+/**************************************************************************************************************************/
+
+template<class T>
+StackAllocator<T>::StackAllocator(STACK_ALLOCATOR_MODE _mode, size_t reserveInBytes, size_t releaseAboveInBytes)
+{
+    RT_SLOW_ASSERT(_mode == STACK_VIRTUAL);
+
+    // only address space for now, nothing is committed until it's allocated
+    top = stack = reinterpret_cast<U8*>(ReservePages(reserveInBytes));
+    RT_ASSERT(stack != 0);
+    limit = &stack[reserveInBytes];
+    usingLocal = false;
+
+    mode = _mode;
+    committed = stack;
+    releaseAbove = releaseAboveInBytes;
 }
 /**************************************************************************************************************************/
 
 template<class T>
 StackAllocator<T>::~StackAllocator()
 {
-    top = limit = 0;
+    if(mode == STACK_VIRTUAL && stack)
+        ReleasePages(stack, static_cast<size_t>(limit - stack));
+
+    top = limit = committed = 0;
 
     if(usingLocal)
         operator delete(reinterpret_cast<void*>(stack));
@@ -116,6 +197,10 @@ T* StackAllocator<T>::Allocate(size_t sizeInBytes, U8 alignment)
     size_t temp = reinterpret_cast<size_t>(top);
     top += (sizeInBytes + alignment);
 
+    // grow into the reservation
+    if(top > committed)
+        CommitUpTo(top);
+
     // get the misalignment; mask = alignment-1
     size_t misalignment = (temp & (alignment-1));
     // get the adjustment needed
@@ -123,9 +208,10 @@ T* StackAllocator<T>::Allocate(size_t sizeInBytes, U8 alignment)
     // get the newly aligned address
     temp += adjustment;
 
-    // store adjustment info in preceeding byte
-    uintptr_t *p = reinterpret_cast<uintptr_t*>(temp - 1);
-    *p = adjustment;
+    // store adjustment info in preceeding byte - a single byte, anything wider could run past top onto a page
+    // that hasn't been committed (the adjustment is at most 128 so it fits)
+    U8 *p = reinterpret_cast<U8*>(temp - 1);
+    *p = static_cast<U8>(adjustment);
 
     // return the address
     return reinterpret_cast<T*>(temp);
@@ -141,6 +227,45 @@ void StackAllocator<T>::DeAllocate(T *freeThis)
 }
 /**************************************************************************************************************************/
 
+// Allocation with no adjustment info stored, top is simply aligned and bumped
+template<class T>
+T* StackAllocator<T>::AllocateNoHeader(size_t sizeInBytes, U8 alignment)
+{
+    RT_SLOW_ASSERT(!(alignment < 1));
+
+    // get the misalignment; mask = alignment-1
+    size_t temp = reinterpret_cast<size_t>(top);
+    size_t misalignment = (temp & (alignment-1));
+    temp += (misalignment != 0) ? (alignment - misalignment) : 0;
+
+    RT_SLOW_ASSERT(!((reinterpret_cast<U8*>(temp) + sizeInBytes) > limit));
+    top = reinterpret_cast<U8*>(temp) + sizeInBytes;
+
+    // grow into the reservation
+    if(top > committed)
+        CommitUpTo(top);
+
+    return reinterpret_cast<T*>(temp);
+}
+/**************************************************************************************************************************/
+
+// Get a marker for the current top
+template<class T>
+typename StackAllocator<T>::Marker StackAllocator<T>::GetMarker() const
+{
+    return static_cast<Marker>(top - stack);
+}
+/**************************************************************************************************************************/
+
+// Roll back to a marker, everything allocated after it is freed
+template<class T>
+void StackAllocator<T>::FreeToMarker(Marker marker)
+{
+    RT_SLOW_ASSERT(!(&stack[marker] > top)); // can only roll back, not forward
+    top = &stack[marker];
+}
+/**************************************************************************************************************************/
+
 // Construct an object at a memory address
 template<class T>
 template<class U>
@@ -165,6 +290,18 @@ template<class T>
 void StackAllocator<T>::Clear()
 {
     top = &stack[0];
+
+    // hand back anything committed above the high-water mark
+    if(mode == STACK_VIRTUAL && releaseAbove > 0 && static_cast<size_t>(committed - stack) > releaseAbove)
+    {
+        size_t pageSize = GetPageSize();
+        U8 *keepUpTo = &stack[(releaseAbove + (pageSize - 1)) & ~(pageSize - 1)];
+        if(keepUpTo < committed)
+        {
+            DecommitPages(keepUpTo, static_cast<size_t>(committed - keepUpTo));
+            committed = keepUpTo;
+        }
+    }
 }
 /**************************************************************************************************************************/
 
@@ -185,5 +322,60 @@ size_t StackAllocator<T>::GetRemainingSpace() const
 }
 /**************************************************************************************************************************/
 
+// How much of the stack is backed by memory?
+template<class T>
+size_t StackAllocator<T>::GetCommittedSize() const
+{
+    return static_cast<size_t>(committed - stack);
+}
+/**************************************************************************************************************************/
+
+// Commit pages (at least STACK_ALLOCATOR_COMMIT_STEP bytes at a time) until newTop is covered; not exposed to user
+template<class T>
+void StackAllocator<T>::CommitUpTo(U8 *newTop)
+{
+    RT_SLOW_ASSERT(mode == STACK_VIRTUAL);
+
+    size_t needed = static_cast<size_t>(newTop - committed);
+    size_t step = (needed > STACK_ALLOCATOR_COMMIT_STEP) ? needed : STACK_ALLOCATOR_COMMIT_STEP;
+
+    // round up to whole pages and don't run past the reservation
+    size_t pageSize = GetPageSize();
+    step = (step + (pageSize - 1)) & ~(pageSize - 1);
+    if(step > static_cast<size_t>(limit - committed))
+        step = static_cast<size_t>(limit - committed);
+
+    bool result = CommitPages(committed, step);
+    RT_ASSERT(result);
+    committed += step;
+}
+/**************************************************************************************************************************/
+
+
+/**************************************************************************************************************************/
+// Scoped stack frame - takes a marker on construction and rolls the stack back to it on destruction
+//
+// {
+//     ScopedStackFrame<> frame(scratchStack);
+//     U8 *temp = reinterpret_cast<U8*>(scratchStack.AllocateNoHeader(1024));
+//     ...
+// } // temp freed here
+/**************************************************************************************************************************/
+template<class T = void>
+class ScopedStackFrame
+{
+public:
+    explicit ScopedStackFrame(StackAllocator<T> &_allocator) : allocator(_allocator) { marker = allocator.GetMarker(); }
+    ~ScopedStackFrame() { allocator.FreeToMarker(marker); }
+
+private:
+    StackAllocator<T> &allocator;
+    typename StackAllocator<T>::Marker marker;
+
+    ScopedStackFrame(const ScopedStackFrame &ref) : allocator(ref.allocator) { /*do nothing - forbidden op*/ }
+    void operator=(const ScopedStackFrame & /*rhs*/) { /*do nothing - forbidden op*/ }
+};
+/**************************************************************************************************************************/
+
 
 #endif // RT_STACK_ALLOCATOR_H
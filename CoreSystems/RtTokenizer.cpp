@@ -5,16 +5,147 @@
     ==========
     File        :    RtTokenizer.cpp
     Author      :    Jamie Taylor
-    Last Edit   :    20/04/13
+    Last Edit   :    17/10/26
     Desc        :    A basic tokenizer, primarily written to parse .obj files.
                      A tokenizer takes a string and breaks it down U32o smaller strings called tokens,
                      various delimiters can be used to help identify tokens.
 
+                     17/10/26 - Added the zero-copy mode, see RtTokenizer.h.
+
 ===============================================================================
 */
 
 
 #include "RtTokenizer.h"
+#include "RtAssert.h"
+#include "../PlatformIndependenceLayer/RtPlatformInfo.h"
+#include <emmintrin.h>
+#include <immintrin.h>
+#if RT_COMPILER == RT_COMPILER_MSVC
+    #include <intrin.h>
+#endif // RT_COMPILER == RT_COMPILER_MSVC
+
+
+/*
+================
+CountTrailingZeros
+
+@mask must be non-zero.
+================
+*/
+static inline U32 CountTrailingZeros( U32 mask ) {
+#if RT_COMPILER == RT_COMPILER_MSVC
+    unsigned long index;
+    _BitScanForward( &index, mask );
+    return static_cast<U32>( index );
+#else
+    return static_cast<U32>( __builtin_ctz( mask ) );
+#endif // RT_COMPILER == RT_COMPILER_MSVC
+}
+
+/*
+================
+ScanTokenSSE2
+
+Finds the end of the token starting at @p - the first byte that isn't printable ascii or is one
+of the printable delimiters.
+================
+*/
+static const U8 * ScanTokenSSE2( const U8 *p, const U8 *end, const I8 *printable, U32 printableCount ) {
+    // bytes from 128 up are negative, so the signed compare catches them too
+    const __m128i low  = _mm_set1_epi8( 33 );
+    const __m128i high = _mm_set1_epi8( 126 );
+
+    for( ; ( p + 16 ) <= end; p += 16 ) {
+        __m128i chars = _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ) );
+        __m128i stop  = _mm_or_si128( _mm_cmplt_epi8( chars, low ), _mm_cmpgt_epi8( chars, high ) );
+        for( U32 i=0; i<printableCount; ++i ) {
+            stop = _mm_or_si128( stop, _mm_cmpeq_epi8( chars, _mm_set1_epi8( printable[i] ) ) );
+        }
+
+        U32 mask = static_cast<U32>( _mm_movemask_epi8( stop ) );
+        if( mask != 0 ) {
+            return p + CountTrailingZeros( mask );
+        }
+    }
+
+    return p;
+}
+
+/*
+================
+ScanTokenAVX2
+================
+*/
+RT_TARGET_AVX2 static const U8 * ScanTokenAVX2( const U8 *p, const U8 *end, const I8 *printable, U32 printableCount ) {
+    const __m256i low  = _mm256_set1_epi8( 33 );
+    const __m256i high = _mm256_set1_epi8( 126 );
+
+    for( ; ( p + 32 ) <= end; p += 32 ) {
+        __m256i chars = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( p ) );
+        __m256i stop  = _mm256_or_si256( _mm256_cmpgt_epi8( low, chars ), _mm256_cmpgt_epi8( chars, high ) );
+        for( U32 i=0; i<printableCount; ++i ) {
+            stop = _mm256_or_si256( stop, _mm256_cmpeq_epi8( chars, _mm256_set1_epi8( printable[i] ) ) );
+        }
+
+        U32 mask = static_cast<U32>( _mm256_movemask_epi8( stop ) );
+        if( mask != 0 ) {
+            _mm256_zeroupper( );
+            return p + CountTrailingZeros( mask );
+        }
+    }
+
+    _mm256_zeroupper( );
+    // finish off with 16 bytes at a time
+    return ScanTokenSSE2( p, end, printable, printableCount );
+}
+
+typedef const U8 * ( *ScanTokenFunction )( const U8*, const U8*, const I8*, U32 );
+
+// picked on first use, threads racing to pick store the same pointer
+static volatile ScanTokenFunction scanToken = NULL;
+
+
+/*
+================
+DelimiterSet::DelimiterSet
+================
+*/
+DelimiterSet::DelimiterSet( const I8 *delimiters_, U32 delimiterCount ) {
+    // everything outside of printable ascii separates tokens, as it always has
+    for( U32 i=0; i<256; ++i ) {
+        charClass[i] = ( ( i > 32 ) && ( i < 127 ) ) ? CHAR_TOKEN : CHAR_SKIP;
+    }
+    charClass['\n'] = CHAR_LINE_END;
+
+    printableCount = 0;
+    for( U32 i=0; i<delimiterCount; ++i ) {
+        U8 c = static_cast<U8>( delimiters_[i] );
+        if( charClass[c] == CHAR_TOKEN ) {
+            RT_ASSERT( printableCount < TOKENIZER_MAX_DELIMITERS );
+            delimiters[printableCount++] = delimiters_[i];
+        }
+        charClass[c] = CHAR_SKIP;
+    }
+}
+
+
+/*
+================
+TokenView::CopyTo
+================
+*/
+U32 TokenView::CopyTo( I8 *dest, U32 destSize ) const {
+    RT_ASSERT( destSize > 0 );
+
+    U32 count = ( length < destSize ) ? length : ( destSize - 1 );
+    for( U32 i=0; i<count; ++i ) {
+        dest[i] = start[i];
+    }
+    dest[count] = '\0';
+
+    return count;
+}
 
 
 /*
@@ -41,7 +172,7 @@ Tokenizer::~Tokenizer( void ) {
 Tokenizer::Tokenizer
 ================
 */
-void Tokenizer::SetBuffer( I8 *buffer_, U32 bufferSize_ ) {
+void Tokenizer::SetBuffer( const I8 *buffer_, U32 bufferSize_ ) {
     buffer = buffer_;
     bufferSize = bufferSize_;
 }
@@ -108,6 +239,52 @@ bool Tokenizer::GetNextToken( I8 *buffer_, I8 *delimiters, U32 delimiterCount )
     return true;
 }
 
+/*
+================
+Tokenizer::GetNextToken
+================
+*/
+bool Tokenizer::GetNextToken( TokenView &token, const DelimiterSet &delimiters ) {
+    const U8 *p   = reinterpret_cast<const U8*>( buffer ) + currentTokenStartIndex;
+    const U8 *end = reinterpret_cast<const U8*>( buffer ) + bufferSize;
+
+    // tokens are usually only a character or two apart, not worth a SIMD scan
+    while( ( p != end ) && ( delimiters.charClass[*p] == DelimiterSet::CHAR_SKIP ) ) {
+        ++p;
+    }
+
+    token.start = reinterpret_cast<const I8*>( p );
+    token.length = 0;
+
+    if( p == end ) {
+        currentTokenStartIndex = currentTokenEndIndex = bufferSize;
+        return false;
+    }
+
+    if( delimiters.charClass[*p] == DelimiterSet::CHAR_LINE_END ) {
+        ++p;
+    }
+    else {
+        ScanTokenFunction scan = scanToken;
+        if( scan == NULL ) {
+            scan = SupportsAVX2( ) ? ScanTokenAVX2 : ScanTokenSSE2;
+            scanToken = scan;
+        }
+
+        const U8 *tokenEnd = scan( p, end, delimiters.delimiters, delimiters.printableCount );
+        // the last few bytes that don't fill a vector
+        while( ( tokenEnd != end ) && ( delimiters.charClass[*tokenEnd] == DelimiterSet::CHAR_TOKEN ) ) {
+            ++tokenEnd;
+        }
+
+        token.length = static_cast<U32>( tokenEnd - p );
+        p = tokenEnd;
+    }
+
+    currentTokenStartIndex = currentTokenEndIndex = static_cast<U32>( p - reinterpret_cast<const U8*>( buffer ) );
+    return true;
+}
+
 /*
 ================
 Tokenizer::ClearAndRead
@@ -124,7 +301,7 @@ Tokenizer::ClearAndRead
 Tokenizer::Tokenizer
 ================
 */
-bool Tokenizer::IsValid( I8 *c ) const {
+bool Tokenizer::IsValid( const I8 *c ) const {
     // is *c a valid ascii character?
     U32 i = static_cast<U32>( *c );
     if( ( i > 32 ) && ( i < 127 ) ) {
@@ -138,7 +315,7 @@ bool Tokenizer::IsValid( I8 *c ) const {
 Tokenizer::Tokenizer
 ================
 */
-bool Tokenizer::IsDelimiter( I8 *c, I8 *delimiters, U32 delimiterCount ) {
+bool Tokenizer::IsDelimiter( const I8 *c, I8 *delimiters, U32 delimiterCount ) {
     for( U32 i=0; i<delimiterCount; ++i ) {
         if ( *c == delimiters[i] ) {
             return true;
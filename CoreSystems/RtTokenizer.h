@@ -5,11 +5,17 @@
     ==========
     File        :    RtTokenizer.h
     Author      :    Jamie Taylor
-    Last Edit   :    20/04/13
+    Last Edit   :    17/10/26
     Desc        :    A basic tokenizer, primarily written to parse .obj files.
                      A tokenizer takes a string and breaks it down into smaller strings called tokens,
                      various delimiters can be used to help identify tokens.
 
+                     17/10/26 - Added a zero-copy mode, tokens come back as views into the buffer. The
+                                delimiters are turned into a lookup table once (DelimiterSet) and the end of
+                                a token is found 16/32 bytes at a time with SSE2/AVX2.
+
+                     17/10/26 - The buffer is const, it's only ever read (so a read only mapped file will do).
+
 ===============================================================================
 */
 
@@ -21,6 +27,58 @@
 #include "../PlatformIndependenceLayer/RtPlatform.h"
 
 
+// printable delimiters a DelimiterSet can hold, whitespace is always a separator so doesn't count - can be overridden in RtConfiguration.h
+#ifndef TOKENIZER_MAX_DELIMITERS
+    #define TOKENIZER_MAX_DELIMITERS 8
+#endif // TOKENIZER_MAX_DELIMITERS
+
+
+/*
+===============================================================================
+
+TokenView, a token still sitting in the tokenizer's buffer (not null terminated)
+
+===============================================================================
+*/
+struct TokenView {
+    const I8  * start;
+    U32         length;
+
+                // the tokenizer returns an empty token at the end of each line
+    bool        IsEndOfLine( void ) const;
+    bool        Equals( const I8 *str ) const;
+                // null terminated copy, truncated to fit, returns the length copied
+    U32         CopyTo( I8 *dest, U32 destSize ) const;
+};
+
+
+/*
+===============================================================================
+
+DelimiterSet, a lookup table of what ends a token - build once and reuse
+
+===============================================================================
+*/
+class DelimiterSet {
+public:
+                DelimiterSet( const I8 *delimiters_, U32 delimiterCount );
+
+private:
+    friend class Tokenizer;
+
+    enum CharClass {
+        CHAR_TOKEN = 0,
+        CHAR_SKIP,
+        CHAR_LINE_END
+    };
+
+    U8          charClass[256];
+                // the delimiters a SIMD scan has to test for, the rest fall outside the printable range
+    I8          delimiters[TOKENIZER_MAX_DELIMITERS];
+    U32         printableCount;
+};
+
+
 /*
 ===============================================================================
 
@@ -33,7 +91,7 @@ public:
             Tokenizer( void );
             ~Tokenizer( void );
 
-    void    SetBuffer( I8 *buffer_, U32 bufferSize_ );
+    void    SetBuffer( const I8 *buffer_, U32 bufferSize_ );
     void    ResetBuffer( void );
             // stop pointing to the buffer
     void    ReleaseBuffer( void );
@@ -41,17 +99,48 @@ public:
     bool    GetNextToken( I8 *buffer_, I8 *delimiters, U32 delimiterCount );
     bool    ClearAndRead( I8 *buffer_, U32 bufferSize, I8 *delimiters, U32 delimiterCount );
 
+            // zero-copy, @token points into the buffer. Skips delimiters and whitespace and gives an
+            // empty token at each line end, @token is empty when it returns false. Call ResetBuffer
+            // before switching between this and the copying version.
+    bool    GetNextToken( TokenView &token, const DelimiterSet &delimiters );
+
 private:
             // checks wether *c is an accepted ascii character
-    bool    IsValid( I8 *c ) const;
-    bool    IsDelimiter( I8 *c, I8 *delimiters, U32 delimiterCount );
+    bool    IsValid( const I8 *c ) const;
+    bool    IsDelimiter( const I8 *c, I8 *delimiters, U32 delimiterCount );
 
             // can be from a file or any other source
-    I8    * buffer;
+    const I8 * buffer;
     U32     bufferSize;
     U32     currentTokenStartIndex;
     U32     currentTokenEndIndex;
 };
 
 
+/*
+================
+TokenView::IsEndOfLine
+================
+*/
+inline bool TokenView::IsEndOfLine( void ) const {
+    return length == 0;
+}
+
+/*
+================
+TokenView::Equals
+================
+*/
+inline bool TokenView::Equals( const I8 *str ) const {
+    // a token never holds a null, so a shorter @str mismatches before we read past its end
+    for( U32 i=0; i<length; ++i ) {
+        if( str[i] != start[i] ) {
+            return false;
+        }
+    }
+
+    return str[length] == '\0';
+}
+
+
 #endif // RT_TOKENIZER_H
@@ -0,0 +1,195 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtTypeTraits.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Minimal compile-time type traits for the containers, built on compiler intrinsics
+                     so they work without a c++11 standard library.
+
+                     IsTriviallyRelocatable<T> - T can be moved to a new address with memcpy/memmove and the
+                     old copy simply forgotten (no constructor or destructor needs to run). True for anything
+                     trivially copyable, types that own memory but don't point into themselves can opt in:
+
+                     RT_DECLARE_TRIVIALLY_RELOCATABLE( MyType );
+
+                     Move( x ) - x as an rvalue where the compiler supports them, so containers move rather
+                     than copy, otherwise just x.
+
+                     Relocator<T> - move/destroy runs of elements, picks memcpy/memmove or element by element
+                     moves at compile time.
+
+                     AlignOf<T> - alignment T needs, as a compile-time constant.
+
+===============================================================================
+*/
+
+
+#ifndef RT_TYPE_TRAITS_H
+#define RT_TYPE_TRAITS_H
+
+
+#include "../PlatformIndependenceLayer/RtPlatform.h"
+#include <string.h> // memcpy, memmove
+#include <new>      // placement new
+
+
+// trivially copyable (and so trivially destructible)
+#if RT_COMPILER == RT_COMPILER_MSVC
+    #if _MSC_VER >= 1900
+        #define RT_IS_TRIVIALLY_COPYABLE( T ) __is_trivially_copyable( T )
+    #else
+        #define RT_IS_TRIVIALLY_COPYABLE( T ) ( __has_trivial_copy( T ) && __has_trivial_destructor( T ) )
+    #endif // _MSC_VER
+#elif RT_COMPILER == RT_COMPILER_GCC
+    #if __GNUC__ >= 5
+        #define RT_IS_TRIVIALLY_COPYABLE( T ) __is_trivially_copyable( T )
+    #else
+        #define RT_IS_TRIVIALLY_COPYABLE( T ) ( __has_trivial_copy( T ) && __has_trivial_destructor( T ) )
+    #endif // __GNUC__
+#endif // RT_COMPILER
+
+// rvalue references - vs 2010 onward, gcc in c++11 mode
+#if ( RT_COMPILER == RT_COMPILER_MSVC && _MSC_VER >= 1600 ) || ( __cplusplus >= 201103L ) || defined( __GXX_EXPERIMENTAL_CXX0X__ )
+    #define RT_HAS_RVALUE_REFERENCES 1
+#else
+    #define RT_HAS_RVALUE_REFERENCES 0
+#endif // RT_HAS_RVALUE_REFERENCES
+
+
+/*
+===============================================================================
+
+IsTriviallyRelocatable
+
+===============================================================================
+*/
+template<class T>
+struct IsTriviallyRelocatable {
+    enum { value = RT_IS_TRIVIALLY_COPYABLE( T ) };
+};
+
+// void has no size to copy, but allocators are often instantiated on it
+template<>
+struct IsTriviallyRelocatable<void> {
+    enum { value = 1 };
+};
+
+// opt a type in, use at global scope
+#define RT_DECLARE_TRIVIALLY_RELOCATABLE( T ) \
+    template<> struct IsTriviallyRelocatable< T > { enum { value = 1 }; }
+
+
+/*
+===============================================================================
+
+AlignOf
+
+A char followed by a T is padded out so the T lands on its alignment, the padding is the alignment.
+
+===============================================================================
+*/
+template<class T>
+struct AlignOf {
+private:
+    struct Padded {
+        char    c;
+        T       t;
+    };
+
+public:
+    enum { value = sizeof( Padded ) - sizeof( T ) };
+};
+
+
+/*
+================
+Move
+================
+*/
+#if RT_HAS_RVALUE_REFERENCES
+template<class T>
+inline T&& Move( T &value ) {
+    return static_cast<T&&>( value );
+}
+#else
+template<class T>
+inline T& Move( T &value ) {
+    return value;
+}
+#endif // RT_HAS_RVALUE_REFERENCES
+
+
+/*
+===============================================================================
+
+Relocator
+
+Destinations are uninitialised memory, sources are left uninitialised.
+
+===============================================================================
+*/
+template<class T, bool TRIVIAL = ( IsTriviallyRelocatable<T>::value != 0 )>
+struct Relocator {
+                        // ranges may overlap
+    static void         Relocate( T *dest, T *source, U32 count );
+                        // ranges must not overlap
+    static void         RelocateDisjoint( T *dest, T *source, U32 count );
+    static void         Destroy( T *elements, U32 count );
+};
+
+template<class T>
+struct Relocator<T, true> {
+    static void         Relocate( T *dest, T *source, U32 count ) { memmove( dest, source, count * sizeof( T ) ); }
+    static void         RelocateDisjoint( T *dest, T *source, U32 count ) { memcpy( dest, source, count * sizeof( T ) ); }
+    static void         Destroy( T * /*elements*/, U32 /*count*/ ) { }
+};
+
+/*
+================
+Relocator<T, TRIVIAL>::Relocate
+================
+*/
+template<class T, bool TRIVIAL>
+void Relocator<T, TRIVIAL>::Relocate( T *dest, T *source, U32 count ) {
+    // work away from the overlap
+    if( dest < source ) {
+        RelocateDisjoint( dest, source, count );
+    }
+    else if( dest > source ) {
+        for( U32 i=count; i>0; --i ) {
+            new( reinterpret_cast<void*>( &dest[i-1] ) ) T( Move( source[i-1] ) );
+            source[i-1].~T( );
+        }
+    }
+}
+
+/*
+================
+Relocator<T, TRIVIAL>::RelocateDisjoint
+================
+*/
+template<class T, bool TRIVIAL>
+void Relocator<T, TRIVIAL>::RelocateDisjoint( T *dest, T *source, U32 count ) {
+    for( U32 i=0; i<count; ++i ) {
+        new( reinterpret_cast<void*>( &dest[i] ) ) T( Move( source[i] ) );
+        source[i].~T( );
+    }
+}
+
+/*
+================
+Relocator<T, TRIVIAL>::Destroy
+================
+*/
+template<class T, bool TRIVIAL>
+void Relocator<T, TRIVIAL>::Destroy( T *elements, U32 count ) {
+    for( U32 i=0; i<count; ++i ) {
+        elements[i].~T( );
+    }
+}
+
+
+#endif // RT_TYPE_TRAITS_H
@@ -3,12 +3,21 @@
     -----------
     File        :    RtVector.h
     Author      :    Jamie Taylor
-    Last Edit   :    11/08/12
+    Last Edit   :    17/10/26
     Desc        :    Vector container implementation. These containers are not made to try and 'top' the STL, these are made
                      for learning purposes/experience. These responsibilities may well by delegated to the STL for ReflecTech 2
                      but for now I'll try making them myself for the experience.
 
                      Uses the engines heap allocator.
+
+                     17/10/26 - Elements are relocated in bulk with memcpy/memmove when T is trivially relocatable
+                                (see RtTypeTraits.h) and moved rather than copied otherwise, Resize/Insert/Remove no
+                                longer copy construct and destruct every element. Added EmplaceBack to construct
+                                elements in place from constructor arguments.
+
+                     17/10/26 - Added Sort, LowerBound and BinarySearch (see RtAlgorithm.h), LinearSearch uses SSE2 for
+                                32/64 bit integer elements. ReverseLinearSearch no longer loops forever when the element
+                                isn't found.
 */
 #ifndef RT_VECTOR_H
 #define RT_VECTOR_H
@@ -17,6 +26,10 @@
 // DEFAULT_VECTOR_CAPACITY can be found/altered in RtConfiguration.h which is included in RtCommonHeaders.h, this is in an 
 // effort to keep engine configuation all in one place and thus provide on single point of access/control over the engine settings/tuning.
 #include "RtCommonHeaders.h"
+#include "RtAssert.h"
+#include "RtMemoryCommon.h"
+#include "RtTypeTraits.h"
+#include "RtAlgorithm.h"
 
 
 /**************************************************************************************************************************/
@@ -43,6 +56,16 @@ public:
 
     // insert and remove elements
     void PushBack(const T &value);
+    // construct the new last element in place from up to four constructor arguments, returns it
+    T& EmplaceBack();
+    template<class A1>
+    T& EmplaceBack(const A1 &a1);
+    template<class A1, class A2>
+    T& EmplaceBack(const A1 &a1, const A2 &a2);
+    template<class A1, class A2, class A3>
+    T& EmplaceBack(const A1 &a1, const A2 &a2, const A3 &a3);
+    template<class A1, class A2, class A3, class A4>
+    T& EmplaceBack(const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4);
     void PushFront(const T &value);
     void Insert(U32 index, const T &value);
     void Remove(U32 index, U32 count = 1); // starting at specified index - remove count elements (default to 1 as we'll be removing at least 1 element)
@@ -57,7 +80,19 @@ public:
     // check for an element via forward or reverse linear search - will return the index of the element if able, -1 otherwise
     U32 LinearSearch(const T &lookingFor) const;
     U32 ReverseLinearSearch(const T &lookingFor) const;
-    // HEAP SORT & BINARY SEARCH?
+
+    // sort the elements, operator< or compare(a, b) returning true if a must come before b - not stable
+    void Sort();
+    template<class Compare>
+    void Sort(Compare compare);
+    // for sorted vectors (using the same comparator) - index of the first element not less than value, Occupied() if none
+    U32 LowerBound(const T &value) const;
+    template<class Compare>
+    U32 LowerBound(const T &value, Compare compare) const;
+    // for sorted vectors - index of the element if able, -1 otherwise
+    U32 BinarySearch(const T &lookingFor) const;
+    template<class Compare>
+    U32 BinarySearch(const T &lookingFor, Compare compare) const;
 
     // check on the vector properties/configuration
     U32 Capacity() const;
@@ -71,6 +106,9 @@ public:
     void Clear();
 
 private:
+    // make room for at least one more element
+    void Grow();
+
     T *data;
     U32 capacity;
     U32 occupied;
@@ -93,9 +131,10 @@ Vector<T, Allocator>::Vector(U32 size, bool _isAligned, size_t _alignment)
     occupied = 0;
     capacity = size;
     isAligned = _isAligned;
-    alignment = _alignment;
+    // the engine allocators treat an alignment of 1 as 'unaligned', 0 isn't valid
+    alignment = (_isAligned && _alignment > 0) ? _alignment : 1;
 
-    data = allctr.Allocate(size * sizeof(T), alignment);
+    data = RT_ALLOC(allctr, size * sizeof(T), alignment);
 }
 /**************************************************************************************************************************/
 
@@ -134,9 +173,10 @@ void Vector<T, Allocator>::operator=(const Vector<T, Allocator> &rhs)
     if(rhs.data)
     {
         // yes - copy it over
-        data = allctr.Allocate(capacity * sizeof(T), alignment);
+        data = RT_ALLOC(allctr, capacity * sizeof(T), alignment);
         
-        for(U32 i=0; i<capacity; ++i)
+        // only the occupied elements have been constructed
+        for(U32 i=0; i<occupied; ++i)
             allctr.Construct(&data[i], rhs.data[i]);
     }
     else
@@ -188,7 +228,74 @@ void Vector<T, Allocator>::InitToDefault(const T &defaultValue)
 template<class T, class Allocator>
 void Vector<T, Allocator>:: PushBack(const T &value)
 {
-    Insert(occupied, value);
+    if(occupied == capacity)
+    {
+        // value may live in the vector, copy it before the storage moves
+        T temp(value);
+        Grow();
+        new(reinterpret_cast<void*>(&data[occupied])) T(Move(temp));
+    }
+    else
+    {
+        allctr.Construct(&data[occupied], value);
+    }
+
+    ++occupied;
+}
+/**************************************************************************************************************************/
+
+// the arguments must not refer to elements of the vector, they may move when it grows
+template<class T, class Allocator>
+T& Vector<T, Allocator>::EmplaceBack()
+{
+    if(occupied == capacity)
+        Grow();
+
+    return *(new(reinterpret_cast<void*>(&data[occupied++])) T());
+}
+/**************************************************************************************************************************/
+
+template<class T, class Allocator>
+template<class A1>
+T& Vector<T, Allocator>::EmplaceBack(const A1 &a1)
+{
+    if(occupied == capacity)
+        Grow();
+
+    return *(new(reinterpret_cast<void*>(&data[occupied++])) T(a1));
+}
+/**************************************************************************************************************************/
+
+template<class T, class Allocator>
+template<class A1, class A2>
+T& Vector<T, Allocator>::EmplaceBack(const A1 &a1, const A2 &a2)
+{
+    if(occupied == capacity)
+        Grow();
+
+    return *(new(reinterpret_cast<void*>(&data[occupied++])) T(a1, a2));
+}
+/**************************************************************************************************************************/
+
+template<class T, class Allocator>
+template<class A1, class A2, class A3>
+T& Vector<T, Allocator>::EmplaceBack(const A1 &a1, const A2 &a2, const A3 &a3)
+{
+    if(occupied == capacity)
+        Grow();
+
+    return *(new(reinterpret_cast<void*>(&data[occupied++])) T(a1, a2, a3));
+}
+/**************************************************************************************************************************/
+
+template<class T, class Allocator>
+template<class A1, class A2, class A3, class A4>
+T& Vector<T, Allocator>::EmplaceBack(const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4)
+{
+    if(occupied == capacity)
+        Grow();
+
+    return *(new(reinterpret_cast<void*>(&data[occupied++])) T(a1, a2, a3, a4));
 }
 /**************************************************************************************************************************/
 
@@ -208,30 +315,17 @@ void Vector<T, Allocator>::Insert(U32 index, const T &value)
 
     // first - do we need to allocate more memory?
     if(occupied + 1 > capacity)
-    {
-        // grow the vector 1.5 times - U32eger division
-        Resize(capacity + (capacity >> 1));
-    }
+        Grow();
 
     // is the element being placed at the end?
     if(index >= occupied)
-    {
-        // then simply place it at the end and stop
-        allctr.Construct(&data[occupied], temp);
-    }
+        index = occupied;
     else
-    {
         // move the elements up to free the desired index
-        allctr.Construct(&data[occupied], data[occupied-1]);
-        for(U32 i=occupied-1; i>index; --i)
-        {
-            allctr.Destruct(&data[i]);
-            allctr.Construct(&data[i], data[i-1]);
-        }
-
-        // insert the desired element at the desired index
-        allctr.Construct(&data[index], temp);
-    }
+        Relocator<T>::Relocate(&data[index+1], &data[index], occupied-index);
+
+    // insert the desired element at the desired index
+    new(reinterpret_cast<void*>(&data[index])) T(Move(temp));
 
     ++occupied;
 }
@@ -242,26 +336,19 @@ void Vector<T, Allocator>::Insert(U32 index, const T &value)
 template<class T, class Allocator>
 void Vector<T, Allocator>::Remove(U32 index, U32 count)
 {
-    RT_ASSERT(count > occupied || occupied < 1);
+    RT_ASSERT(index < occupied);
 
-    if(count == occupied && index > 0)
-        --count; // added 04/08/12, eg: index = 1; 1 + (count==occupied) > capacity = bounds error so quickly check for it
+    // don't run off the end, eg: index = 1 and count == occupied
+    if(index + count > occupied)
+        count = occupied - index;
 
     // remove specified number of elements
     U32 upto = index+count;
-    for(U32 i=index; i<upto; ++i)
-    {
-        allctr.Destruct(&data[i]);
-        --occupied;
-    }
+    Relocator<T>::Destroy(&data[index], count);
 
     // move remaining elements down to fill the gap
-    upto =  index+(occupied-index);
-    for(U32 i=index; i<upto; ++i)
-    {    
-        allctr.Construct(&data[i], data[i+count]);
-        allctr.Destruct(&data[i+count]);
-    }
+    Relocator<T>::Relocate(&data[index], &data[upto], occupied-upto);
+    occupied -= count;
 }
 /**************************************************************************************************************************/
 
@@ -303,27 +390,59 @@ T& Vector<T, Allocator>::GetLast()
 template<class T, class Allocator>
 U32 Vector<T, Allocator>::LinearSearch(const T &lookingFor) const
 {
-    for(U32 i=0; i<occupied; ++i)
-    {
-        if(data[i] == lookingFor)
-            return i;
-    }
-
-    return -1;
+    return ::LinearSearch(data, occupied, lookingFor);
 }
 /**************************************************************************************************************************/
 
 template<class T, class Allocator>
 U32 Vector<T, Allocator>::ReverseLinearSearch(const T &lookingFor) const
 {
-    // i = (occupied-1) to counter ++occupied at end of insert
-    for(U32 i=(occupied-1); i>=0; --i)
-    {
-        if(data[i] == lookingFor)
-            return i;
-    }
+    return ::ReverseLinearSearch(data, occupied, lookingFor);
+}
+/**************************************************************************************************************************/
+
+template<class T, class Allocator>
+void Vector<T, Allocator>::Sort()
+{
+    ::Sort(data, occupied, Less<T>());
+}
+/**************************************************************************************************************************/
+
+template<class T, class Allocator>
+template<class Compare>
+void Vector<T, Allocator>::Sort(Compare compare)
+{
+    ::Sort(data, occupied, compare);
+}
+/**************************************************************************************************************************/
+
+template<class T, class Allocator>
+U32 Vector<T, Allocator>::LowerBound(const T &value) const
+{
+    return ::LowerBound(data, occupied, value, Less<T>());
+}
+/**************************************************************************************************************************/
+
+template<class T, class Allocator>
+template<class Compare>
+U32 Vector<T, Allocator>::LowerBound(const T &value, Compare compare) const
+{
+    return ::LowerBound(data, occupied, value, compare);
+}
+/**************************************************************************************************************************/
 
-    return -1;
+template<class T, class Allocator>
+U32 Vector<T, Allocator>::BinarySearch(const T &lookingFor) const
+{
+    return ::BinarySearch(data, occupied, lookingFor, Less<T>());
+}
+/**************************************************************************************************************************/
+
+template<class T, class Allocator>
+template<class Compare>
+U32 Vector<T, Allocator>::BinarySearch(const T &lookingFor, Compare compare) const
+{
+    return ::BinarySearch(data, occupied, lookingFor, compare);
 }
 /**************************************************************************************************************************/
 
@@ -366,22 +485,19 @@ size_t Vector<T, Allocator>::Alignment() const
 template<class T, class Allocator>
 void Vector<T, Allocator>::Resize(U32 newSize)
 {
-    // increase size 1.5 times, x >> 1 == x / 2, we simply bit-shift for speed 
     T *temp = data;
-    data = allctr.Allocate(newSize * sizeof(T), alignment);
+    data = RT_ALLOC(allctr, newSize * sizeof(T), alignment);
 
     U32 upto = (occupied < newSize)? occupied : newSize;
 
-    // copy over the elements
-    for(U32 i=0; i<upto; ++i)
-        allctr.Construct(&data[i], temp[i]);
+    // move over the elements
+    Relocator<T>::RelocateDisjoint(data, temp, upto);
 
-    // destroy all elements in the old vector
-    for(U32 i=0; i<occupied; ++i)
-        allctr.Destruct(&temp[i]);    
+    // destroy any elements that didn't fit
+    Relocator<T>::Destroy(&temp[upto], occupied - upto);
                             
     // free the old memory occupied by the vector
-    allctr.DeAllocate(temp, isAligned);
+    allctr.DeAllocate(temp);
     temp = 0;
 
     // alter vector properties
@@ -397,15 +513,28 @@ template<class T, class Allocator>
 void Vector<T, Allocator>::Clear()
 {
     // remove the values
-    for(U32 i=0; i<occupied; ++i)
-        allctr.Destruct(&data[i]);
+    Relocator<T>::Destroy(data, occupied);
 
     // and free the memory
-    allctr.DeAllocate(data, isAligned);
+    allctr.DeAllocate(data);
 
     occupied = 0;
 }
 /**************************************************************************************************************************/
 
+// grow the vector 1.5 times, x >> 1 == x / 2, we simply bit-shift for speed
+template<class T, class Allocator>
+void Vector<T, Allocator>::Grow()
+{
+    U32 newCapacity = capacity + (capacity >> 1);
+
+    // 1.5 * 0 or 1 doesn't get us anywhere
+    if(newCapacity < occupied + 1)
+        newCapacity = occupied + 1;
+
+    Resize(newCapacity);
+}
+/**************************************************************************************************************************/
+
 
 #endif // RT_VECTOR_H
@@ -0,0 +1,177 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtWorkStealingDeque.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Bounded Chase-Lev work-stealing deque. One thread owns the deque and pushes/pops at the
+                     bottom (LIFO, so it keeps working on whatever is hot in its cache), any other thread can
+                     steal from the top (FIFO, the oldest and usually biggest pieces of work). The owner only
+                     has to synchronise with thieves when the deque is down to its last element.
+
+                     T is copied in and out with plain loads/stores, so it should be small and trivially
+                     copyable - a thief can read a slot the owner is overwriting, but then its compare-
+                     exchange on the top fails and the torn copy is thrown away. Relies on x86 ordering
+                     (see RtAtomic.h), the only fence needed is the owner's store->load fence in Pop.
+
+===============================================================================
+*/
+
+
+#ifndef RT_WORK_STEALING_DEQUE_H
+#define RT_WORK_STEALING_DEQUE_H
+
+
+#include "RtCommonHeaders.h"
+#include "RtAssert.h"
+#include "RtUncopyable_V.h"
+#include "RtHeapAllocator.h"
+#include "RtConcurrentQueue.h" // QueueCapacity
+#include "../PlatformIndependenceLayer/RtAtomic.h"
+
+
+/*
+===============================================================================
+
+Work Stealing Deque class
+
+===============================================================================
+*/
+template<class T, class Allocator = HeapAllocator<U8> >
+class WorkStealingDeque : public Uncopyable {
+public:
+                        // @capacity is rounded up to a power of two
+                        WorkStealingDeque( U32 capacity );
+                        ~WorkStealingDeque( void );
+
+                        // owner only - false if full
+    bool                Push( const T &value );
+                        // owner only - false if empty or a thief took the last element
+    bool                Pop( T &out );
+                        // any thread - false if empty or another thread won the race for the top element
+    bool                Steal( T &out );
+
+    U32                 Capacity( void ) const { return mask + 1; }
+                        // approximate unless called by the owner with no thieves about
+    U32                 Count( void ) const;
+    bool                IsEmpty( void ) const { return ( Count( ) == 0 ); }
+
+private:
+                        // free running indices, the elements are [top, bottom)
+    RT_ALIGN( RT_CACHE_LINE_SIZE ) volatile U32 top;
+    RT_ALIGN( RT_CACHE_LINE_SIZE ) volatile U32 bottom;
+
+    RT_ALIGN( RT_CACHE_LINE_SIZE ) T * slots;
+    U32                 mask;
+    Allocator           allctr;
+};
+
+/*
+================
+WorkStealingDeque<T, Allocator>::WorkStealingDeque
+================
+*/
+template<class T, class Allocator>
+WorkStealingDeque<T, Allocator>::WorkStealingDeque( U32 capacity ) {
+    U32 rounded = QueueCapacity( capacity );
+
+    slots = reinterpret_cast<T*>( RT_ALLOC( allctr, rounded * sizeof( T ), RT_CACHE_LINE_SIZE ) );
+    mask = rounded - 1;
+    top = bottom = 0;
+}
+
+/*
+================
+WorkStealingDeque<T, Allocator>::~WorkStealingDeque
+================
+*/
+template<class T, class Allocator>
+WorkStealingDeque<T, Allocator>::~WorkStealingDeque( void ) {
+    allctr.DeAllocate( reinterpret_cast<U8*>( slots ) );
+}
+
+/*
+================
+WorkStealingDeque<T, Allocator>::Push
+================
+*/
+template<class T, class Allocator>
+bool WorkStealingDeque<T, Allocator>::Push( const T &value ) {
+    U32 b = bottom;
+    U32 t = AtomicLoad32( &top );
+    if( ( b - t ) > mask ) {
+        return false;
+    }
+
+    slots[b & mask] = value;
+    // publishes the element to thieves
+    AtomicStore32( &bottom, b + 1 );
+    return true;
+}
+
+/*
+================
+WorkStealingDeque<T, Allocator>::Pop
+
+Claims the bottom element by moving bottom down before looking at top, a thief that read the old
+bottom can only be after the same element if there's one left, and that's settled on top.
+================
+*/
+template<class T, class Allocator>
+bool WorkStealingDeque<T, Allocator>::Pop( T &out ) {
+    U32 b = bottom - 1;
+    bottom = b;
+    // the store to bottom has to be visible before top is read
+    MemoryFence( );
+    U32 t = top;
+
+    I32 size = static_cast<I32>( b - t );
+    if( size < 0 ) {
+        // was already empty
+        AtomicStore32( &bottom, t );
+        return false;
+    }
+
+    out = slots[b & mask];
+    if( size > 0 ) {
+        return true;
+    }
+
+    // the last element, race any thieves for it
+    bool won = ( AtomicCompareExchange32( &top, t + 1, t ) == t );
+    AtomicStore32( &bottom, t + 1 );
+    return won;
+}
+
+/*
+================
+WorkStealingDeque<T, Allocator>::Steal
+================
+*/
+template<class T, class Allocator>
+bool WorkStealingDeque<T, Allocator>::Steal( T &out ) {
+    U32 t = AtomicLoad32( &top );
+    U32 b = AtomicLoad32( &bottom );
+    if( static_cast<I32>( b - t ) <= 0 ) {
+        return false;
+    }
+
+    out = slots[t & mask];
+    return ( AtomicCompareExchange32( &top, t + 1, t ) == t );
+}
+
+/*
+================
+WorkStealingDeque<T, Allocator>::Count
+================
+*/
+template<class T, class Allocator>
+U32 WorkStealingDeque<T, Allocator>::Count( void ) const {
+    I32 size = static_cast<I32>( AtomicLoad32( &bottom ) - AtomicLoad32( &top ) );
+    return ( size > 0 ) ? static_cast<U32>( size ) : 0;
+}
+
+
+#endif // RT_WORK_STEALING_DEQUE_H
@@ -0,0 +1,114 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtMappedFileLin.cpp
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Read only file mapping, Linux implementation.
+
+===============================================================================
+*/
+
+
+#include "../RtMappedFile.h"
+#include "../RtVirtualMemory.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/*
+================
+MappedFile::MappedFile
+================
+*/
+MappedFile::MappedFile( void ) {
+    data = NULL;
+    size = 0;
+    isOpen = false;
+}
+
+/*
+================
+MappedFile::~MappedFile
+================
+*/
+MappedFile::~MappedFile( void ) {
+    Close( );
+}
+
+/*
+================
+MappedFile::Open
+
+The mapping keeps its own reference to the file, the descriptor can be closed straight away.
+================
+*/
+bool MappedFile::Open( const I8 *fileName ) {
+    Close( );
+
+    int fileDescriptor = open( fileName, O_RDONLY );
+    if( fileDescriptor == -1 ) {
+        return false;
+    }
+
+    struct stat fileStatus;
+    if( fstat( fileDescriptor, &fileStatus ) != 0 ) {
+        close( fileDescriptor );
+        return false;
+    }
+
+    size = static_cast<U64>( fileStatus.st_size );
+    if( size > 0 ) {
+        void *memory = mmap( NULL, static_cast<size_t>( size ), PROT_READ, MAP_PRIVATE, fileDescriptor, 0 );
+        if( memory == MAP_FAILED ) {
+            close( fileDescriptor );
+            size = 0;
+            return false;
+        }
+
+        // more aggressive read ahead, and pages behind the reader can be dropped first
+        madvise( memory, static_cast<size_t>( size ), MADV_SEQUENTIAL );
+        data = reinterpret_cast<const U8*>( memory );
+    }
+
+    close( fileDescriptor );
+    isOpen = true;
+    return true;
+}
+
+/*
+================
+MappedFile::Close
+================
+*/
+void MappedFile::Close( void ) {
+    if( data != NULL ) {
+        munmap( const_cast<U8*>( data ), static_cast<size_t>( size ) );
+    }
+
+    data = NULL;
+    size = 0;
+    isOpen = false;
+}
+
+/*
+================
+MappedFile::Prefetch
+
+madvise wants a page aligned start.
+================
+*/
+void MappedFile::Prefetch( U64 offset, U64 length ) const {
+    if( ( data == NULL ) || ( offset >= size ) ) {
+        return;
+    }
+
+    length = ( length < ( size - offset ) ) ? length : ( size - offset );
+    U64 pageOffset = offset & ~static_cast<U64>( GetPageSize( ) - 1 );
+
+    madvise( const_cast<U8*>( data + pageOffset ), static_cast<size_t>( length + ( offset - pageOffset ) ), MADV_WILLNEED );
+}
@@ -0,0 +1,160 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtThreadLin.cpp
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Minimal os thread layer, Linux implementation.
+
+===============================================================================
+*/
+
+
+#include "../RtThread.h"
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+
+
+// what the pthread trampoline needs to call the real entry point
+struct ThreadStart {
+    ThreadEntryPoint    entryPoint;
+    void              * param;
+};
+
+
+/*
+================
+ThreadTrampoline
+================
+*/
+static void * ThreadTrampoline( void *arg ) {
+    ThreadStart start = *reinterpret_cast<ThreadStart*>( arg );
+    delete reinterpret_cast<ThreadStart*>( arg );
+
+    start.entryPoint( start.param );
+    return NULL;
+}
+
+/*
+================
+StartThread
+================
+*/
+ThreadHandle StartThread( ThreadEntryPoint entryPoint, void *param ) {
+    ThreadStart *start = new ThreadStart;
+    start->entryPoint = entryPoint;
+    start->param = param;
+
+    pthread_t thread;
+    if( pthread_create( &thread, NULL, ThreadTrampoline, start ) != 0 ) {
+        delete start;
+        return NULL;
+    }
+
+    // pthread_t is an integer handle on Linux
+    return reinterpret_cast<ThreadHandle>( thread );
+}
+
+/*
+================
+JoinThread
+================
+*/
+void JoinThread( ThreadHandle thread ) {
+    pthread_join( reinterpret_cast<pthread_t>( thread ), NULL );
+}
+
+/*
+================
+SleepThread
+================
+*/
+void SleepThread( U32 milliseconds ) {
+    timespec duration;
+    duration.tv_sec = milliseconds / 1000;
+    duration.tv_nsec = ( milliseconds % 1000 ) * 1000000;
+    nanosleep( &duration, NULL );
+}
+
+/*
+================
+YieldThread
+================
+*/
+void YieldThread( void ) {
+    sched_yield( );
+}
+
+/*
+================
+GetMonotonicMicroseconds
+================
+*/
+U64 GetMonotonicMicroseconds( void ) {
+    timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( static_cast<U64>( now.tv_sec ) * 1000000 ) + ( static_cast<U64>( now.tv_nsec ) / 1000 );
+}
+
+/*
+================
+GetHardwareThreadCount
+================
+*/
+U32 GetHardwareThreadCount( void ) {
+    long count = sysconf( _SC_NPROCESSORS_ONLN );
+    return ( count > 0 ) ? static_cast<U32>( count ) : 1;
+}
+
+/*
+================
+NewSemaphore
+================
+*/
+SemaphoreHandle NewSemaphore( U32 initialCount ) {
+    sem_t *semaphore = new sem_t;
+    if( sem_init( semaphore, 0, initialCount ) != 0 ) {
+        delete semaphore;
+        return NULL;
+    }
+
+    return reinterpret_cast<SemaphoreHandle>( semaphore );
+}
+
+/*
+================
+DeleteSemaphore
+================
+*/
+void DeleteSemaphore( SemaphoreHandle semaphore ) {
+    sem_destroy( reinterpret_cast<sem_t*>( semaphore ) );
+    delete reinterpret_cast<sem_t*>( semaphore );
+}
+
+/*
+================
+SignalSemaphore
+================
+*/
+void SignalSemaphore( SemaphoreHandle semaphore, U32 count ) {
+    for( U32 i=0; i<count; ++i ) {
+        sem_post( reinterpret_cast<sem_t*>( semaphore ) );
+    }
+}
+
+/*
+================
+WaitSemaphore
+================
+*/
+void WaitSemaphore( SemaphoreHandle semaphore ) {
+    // retry if a signal handler interrupts the wait
+    while( sem_wait( reinterpret_cast<sem_t*>( semaphore ) ) != 0 && errno == EINTR ) {
+    }
+}
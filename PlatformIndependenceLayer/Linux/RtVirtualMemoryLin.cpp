@@ -0,0 +1,114 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtVirtualMemoryLin.cpp
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Page granular memory straight from the os, Linux implementation.
+
+===============================================================================
+*/
+
+
+#include "../RtVirtualMemory.h"
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+/*
+================
+RoundToPageSize
+================
+*/
+static size_t RoundToPageSize( size_t sizeInBytes ) {
+    size_t pageSize = GetPageSize( );
+    return ( sizeInBytes + ( pageSize - 1 ) ) & ~( pageSize - 1 );
+}
+
+/*
+================
+GetPageSize
+================
+*/
+size_t GetPageSize( void ) {
+    static size_t pageSize = 0;
+    if( pageSize == 0 ) {
+        pageSize = static_cast<size_t>( sysconf( _SC_PAGESIZE ) );
+    }
+    return pageSize;
+}
+
+/*
+================
+AllocatePages
+================
+*/
+void * AllocatePages( size_t sizeInBytes, bool largePageHint ) {
+    void *memory = mmap( NULL, RoundToPageSize( sizeInBytes ), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if( memory == MAP_FAILED ) {
+        return NULL;
+    }
+
+#ifdef MADV_HUGEPAGE
+    // transparent huge pages, ignored if they're disabled
+    if( largePageHint == true ) {
+        madvise( memory, RoundToPageSize( sizeInBytes ), MADV_HUGEPAGE );
+    }
+#endif // MADV_HUGEPAGE
+
+    return memory;
+}
+
+/*
+================
+FreePages
+================
+*/
+void FreePages( void *memory, size_t sizeInBytes ) {
+    munmap( memory, RoundToPageSize( sizeInBytes ) );
+}
+
+/*
+================
+ReservePages
+
+MAP_NORESERVE so large reservations don't count against overcommit limits until used.
+================
+*/
+void * ReservePages( size_t sizeInBytes ) {
+    void *memory = mmap( NULL, RoundToPageSize( sizeInBytes ), PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+    return ( memory != MAP_FAILED ) ? memory : NULL;
+}
+
+/*
+================
+CommitPages
+================
+*/
+bool CommitPages( void *memory, size_t sizeInBytes ) {
+    return ( mprotect( memory, RoundToPageSize( sizeInBytes ), PROT_READ | PROT_WRITE ) == 0 );
+}
+
+/*
+================
+DecommitPages
+
+MADV_DONTNEED drops the pages from the resident set straight away, they'd be zero-filled if touched again.
+================
+*/
+void DecommitPages( void *memory, size_t sizeInBytes ) {
+    size_t size = RoundToPageSize( sizeInBytes );
+    madvise( memory, size, MADV_DONTNEED );
+    mprotect( memory, size, PROT_NONE );
+}
+
+/*
+================
+ReleasePages
+================
+*/
+void ReleasePages( void *memory, size_t sizeInBytes ) {
+    munmap( memory, RoundToPageSize( sizeInBytes ) );
+}
@@ -0,0 +1,242 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtAtomic.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Basic atomic operations and threading related macros which work across all supported
+                     platforms/compilers. MSVC uses the _Interlocked* intrinsics and GCC uses the __sync builtins.
+
+                     All of the read-modify-write operations below act as full memory barriers, on x86/x86_64
+                     (the only architectures supported at the moment) a plain aligned load has acquire semantics
+                     and a plain aligned store has release semantics, so the load/store helpers only need to stop
+                     the compiler re-ordering around them.
+
+                     The Atomic*Add functions return the value held *before* the addition.
+
+===============================================================================
+*/
+
+
+#ifndef RT_ATOMIC_H
+#define RT_ATOMIC_H
+
+
+#include "RtPlatform.h"
+
+
+#if RT_COMPILER == RT_COMPILER_MSVC
+    #include <intrin.h>
+    #pragma intrinsic( _ReadWriteBarrier )
+#endif // RT_COMPILER == RT_COMPILER_MSVC
+
+// _mm_pause
+#include <emmintrin.h>
+
+
+/*
+===============================================================================
+
+Threading related macros
+
+===============================================================================
+*/
+// size of a cache line in bytes, data written by different threads should be kept this far apart to avoid false sharing
+#define RT_CACHE_LINE_SIZE 64
+
+#if RT_COMPILER == RT_COMPILER_MSVC
+    #define RT_THREAD_LOCAL     __declspec( thread )
+    #define RT_ALIGN( bytes )   __declspec( align( bytes ) )
+    // stop the compiler moving reads/writes across this point, doesn't emit a fence
+    #define RT_COMPILER_BARRIER( ) _ReadWriteBarrier( )
+#elif RT_COMPILER == RT_COMPILER_GCC
+    #define RT_THREAD_LOCAL     __thread
+    #define RT_ALIGN( bytes )   __attribute__( ( aligned( bytes ) ) )
+    #define RT_COMPILER_BARRIER( ) __asm__ __volatile__( "" ::: "memory" )
+#endif // RT_COMPILER
+
+
+/*
+================
+AtomicCompareExchange32
+
+If *destination == comparand then *destination = exchange. Returns the original value of *destination.
+================
+*/
+inline U32 AtomicCompareExchange32( volatile U32 *destination, U32 exchange, U32 comparand ) {
+#if RT_COMPILER == RT_COMPILER_MSVC
+    return static_cast<U32>( _InterlockedCompareExchange( reinterpret_cast<volatile long*>( destination ),
+                                                          static_cast<long>( exchange ), static_cast<long>( comparand ) ) );
+#elif RT_COMPILER == RT_COMPILER_GCC
+    return __sync_val_compare_and_swap( destination, comparand, exchange );
+#endif // RT_COMPILER
+}
+
+/*
+================
+AtomicCompareExchange64
+
+If *destination == comparand then *destination = exchange. Returns the original value of *destination.
+On 32 bit x86 this relies on cmpxchg8b (i586 onward).
+================
+*/
+inline U64 AtomicCompareExchange64( volatile U64 *destination, U64 exchange, U64 comparand ) {
+#if RT_COMPILER == RT_COMPILER_MSVC
+    return static_cast<U64>( _InterlockedCompareExchange64( reinterpret_cast<volatile __int64*>( destination ),
+                                                            static_cast<__int64>( exchange ), static_cast<__int64>( comparand ) ) );
+#elif RT_COMPILER == RT_COMPILER_GCC
+    return __sync_val_compare_and_swap( destination, comparand, exchange );
+#endif // RT_COMPILER
+}
+
+/*
+================
+AtomicCompareExchangePointer
+
+If *destination == comparand then *destination = exchange. Returns the original value of *destination.
+================
+*/
+inline void* AtomicCompareExchangePointer( void * volatile *destination, void *exchange, void *comparand ) {
+#if RT_COMPILER == RT_COMPILER_MSVC
+    return _InterlockedCompareExchangePointer( destination, exchange, comparand );
+#elif RT_COMPILER == RT_COMPILER_GCC
+    return __sync_val_compare_and_swap( destination, comparand, exchange );
+#endif // RT_COMPILER
+}
+
+/*
+================
+AtomicAdd32
+================
+*/
+inline U32 AtomicAdd32( volatile U32 *destination, U32 value ) {
+#if RT_COMPILER == RT_COMPILER_MSVC
+    return static_cast<U32>( _InterlockedExchangeAdd( reinterpret_cast<volatile long*>( destination ), static_cast<long>( value ) ) );
+#elif RT_COMPILER == RT_COMPILER_GCC
+    return __sync_fetch_and_add( destination, value );
+#endif // RT_COMPILER
+}
+
+/*
+================
+AtomicAdd64
+
+On 32 bit builds this falls back to a compare-exchange loop.
+================
+*/
+inline U64 AtomicAdd64( volatile U64 *destination, U64 value ) {
+#if RT_COMPILER == RT_COMPILER_MSVC && RT_ARCHITECTURE == RT_ARCHITECTURE_64
+    return static_cast<U64>( _InterlockedExchangeAdd64( reinterpret_cast<volatile __int64*>( destination ), static_cast<__int64>( value ) ) );
+#elif RT_COMPILER == RT_COMPILER_MSVC
+    U64 original;
+    do {
+        original = *destination;
+    } while( AtomicCompareExchange64( destination, original + value, original ) != original );
+    return original;
+#elif RT_COMPILER == RT_COMPILER_GCC
+    return __sync_fetch_and_add( destination, value );
+#endif // RT_COMPILER
+}
+
+/*
+================
+AtomicExchange32
+
+Returns the original value of *destination.
+================
+*/
+inline U32 AtomicExchange32( volatile U32 *destination, U32 value ) {
+#if RT_COMPILER == RT_COMPILER_MSVC
+    return static_cast<U32>( _InterlockedExchange( reinterpret_cast<volatile long*>( destination ), static_cast<long>( value ) ) );
+#elif RT_COMPILER == RT_COMPILER_GCC
+    // __sync_lock_test_and_set is only an acquire barrier, xchg on x86 is a full barrier regardless
+    return __sync_lock_test_and_set( destination, value );
+#endif // RT_COMPILER
+}
+
+/*
+================
+AtomicLoad32
+================
+*/
+inline U32 AtomicLoad32( const volatile U32 *source ) {
+    U32 value = *source;
+    RT_COMPILER_BARRIER( );
+    return value;
+}
+
+/*
+================
+AtomicStore32
+================
+*/
+inline void AtomicStore32( volatile U32 *destination, U32 value ) {
+    RT_COMPILER_BARRIER( );
+    *destination = value;
+}
+
+/*
+================
+AtomicLoad64
+
+May tear on 32 bit builds, callers using it to seed a compare-exchange loop don't care since the
+exchange will simply fail and retry.
+================
+*/
+inline U64 AtomicLoad64( const volatile U64 *source ) {
+    U64 value = *source;
+    RT_COMPILER_BARRIER( );
+    return value;
+}
+
+/*
+================
+AtomicLoadPointer
+================
+*/
+inline void* AtomicLoadPointer( void * const volatile *source ) {
+    void *value = *source;
+    RT_COMPILER_BARRIER( );
+    return value;
+}
+
+/*
+================
+AtomicStorePointer
+================
+*/
+inline void AtomicStorePointer( void * volatile *destination, void *value ) {
+    RT_COMPILER_BARRIER( );
+    *destination = value;
+}
+
+/*
+================
+MemoryFence
+
+Full hardware memory barrier (mfence), needed for store->load ordering.
+================
+*/
+inline void MemoryFence( void ) {
+#if RT_COMPILER == RT_COMPILER_MSVC
+    _mm_mfence( );
+#elif RT_COMPILER == RT_COMPILER_GCC
+    __sync_synchronize( );
+#endif // RT_COMPILER
+}
+
+/*
+================
+CpuPause
+
+Hint to the cpu that we're in a spin-wait loop.
+================
+*/
+inline void CpuPause( void ) {
+    _mm_pause( );
+}
+
+
+#endif // RT_ATOMIC_H
@@ -5,7 +5,7 @@
     ==========
     File        :    RtDynamicLibraryManager.h
     Author      :    Jamie Taylor
-    Last Edit   :    14/07/13
+    Last Edit   :    17/10/26
     Desc        :    Dynamic library manager, libraries will automatically register themselves
                      with the manager on creation and unregister themselves on destruction. The 
                      manager keeps track of all actively loaded dynamic libraries.
@@ -15,6 +15,7 @@
 
 
 #include "RtDynamicLibraryManager.h"
+#include <string.h>
 
 
 /*
@@ -50,20 +51,17 @@ DynamicLibraryManager::Shutdown
 ================
 */
 void DynamicLibraryManager::Shutdown( void ) {
-    // clean-up internal dynLib list/record
-    if( libraryList.IsEmpty( ) == false ) {
-        SinglyLinkedList<DynamicLibraryDesc>::Iterator itr( libraryList.Begin( ) );
-        while( ( &(*itr) != NULL ) ) {
-            itr->library->Unload( );
-
-            if( itr->isDynamicallyAllocated == true ) {
-                memAllctr.Destruct( itr->library );
-                memAllctr.DeAllocate( itr->library );
-            }
-
-            libraryList.Remove(itr);
-            itr = libraryList.Begin();
-        }
+    // clean-up internal dynLib map/record
+    LibraryMap::Iterator itr( libraryMap.Begin( ) );
+    for( ; itr != libraryMap.End( ); ++itr ) {
+        ReleaseDesc( itr->value );
+    }
+
+    libraryMap.Clear( );
+
+    // anything loaded without going through the manager, unloading unregisters them
+    while( registeredLibraries.IsEmpty( ) == false ) {
+        registeredLibraries.GetFirst( )->Unload( );
     }
 }
 
@@ -73,25 +71,24 @@ DynamicLibraryManager::LoadLibrary
 ================
 */
 void DynamicLibraryManager::LoadLibrary( const I8 *libraryToLoad, DynamicLibrary &library ) {
-    // search the list for the library
-    SinglyLinkedList<DynamicLibraryDesc>::ConstIterator itr( libraryList.CBegin( ) );
-    // while node been pointed to is not NULL and the name doesn't match
-    while( ( &(*itr) != NULL ) && ( strcmp( itr->libraryName, libraryToLoad ) != 0 ) ) {
-            ++itr;
+    // have we loaded it already?
+    DynamicLibraryDesc *desc = libraryMap.Find( libraryToLoad );
+    if( desc != NULL ) {
+        library = *desc->library;
+        return;
     }
 
-    // have we found it?
-    if( ( &(*itr) != NULL ) && ( strcmp( itr->libraryName, libraryToLoad ) == 0 ) ) {
-        library = *itr->library;
-    } 
-
-    // didn't find it, create a new library instance and load it
-    DynamicLibraryDesc tempDesc( const_cast<I8*>( libraryToLoad ), &library, false );
+    // didn't find it, create a new library instance and load it, the name is copied as the caller's
+    // string needn't outlive the load
+    size_t nameLength = strlen( libraryToLoad ) + 1;
+    I8 *name = RT_ALLOC( nameAllctr, nameLength, 1 );
+    memcpy( name, libraryToLoad, nameLength );
+    DynamicLibraryDesc tempDesc( name, &library, false );
 
     // ...
 
-    // add it to the list
-    libraryList.PushFront( tempDesc );
+    // add it to the map, keyed by the copy
+    libraryMap.Insert( name, tempDesc );
 }
 
 /*
@@ -100,55 +97,62 @@ DynamicLibraryManager::UnloadLibrary
 ================
 */
 void DynamicLibraryManager::UnloadLibrary( DynamicLibrary &libraryToUnLoad  ) {
-    // search the list for the library
+    // libraries are keyed by name, search the map for the handle
     libraryHandle tempHandle = libraryToUnLoad.GetHandle( );
-    SinglyLinkedList<DynamicLibraryDesc>::Iterator itr( libraryList.Begin( ) );
-    while( ( &(*itr) != NULL ) && ( itr->library->GetHandle( ) != tempHandle ) ) {
-            ++itr;
+    LibraryMap::Iterator itr( libraryMap.Begin( ) );
+    while( itr != libraryMap.End( ) && itr->value.library->GetHandle( ) != tempHandle ) {
+        ++itr;
     }
 
     // found it? remove it
-    if( ( &(*itr) != NULL ) && ( itr->library->GetHandle( ) == tempHandle ) ) {
-        itr->library->Unload( );
-
-        if( itr->isDynamicallyAllocated == true ) {
-            memAllctr.Destruct( itr->library );
-            memAllctr.DeAllocate( itr->library );
-        }
+    if( itr != libraryMap.End( ) ) {
+        // erase first, the key is the name ReleaseDesc frees
+        DynamicLibraryDesc desc = itr->value;
+        libraryMap.Erase( itr );
+        ReleaseDesc( desc );
+    }
+}
 
-        libraryList.Remove( itr );
+/*
+================
+DynamicLibraryManager::RegisterLibrary
+================
+*/
+void DynamicLibraryManager::RegisterLibrary( DynamicLibrary &library ) {
+    // already registered, eg: loaded twice
+    if( library.managerLink.IsLinked( ) == true ) {
+        return;
     }
+
+    registeredLibraries.PushBack( &library );
 }
 
 /*
 ================
-DynamicLibraryManager::Register
+DynamicLibraryManager::UnRegisterLibrary
 ================
 */
-void DynamicLibraryManager::RegisterLibrary( void ) {
-    //// check it's not already in the library
-    //// --------------------------------------- TEMPORARY PLACE-HOLDER CODE ------------------------------------------------
-    //SinglyLinkedList<DynLibDesc>::ConstIterator itr(dynLibList.CBegin());
-    //while((&(*itr) != 0x0) && (itr->nameOfDynLib != dllName))
-    //        ++itr;
-
-    //// it's already present - stop now and return
-    //if((&(*itr) != 0x0) && (itr->nameOfDynLib == dllName))
-    //    return;
-
-    //// add it to the list/record
-    //DynLibDesc tempDesc(dllName, const_cast<DynLib*>(dllToAdd));
-    //dynLibList.PushFront(tempDesc);
-    //// --------------------------------------- TEMPORARY PLACE-HOLDER CODE ------------------------------------------------
+void DynamicLibraryManager::UnRegisterLibrary( DynamicLibrary &library ) {
+    if( library.managerLink.IsLinked( ) == true ) {
+        registeredLibraries.Remove( &library );
+    }
 }
 
 /*
 ================
-DynamicLibraryManager::UnRegister
+DynamicLibraryManager::ReleaseDesc
 ================
 */
-void DynamicLibraryManager::UnRegisterLibrary( void ) {
+void DynamicLibraryManager::ReleaseDesc( DynamicLibraryDesc &desc ) {
+    desc.library->Unload( );
+
+    if( desc.isDynamicallyAllocated == true ) {
+        memAllctr.Destruct( desc.library );
+        memAllctr.DeAllocate( desc.library );
+    }
 
+    nameAllctr.DeAllocate( desc.libraryName );
+    desc.libraryName = NULL;
 }
 
 
@@ -5,11 +5,19 @@
     ==========
     File        :    RtDynamicLibraryManager.h
     Author      :    Jamie Taylor
-    Last Edit   :    14/07/13
+    Last Edit   :    17/10/26
     Desc        :    Dynamic library manager, libraries will automatically register themselves
                      with the manager on creation and unregister themselves on destruction. The 
                      manager keeps track of all actively loaded dynamic libraries.
 
+                     17/10/26 - Libraries are kept in a hash map keyed by name rather than a list searched
+                                with strcmp.
+
+                     17/10/26 - Libraries register/unregister through an intrusive list, O(1) with no allocation.
+
+                     17/10/26 - The map owns a copy of each library's name and uses it as the key, the caller's string
+                                doesn't have to outlive the load.
+
                      - don't see a need for this, simply declaring an instance?
                      template<> DynamicLibraryManager *Singleton<DynamicLibraryManager>::singletonInstance = NULL;
 
@@ -24,7 +32,8 @@
 #include "RtDynamicLibrary.h"
 #include "../CoreSystems/RtSingleton.h"
 #include "../CoreSystems/RtHeapAllocator.h"
-#include "../CoreSystems/RtSinglyLinkedList_DP_V.h"
+#include "../CoreSystems/RtHashMap.h"
+#include "../CoreSystems/RtIntrusiveList.h"
 
 
 /*
@@ -68,13 +77,23 @@ private:
                                             bool             isDynamicallyAllocated;
                                          };
 
-    SinglyLinkedList<DynamicLibraryDesc> libraryList;
+                                         // keyed by library name, the key is the desc's libraryName - a copy the manager owns
+    typedef HashMap<const I8*, DynamicLibraryDesc, StringHasher> LibraryMap;
+    LibraryMap                           libraryMap;
                                          // if the manager is unable to find the requested library it will create it using this allocator
     HeapAllocator<DynamicLibrary>         memAllctr;
+                                         // the copies of the library names
+    HeapAllocator<I8>                    nameAllctr;
+
+                                         // every loaded library, whether or not it was loaded through the manager
+    IntrusiveList<DynamicLibrary, &DynamicLibrary::managerLink> registeredLibraries;
 
                                          // libraries will call these on loading/unloading to add/remove themselves from the list
-    void                                 RegisterLibrary( void );
-    void                                 UnRegisterLibrary( void );
+    void                                 RegisterLibrary( DynamicLibrary &library );
+    void                                 UnRegisterLibrary( DynamicLibrary &library );
+
+                                         // unload the desc's library, free it if the manager made it and free the name
+    void                                 ReleaseDesc( DynamicLibraryDesc &desc );
 
                                          DynamicLibraryManager( const DynamicLibraryManager &ref ) { /* do nothing - forbidden op */ }
     DynamicLibraryManager               & operator=( const DynamicLibraryManager &rhs ) { /* do nothing - forbidden op */ }
@@ -0,0 +1,68 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtMappedFile.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Read only view of a whole file mapped into the address space, so it can be parsed in
+                     place - no read into a buffer of our own, no second copy of the file in memory. Pages
+                     are read in from disk the first time they're touched (and the os reads ahead, the
+                     mapping is hinted as sequential), Prefetch asks for a range to be read in early.
+                     Implemented via file mappings on Windows and mmap on Linux.
+
+                     MappedFile file;
+                     if( file.Open( "mesh.obj" ) == true ) {
+                         Parse( file.Data( ), file.Size( ) );
+                         file.Close( );
+                     }
+
+===============================================================================
+*/
+
+
+#ifndef RT_MAPPED_FILE_H
+#define RT_MAPPED_FILE_H
+
+
+#include "RtPlatform.h"
+
+
+/*
+===============================================================================
+
+Mapped File class
+
+===============================================================================
+*/
+class MappedFile {
+public:
+                        MappedFile( void );
+                        ~MappedFile( void );
+
+                        // map all of @fileName, false if it can't be opened or mapped. An empty file
+                        // opens fine, Data is null
+    bool                Open( const I8 *fileName );
+                        // unmap, anything pointing into Data is left dangling
+    void                Close( void );
+
+    const U8          * Data( void ) const { return data; }
+    U64                 Size( void ) const { return size; }
+    bool                IsOpen( void ) const { return isOpen; }
+
+                        // start reading [@offset, @offset + @length) in from disk, it's only a hint
+    void                Prefetch( U64 offset, U64 length ) const;
+
+private:
+    const U8          * data;
+    U64                 size;
+    bool                isOpen;
+
+                        // not copyable, the mapping has one owner
+                        MappedFile( const MappedFile &ref );
+    MappedFile        & operator=( const MappedFile &rhs );
+};
+
+
+#endif // RT_MAPPED_FILE_H
@@ -3,8 +3,10 @@
     -----------
     File        :    PlatformInfo.cpp
     Author      :    Jamie Taylor
-    Last Edit   :    23/03/12
+    Last Edit   :    17/10/26
     Desc        :    Find out more about the platform.  Supports x86/x86_64 architecture only at the moment.
+
+                     17/10/26 - CpuidQuery clears the sub-leaf (ecx), added ReadXcr0() and SupportsAVX2().
 */
 #include "RtPlatformInfo.h"
 
@@ -84,7 +86,7 @@ I32 CpuidQuery(I32 query, CpuDesc &result)
 #if RT_COMPILER == RT_COMPILER_MSVC
     #if RT_ARCHITECTURE == RT_ARCHITECTURE_64
         int cpuInfo[4];
-        __cpuid(cpuInfo, query);
+        __cpuidex(cpuInfo, query, 0);
         
         result.eax = cpuInfo[0];
         result.ebx = cpuInfo[1];
@@ -95,8 +97,9 @@ I32 CpuidQuery(I32 query, CpuDesc &result)
     #else
         __asm
         {
-            // set eax with the query and call cpuid
+            // set eax with the query (ecx with the sub-leaf) and call cpuid
             mov eax, query
+            xor ecx, ecx
             cpuid
 
             // set up the desination
@@ -113,8 +116,9 @@ I32 CpuidQuery(I32 query, CpuDesc &result)
         // "=a" -> eax, "=b" -> ebx etc... | "a" -> "specifies the `a’ or `d’ registers" - http://www.ibiblio.org/gferg/ldp/GCC-Inline-Assembly-HOWTO.html
         __asm__
         (
-            "cpuid": "=a"(result.eax), "=b"(result.ebx), "=c"(result.ecx), "=d"(result.edx)    : "a"(query)
+            "cpuid": "=a"(result.eax), "=b"(result.ebx), "=c"(result.ecx), "=d"(result.edx)    : "a"(query), "c"(0)
         );
+        return result.eax;
     #else
         __asm__
         (
@@ -138,3 +142,42 @@ I32 CpuidQuery(I32 query, CpuDesc &result)
 #endif // RT_COMPILER == RT_COMPILER_MSVC 
 }
 /**************************************************************************************************************************/
+
+U64 ReadXcr0()
+{
+#if RT_COMPILER == RT_COMPILER_MSVC
+    return static_cast<U64>(_xgetbv(0));
+#elif RT_COMPILER == RT_COMPILER_GCC
+    U32 eax, edx;
+    // xgetbv by opcode, older assemblers don't know the mnemonic
+    __asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<U64>(edx) << 32) | eax;
+#else
+    return 0;
+#endif // RT_COMPILER
+}
+/**************************************************************************************************************************/
+
+// AVX2 needs the cpu to support it and the os to save the ymm registers across context switches
+bool SupportsAVX2()
+{
+    CpuDesc desc;
+    if(SupportsCPUID() == 0 || CpuidQuery(0, desc) < 7)
+    {
+        return false;
+    }
+
+    CpuidQuery(1, desc);
+    if((desc.ecx & CPUID_OSXSAVE) == 0 || (desc.ecx & CPUID_AVX) == 0)
+    {
+        return false;
+    }
+    if((ReadXcr0() & (XCR0_SSE_STATE | XCR0_AVX_STATE)) != (XCR0_SSE_STATE | XCR0_AVX_STATE))
+    {
+        return false;
+    }
+
+    CpuidQuery(7, desc);
+    return (desc.ebx & CPUID_AVX2) != 0;
+}
+/**************************************************************************************************************************/
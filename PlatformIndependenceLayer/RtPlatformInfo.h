@@ -3,8 +3,12 @@
     -----------
     File        :    PlatformInfo.h
     Author      :    Jamie Taylor
-    Last Edit   :    23/03/12
+    Last Edit   :    17/10/26
     Desc        :    Find out more about the platform.
+
+                     17/10/26 - CpuidQuery clears ecx (the sub-leaf) so leaf 7 can be queried, added the AVX2 (leaf 7, ebx)
+                                and OSXSAVE bits and ReadXcr0() for checking the os saves the ymm registers.
+                                Added SupportsAVX2() so the SIMD users share the one check.
 */
 #ifndef PLATFORM_INFO_H
 #define PLATFORM_INFO_H
@@ -26,6 +30,11 @@
 //#define CPUID_CVT16   (1<<?)  // part of AMDs SSE5 implementation - can't find in AMD documentation     -|
 
 #define CPUID_AVX       (1<<28) // Advanced Vector eXtensions - proposed & supported by Intel with SandyBridge and AMD with Bulldozer (onward)
+#define CPUID_OSXSAVE   (1<<27) // os uses xsave/xrstor, ReadXcr0() can be called
+#define CPUID_AVX2      (1<<5)  // leaf 7 (ebx) - 256 bit integer ops, Intel Haswell and AMD Excavator (onward)
+
+#define XCR0_SSE_STATE  (1<<1)  // os saves the xmm registers
+#define XCR0_AVX_STATE  (1<<2)  // os saves the upper halves of the ymm registers
 
 #define CPUID_MMX       (1<<23)
 #define CPUID_MMXEX     (1<<22)    // MMX Extensions - AMD ONLY
@@ -58,6 +67,19 @@ struct CpuDesc
 I32 SupportsCPUID();
 
 I32 CpuidQuery(I32 query, CpuDesc &rs);
+
+// Extended control register 0 (xgetbv) - only valid if CPUID_OSXSAVE is set
+U64 ReadXcr0();
+
+// cpu and os both support AVX2
+bool SupportsAVX2();
+
+// gcc only lets a function use AVX2 intrinsics if it's compiled for it, msvc allows them anywhere
+#if RT_COMPILER == RT_COMPILER_GCC
+    #define RT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+    #define RT_TARGET_AVX2
+#endif // RT_COMPILER
 /**************************************************************************************************************************/
 
 
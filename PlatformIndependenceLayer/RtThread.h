@@ -0,0 +1,128 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtThread.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Minimal os thread layer - start, join, sleep and yield, plus a monotonic clock that
+                     can be read from any thread (the Timer class measures from its own Reset()).
+                     Implemented via CreateThread on Windows and pthreads on Linux.
+
+                     Counting semaphores for putting idle threads to sleep, Win32 semaphores on Windows and
+                     posix semaphores on Linux.
+
+===============================================================================
+*/
+
+
+#ifndef RT_THREAD_H
+#define RT_THREAD_H
+
+
+#include "RtPlatform.h"
+
+
+// opaque os thread handle
+typedef void * ThreadHandle;
+
+// opaque os semaphore handle
+typedef void * SemaphoreHandle;
+
+// thread entry point, the return value is discarded
+typedef U32 ( *ThreadEntryPoint )( void *param );
+
+
+/*
+================
+StartThread
+
+Start a thread running @entryPoint( @param ), null on failure. Every started thread must be joined.
+================
+*/
+ThreadHandle StartThread( ThreadEntryPoint entryPoint, void *param );
+
+/*
+================
+JoinThread
+
+Wait for @thread to finish and release its handle.
+================
+*/
+void JoinThread( ThreadHandle thread );
+
+/*
+================
+SleepThread
+
+Put the calling thread to sleep for at least @milliseconds.
+================
+*/
+void SleepThread( U32 milliseconds );
+
+/*
+================
+YieldThread
+
+Give up the rest of the calling thread's time slice.
+================
+*/
+void YieldThread( void );
+
+/*
+================
+GetMonotonicMicroseconds
+
+Microseconds since some fixed point in the past, never goes backwards. Comparable across threads.
+================
+*/
+U64 GetMonotonicMicroseconds( void );
+
+/*
+================
+GetHardwareThreadCount
+
+Number of logical processors available to the process, at least 1.
+================
+*/
+U32 GetHardwareThreadCount( void );
+
+/*
+================
+NewSemaphore
+
+Counting semaphore starting at @initialCount, null on failure.
+================
+*/
+SemaphoreHandle NewSemaphore( U32 initialCount );
+
+/*
+================
+DeleteSemaphore
+
+No thread may be waiting on it.
+================
+*/
+void DeleteSemaphore( SemaphoreHandle semaphore );
+
+/*
+================
+SignalSemaphore
+
+Add @count to the semaphore, waking up to @count waiting threads.
+================
+*/
+void SignalSemaphore( SemaphoreHandle semaphore, U32 count = 1 );
+
+/*
+================
+WaitSemaphore
+
+Block until the count is non-zero, then decrement it.
+================
+*/
+void WaitSemaphore( SemaphoreHandle semaphore );
+
+
+#endif // RT_THREAD_H
@@ -0,0 +1,96 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtVirtualMemory.h
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Page granular memory straight from the os, bypassing the c runtime heap.
+                     Implemented via VirtualAlloc on Windows and mmap on Linux.
+
+                     All sizes are rounded up to a multiple of the page size.
+
+                     Address space can also be reserved up front and committed/decommitted a range at a
+                     time, pointers passed to Commit/DecommitPages must be page aligned.
+
+===============================================================================
+*/
+
+
+#ifndef RT_VIRTUAL_MEMORY_H
+#define RT_VIRTUAL_MEMORY_H
+
+
+#include "RtPlatform.h"
+#include <stddef.h>
+
+
+/*
+================
+GetPageSize
+
+Size of a page in bytes.
+================
+*/
+size_t GetPageSize( void );
+
+/*
+================
+AllocatePages
+
+Reserve and commit @sizeInBytes of zeroed, read/write memory, null on failure.
+@largePageHint asks the os to back the range with large pages where it can (big, randomly
+accessed tables spend most of their time in tlb misses otherwise), it's only a hint.
+================
+*/
+void * AllocatePages( size_t sizeInBytes, bool largePageHint = false );
+
+/*
+================
+FreePages
+
+Hand back memory from AllocatePages, @sizeInBytes must match the allocation.
+================
+*/
+void FreePages( void *memory, size_t sizeInBytes );
+
+/*
+================
+ReservePages
+
+Reserve @sizeInBytes of address space without backing it, touching it before committing is an
+access violation. Null on failure.
+================
+*/
+void * ReservePages( size_t sizeInBytes );
+
+/*
+================
+CommitPages
+
+Back a range of reserved address space with read/write memory, false on failure.
+================
+*/
+bool CommitPages( void *memory, size_t sizeInBytes );
+
+/*
+================
+DecommitPages
+
+Hand the physical memory behind a committed range back to the os, the address space stays reserved.
+================
+*/
+void DecommitPages( void *memory, size_t sizeInBytes );
+
+/*
+================
+ReleasePages
+
+Hand back an entire reservation from ReservePages, committed or not.
+================
+*/
+void ReleasePages( void *memory, size_t sizeInBytes );
+
+
+#endif // RT_VIRTUAL_MEMORY_H
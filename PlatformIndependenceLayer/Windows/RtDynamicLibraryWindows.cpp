@@ -5,7 +5,7 @@
     ==========
     File        :   RtDynamicLibraryWindows.h
     Author      :   Jamie Taylor
-    Last Edit   :   29/06/13
+    Last Edit   :   17/10/26
     Desc        :   Represents a DLL/SO.
 
                     _H - using heap allocator
@@ -17,6 +17,7 @@
 
 
 #include "RtDynamicLibraryWindows.h"
+#include "../RtDynamicLibraryManager.h"
 
 
 /*
@@ -56,8 +57,11 @@ bool DynamicLibrary::Load( const I8 *libraryName ) {
         return false;
     }
 
-    // TODO: add to manager's list...
-    // if can't register return false
+    // let the manager know, if there is one
+    DynamicLibraryManager *manager = DynamicLibraryManager::GetSingletonPointer( );
+    if( manager != NULL ) {
+        manager->RegisterLibrary( *this );
+    }
 
     return true;
 }
@@ -75,7 +79,11 @@ void DynamicLibrary::Unload( void ) {
     else {
         internalHandle = NULL;
     }
-    // TODO: remove from manager's list...
+
+    // unregistered even if freeing failed, the manager shouldn't hold on to it either way
+    if( managerLink.IsLinked( ) == true ) {
+        DynamicLibraryManager::GetSingletonReference( ).UnRegisterLibrary( *this );
+    }
 }
 
 /*
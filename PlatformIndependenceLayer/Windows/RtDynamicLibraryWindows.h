@@ -5,9 +5,12 @@
     ==========
     File        :   RtDynamicLibraryWindows.h
     Author      :   Jamie Taylor
-    Last Edit   :   14/07/13
+    Last Edit   :   17/10/26
     Desc        :   Represents a DLL/SO.
 
+                    17/10/26 - Loaded libraries register themselves with the DynamicLibraryManager (when there
+                               is one) through an intrusive link, so it costs no allocation.
+
                     _H - using heap allocator
                     _DP - using dynamic pool allocator
                     _V - volatile; source code likely/probable to change
@@ -21,6 +24,7 @@
 
 
 #include "../RtDynamicLibrary.h"
+#include "../../CoreSystems/RtIntrusiveList.h"
 
 
 /*
@@ -49,6 +53,10 @@ public:
 
 private:
     libraryHandle internalHandle;
+
+                  // links this into the manager's list of loaded libraries
+    friend class  DynamicLibraryManager;
+    IntrusiveListLink managerLink;
 };
 
 
@@ -0,0 +1,119 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtMappedFileWin.cpp
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Read only file mapping, Windows implementation.
+
+===============================================================================
+*/
+
+
+#include "../RtMappedFile.h"
+
+
+/*
+================
+MappedFile::MappedFile
+================
+*/
+MappedFile::MappedFile( void ) {
+    data = NULL;
+    size = 0;
+    isOpen = false;
+}
+
+/*
+================
+MappedFile::~MappedFile
+================
+*/
+MappedFile::~MappedFile( void ) {
+    Close( );
+}
+
+/*
+================
+MappedFile::Open
+
+The view keeps the mapping and file open, both handles can be closed straight away.
+FILE_FLAG_SEQUENTIAL_SCAN is the read ahead hint. A mapping can't be made of an empty file.
+================
+*/
+bool MappedFile::Open( const I8 *fileName ) {
+    Close( );
+
+    HANDLE fileHandle = CreateFile( fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+    if( fileHandle == INVALID_HANDLE_VALUE ) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if( GetFileSizeEx( fileHandle, &fileSize ) == 0 ) {
+        CloseHandle( fileHandle );
+        return false;
+    }
+
+    size = static_cast<U64>( fileSize.QuadPart );
+    if( size > 0 ) {
+        HANDLE mappingHandle = CreateFileMapping( fileHandle, NULL, PAGE_READONLY, 0, 0, NULL );
+        void *view = NULL;
+        if( mappingHandle != NULL ) {
+            view = MapViewOfFile( mappingHandle, FILE_MAP_READ, 0, 0, 0 );
+            CloseHandle( mappingHandle );
+        }
+
+        if( view == NULL ) {
+            CloseHandle( fileHandle );
+            size = 0;
+            return false;
+        }
+
+        data = reinterpret_cast<const U8*>( view );
+    }
+
+    CloseHandle( fileHandle );
+    isOpen = true;
+    return true;
+}
+
+/*
+================
+MappedFile::Close
+================
+*/
+void MappedFile::Close( void ) {
+    if( data != NULL ) {
+        UnmapViewOfFile( data );
+    }
+
+    data = NULL;
+    size = 0;
+    isOpen = false;
+}
+
+/*
+================
+MappedFile::Prefetch
+
+PrefetchVirtualMemory is Windows 8 and up, earlier versions just page it in as it's touched.
+================
+*/
+void MappedFile::Prefetch( U64 offset, U64 length ) const {
+    if( ( data == NULL ) || ( offset >= size ) ) {
+        return;
+    }
+
+#if defined( _WIN32_WINNT ) && ( _WIN32_WINNT >= 0x0602 )
+    length = ( length < ( size - offset ) ) ? length : ( size - offset );
+
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = const_cast<U8*>( data + offset );
+    range.NumberOfBytes = static_cast<SIZE_T>( length );
+    PrefetchVirtualMemory( GetCurrentProcess( ), 1, &range, 0 );
+#endif // _WIN32_WINNT >= 0x0602
+}
@@ -0,0 +1,148 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtThreadWin.cpp
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Minimal os thread layer, Windows implementation.
+
+===============================================================================
+*/
+
+
+#include "../RtThread.h"
+
+
+// what the win32 trampoline needs to call the real entry point
+struct ThreadStart {
+    ThreadEntryPoint    entryPoint;
+    void              * param;
+};
+
+
+/*
+================
+ThreadTrampoline
+================
+*/
+static DWORD WINAPI ThreadTrampoline( LPVOID arg ) {
+    ThreadStart start = *reinterpret_cast<ThreadStart*>( arg );
+    delete reinterpret_cast<ThreadStart*>( arg );
+
+    return static_cast<DWORD>( start.entryPoint( start.param ) );
+}
+
+/*
+================
+StartThread
+================
+*/
+ThreadHandle StartThread( ThreadEntryPoint entryPoint, void *param ) {
+    ThreadStart *start = new ThreadStart;
+    start->entryPoint = entryPoint;
+    start->param = param;
+
+    HANDLE thread = CreateThread( NULL, 0, ThreadTrampoline, start, 0, NULL );
+    if( thread == NULL ) {
+        delete start;
+    }
+
+    return reinterpret_cast<ThreadHandle>( thread );
+}
+
+/*
+================
+JoinThread
+================
+*/
+void JoinThread( ThreadHandle thread ) {
+    WaitForSingleObject( reinterpret_cast<HANDLE>( thread ), INFINITE );
+    CloseHandle( reinterpret_cast<HANDLE>( thread ) );
+}
+
+/*
+================
+SleepThread
+================
+*/
+void SleepThread( U32 milliseconds ) {
+    Sleep( milliseconds );
+}
+
+/*
+================
+YieldThread
+================
+*/
+void YieldThread( void ) {
+    SwitchToThread( );
+}
+
+/*
+================
+GetMonotonicMicroseconds
+================
+*/
+U64 GetMonotonicMicroseconds( void ) {
+    static LARGE_INTEGER frequency = { 0 };
+    if( frequency.QuadPart == 0 ) {
+        QueryPerformanceFrequency( &frequency );
+    }
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter( &now );
+
+    // split to avoid overflowing the multiply
+    U64 seconds = static_cast<U64>( now.QuadPart / frequency.QuadPart );
+    U64 remainder = static_cast<U64>( now.QuadPart % frequency.QuadPart );
+    return ( seconds * 1000000 ) + ( ( remainder * 1000000 ) / static_cast<U64>( frequency.QuadPart ) );
+}
+
+/*
+================
+GetHardwareThreadCount
+================
+*/
+U32 GetHardwareThreadCount( void ) {
+    SYSTEM_INFO info;
+    GetSystemInfo( &info );
+    return ( info.dwNumberOfProcessors > 0 ) ? static_cast<U32>( info.dwNumberOfProcessors ) : 1;
+}
+
+/*
+================
+NewSemaphore
+================
+*/
+SemaphoreHandle NewSemaphore( U32 initialCount ) {
+    return reinterpret_cast<SemaphoreHandle>( CreateSemaphoreA( NULL, static_cast<LONG>( initialCount ), 0x7FFFFFFF, NULL ) );
+}
+
+/*
+================
+DeleteSemaphore
+================
+*/
+void DeleteSemaphore( SemaphoreHandle semaphore ) {
+    CloseHandle( reinterpret_cast<HANDLE>( semaphore ) );
+}
+
+/*
+================
+SignalSemaphore
+================
+*/
+void SignalSemaphore( SemaphoreHandle semaphore, U32 count ) {
+    ReleaseSemaphore( reinterpret_cast<HANDLE>( semaphore ), static_cast<LONG>( count ), NULL );
+}
+
+/*
+================
+WaitSemaphore
+================
+*/
+void WaitSemaphore( SemaphoreHandle semaphore ) {
+    WaitForSingleObject( reinterpret_cast<HANDLE>( semaphore ), INFINITE );
+}
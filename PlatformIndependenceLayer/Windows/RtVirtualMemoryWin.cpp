@@ -0,0 +1,89 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtVirtualMemoryWin.cpp
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Page granular memory straight from the os, Windows implementation.
+
+===============================================================================
+*/
+
+
+#include "../RtVirtualMemory.h"
+
+
+/*
+================
+GetPageSize
+================
+*/
+size_t GetPageSize( void ) {
+    static size_t pageSize = 0;
+    if( pageSize == 0 ) {
+        SYSTEM_INFO systemInfo;
+        GetSystemInfo( &systemInfo );
+        pageSize = static_cast<size_t>( systemInfo.dwPageSize );
+    }
+    return pageSize;
+}
+
+/*
+================
+AllocatePages
+
+@largePageHint is ignored, MEM_LARGE_PAGES needs SeLockMemoryPrivilege and non-pageable memory.
+================
+*/
+void * AllocatePages( size_t sizeInBytes, bool largePageHint ) {
+    return VirtualAlloc( NULL, sizeInBytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE );
+}
+
+/*
+================
+FreePages
+
+MEM_RELEASE requires a size of 0, the whole reservation is released.
+================
+*/
+void FreePages( void *memory, size_t sizeInBytes ) {
+    VirtualFree( memory, 0, MEM_RELEASE );
+}
+
+/*
+================
+ReservePages
+================
+*/
+void * ReservePages( size_t sizeInBytes ) {
+    return VirtualAlloc( NULL, sizeInBytes, MEM_RESERVE, PAGE_NOACCESS );
+}
+
+/*
+================
+CommitPages
+================
+*/
+bool CommitPages( void *memory, size_t sizeInBytes ) {
+    return ( VirtualAlloc( memory, sizeInBytes, MEM_COMMIT, PAGE_READWRITE ) != NULL );
+}
+
+/*
+================
+DecommitPages
+================
+*/
+void DecommitPages( void *memory, size_t sizeInBytes ) {
+    VirtualFree( memory, sizeInBytes, MEM_DECOMMIT );
+}
+
+/*
+================
+ReleasePages
+================
+*/
+void ReleasePages( void *memory, size_t sizeInBytes ) {
+    VirtualFree( memory, 0, MEM_RELEASE );
+}
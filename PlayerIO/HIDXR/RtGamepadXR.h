@@ -132,7 +132,7 @@ private:
 template<class Allocator>
 Gamepad* CreateGamepad(Allocator &allctr)
 {
-    GamepadXR *temp = reinterpret_cast<GamepadXR*>(allctr.Allocate(sizeof(GamepadXR)));
+    GamepadXR *temp = reinterpret_cast<GamepadXR*>(RT_ALLOC(allctr, sizeof(GamepadXR), 1));
     allctr.Construct(temp);
     return reinterpret_cast<Gamepad*>(temp);
 }
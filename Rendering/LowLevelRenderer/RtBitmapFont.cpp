@@ -5,48 +5,50 @@
     ==========
     File        :    RtBitmapFont.cpp
     Author      :    Jamie Taylor
-    Last Edit   :    08/07/13
+    Last Edit   :    17/10/26
     Desc        :    Represents a bitmap font.
 
+                     17/10/26 - Parses with the zero-copy tokenizer and ParseI32, ReadInteger replaces ClearAndRead.
+
+                     17/10/26 - The file is memory mapped (MappedFile) and parsed in place.
+
 ===============================================================================
 */
 
 
 #include "RtBitmapFont.h"
-// atoi & atof (write my own for the learning experience?)
-#include <stdlib.h>
+#include "../../CoreSystems/RtParse.h"
+#include "../../PlatformIndependenceLayer/RtMappedFile.h"
 
 
 /*
 ================
-LoadBitmapFont
+ReadInteger
+
+Reads the value following a key.
 ================
 */
-bool LoadBitmapFont( const char *filename, BitmapFont &font ) {
-    HeapAllocator<void> heapAllctr;
-    Tokenizer tokenizer;
+static I32 ReadInteger( Tokenizer &tokenizer, const DelimiterSet &delimiters ) {
+    TokenView token;
+    I32 value = 0;
 
-    // load the file
-    HANDLE fileHwnd = CreateFile( filename, GENERIC_READ, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
-    if( fileHwnd == INVALID_HANDLE_VALUE ) {
-        return false;
-    }
-
-    // read in the file
-    LARGE_INTEGER fileSize;
-    GetFileSizeEx( fileHwnd, &fileSize );
+    tokenizer.GetNextToken( token, delimiters );
+    ParseI32( token.start, token.length, value );
+    return value;
+}
 
-    I8 *fileBuffer = reinterpret_cast<I8*>( heapAllctr.Allocate( sizeof( I8 ) * fileSize.QuadPart ) );
-    U32 bytesRead = 0;
 
-    if( ReadFile( fileHwnd, reinterpret_cast<void*>( &fileBuffer[0] ), fileSize.QuadPart,
-                  reinterpret_cast<LPDWORD>( &bytesRead ), NULL ) == 0 ) {
-        CloseHandle( fileHwnd );
-        return false;
-    }
+/*
+================
+LoadBitmapFont
+================
+*/
+bool LoadBitmapFont( const char *filename, BitmapFont &font ) {
+    Tokenizer tokenizer;
 
-    // done reading from the file, close it
-    if( CloseHandle( fileHwnd ) == 0 ) {
+    // map the file
+    MappedFile file;
+    if( file.Open( filename ) == false ) {
         return false;
     }
 
@@ -54,105 +56,68 @@ bool LoadBitmapFont( const char *filename, BitmapFont &font ) {
     // using the bitmap font structs described above
 
     // common info
-    I8 tokenBuffer[64] = { 0 };
-    I8 delimiters[2] = { ' ', '=' };
-    tokenizer.SetBuffer( &fileBuffer[0], fileSize.QuadPart );
+    TokenView token;
+    const DelimiterSet delimiters( " =", 2 );
+    tokenizer.SetBuffer( reinterpret_cast<const I8*>( file.Data( ) ), static_cast<U32>( file.Size( ) ) );
 
     // parse the common info we care about
-    while( strcmp( tokenBuffer, "count" ) != 0 ) {
-        ClearAndRead( tokenizer, tokenBuffer, delimiters, 2 );
-
-        if( strcmp( tokenBuffer, "size" ) == 0 ) {
-            ClearAndRead( tokenizer, tokenBuffer, delimiters, 2 );
-            font.size = atoi( tokenBuffer );
+    while( tokenizer.GetNextToken( token, delimiters ) == true && token.Equals( "count" ) == false ) {
+        if( token.Equals( "size" ) == true ) {
+            font.size = ReadInteger( tokenizer, delimiters );
         }
-
-        if( strcmp( tokenBuffer, "lineHeight" ) == 0 ) {
-            ClearAndRead( tokenizer, tokenBuffer, delimiters, 2 );
-            font.lineHeight = atoi( tokenBuffer );
+        else if( token.Equals( "lineHeight" ) == true ) {
+            font.lineHeight = ReadInteger( tokenizer, delimiters );
         }
-
-        if( strcmp( tokenBuffer, "base" ) == 0 ) {
-            ClearAndRead( tokenizer, tokenBuffer, delimiters, 2 );
-            font.base = atoi( tokenBuffer );
+        else if( token.Equals( "base" ) == true ) {
+            font.base = ReadInteger( tokenizer, delimiters );
         }
-
-        if( strcmp( tokenBuffer, "scaleW" ) == 0 ) {
-            ClearAndRead( tokenizer, tokenBuffer, delimiters, 2 );
-            font.textureWidth = atoi( tokenBuffer );
+        else if( token.Equals( "scaleW" ) == true ) {
+            font.textureWidth = ReadInteger( tokenizer, delimiters );
         }
-
-        if( strcmp( tokenBuffer, "scaleH" ) == 0 ) {
-            ClearAndRead( tokenizer, tokenBuffer, delimiters, 2 );
-            font.textureHeight = atoi( tokenBuffer );
+        else if( token.Equals( "scaleH" ) == true ) {
+            font.textureHeight = ReadInteger( tokenizer, delimiters );
         }
     } // while( )
     // how many characters are described in this file?
-    ClearAndRead( tokenizer, tokenBuffer, delimiters, 2 );
-    U32 charCount = atoi( tokenBuffer );
+    U32 charCount = ReadInteger( tokenizer, delimiters );
 
     // stop at kerning info
     U32 charID = 0;
     for( U32 i=0; i<charCount;  ) {
-        tokenizer.GetNextToken( &tokenBuffer[0], delimiters, 2 );
-
-        if( strcmp( tokenBuffer, "id" ) == 0 ) {
-            ClearAndRead( tokenizer, tokenBuffer, delimiters, 2 );
-            charID = atoi( tokenBuffer );
+        if( tokenizer.GetNextToken( token, delimiters ) == false ) {
+            break;
         }
 
-        if( strcmp( tokenBuffer, "x" ) == 0 ) {
-            ClearAndRead( tokenizer, tokenBuffer, delimiters, 2 );
-            font.characters[charID].posX = atoi( tokenBuffer );
+        if( token.Equals( "id" ) == true ) {
+            charID = ReadInteger( tokenizer, delimiters );
         }
-
-        if( strcmp( tokenBuffer, "y" ) == 0 ) {
-            ClearAndRead( tokenizer, tokenBuffer, delimiters, 2 );
-            font.characters[charID].posY = atoi( tokenBuffer );
+        else if( token.Equals( "x" ) == true ) {
+            font.characters[charID].posX = ReadInteger( tokenizer, delimiters );
         }
-
-        if( strcmp( tokenBuffer, "width" ) == 0 ) {
-            ClearAndRead( tokenizer, tokenBuffer, delimiters, 2 );
-            font.characters[charID].width = atoi( tokenBuffer );
+        else if( token.Equals( "y" ) == true ) {
+            font.characters[charID].posY = ReadInteger( tokenizer, delimiters );
         }
-
-        if( strcmp( tokenBuffer, "height" ) == 0 ) {
-            ClearAndRead( tokenizer, tokenBuffer, delimiters, 2 );
-            font.characters[charID].height = atoi( tokenBuffer );
+        else if( token.Equals( "width" ) == true ) {
+            font.characters[charID].width = ReadInteger( tokenizer, delimiters );
         }
-
-        if( strcmp( tokenBuffer, "xoffset" ) == 0 ) {
-            ClearAndRead( tokenizer, tokenBuffer, delimiters, 2 );
-            font.characters[charID].xOffset = atoi( tokenBuffer );
+        else if( token.Equals( "height" ) == true ) {
+            font.characters[charID].height = ReadInteger( tokenizer, delimiters );
         }
-
-        if( strcmp( tokenBuffer, "yoffset" ) == 0 ) {
-            ClearAndRead( tokenizer, tokenBuffer, delimiters, 2 );
-            font.characters[charID].yOffset = atoi( tokenBuffer );
+        else if( token.Equals( "xoffset" ) == true ) {
+            font.characters[charID].xOffset = ReadInteger( tokenizer, delimiters );
         }
-
-        if( strcmp( tokenBuffer, "xadvance" ) == 0 ) {
-            ClearAndRead( tokenizer, tokenBuffer, delimiters, 2 );
-            font.characters[charID].xAdvance = atoi( tokenBuffer );
+        else if( token.Equals( "yoffset" ) == true ) {
+            font.characters[charID].yOffset = ReadInteger( tokenizer, delimiters );
+        }
+        else if( token.Equals( "xadvance" ) == true ) {
+            font.characters[charID].xAdvance = ReadInteger( tokenizer, delimiters );
             ++i;
         }
-
-        memset( tokenBuffer, 0, 64 );
     } // for( )
 
-    heapAllctr.DeAllocate( reinterpret_cast<void*>( fileBuffer ) );
-    fileBuffer = NULL;
+    tokenizer.ReleaseBuffer( );
+    file.Close( );
 
     // done
     return true;
-} 
-
-/*
-================
-ClearAndRead
-================
-*/
-void ClearAndRead( Tokenizer &tokenizer, char *tokenBuffer, char *delimiters, U32 delimiterCount ) {
-    memset( tokenBuffer, 0, 64 );
-    tokenizer.GetNextToken( &tokenBuffer[0], delimiters, 2 );
 }
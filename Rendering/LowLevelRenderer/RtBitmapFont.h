@@ -5,9 +5,11 @@
     ==========
     File        :    RtBitmapFont.h
     Author      :    Jamie Taylor
-    Last Edit   :    22/07/13
+    Last Edit   :    17/10/26
     Desc        :    Represents a bitmap font.
 
+                     17/10/26 - Removed ClearAndRead, the loader uses the zero-copy tokenizer.
+
 ===============================================================================
 */
 
@@ -62,8 +64,6 @@ struct StringDescription {
 
 // move these functions to the filesystem/fileLoader utility class?
 bool LoadBitmapFont( const I8 *filename, BitmapFont &font );
-// clear the memory buffer and read the next token, calling this reduces the number of lines of code overall
-void ClearAndRead( Tokenizer &tokenizer, I8 *tokenBuffer, I8 *delimiters, U32 delimiterCount );
 
 
 #endif // RT_BITMAP_FONT_H
@@ -20,7 +20,7 @@
 #include "../../PlatformIndependenceLayer/RtPlatform.h"
 #include "../../CoreSystems/RtAssert.h"
 
-#include "../../CoreSystems/RtHeapAllocator.h"
+#include "../../CoreSystems/RtSizeClassAllocator.h"
 
 #include "RtMesh.h"
 
@@ -44,7 +44,8 @@ public:
     void                           GenerateGrid( U32 unitsAlongX, U32 unitsAlongZ, U32 columns, U32 rows, Mesh &mesh );
 
 private:
-    HeapAllocator<void>            allocator;
+                                   // must match the mesh's allocator, meshes free what we generate
+    SizeClassAllocator<void>       allocator;
 
                                    GeoPrimitiveGenerator( const GeoPrimitiveGenerator &ref ) { /* do nothing - forbidden op */ }
     GeoPrimitiveGenerator         & operator=( const GeoPrimitiveGenerator &rhs ) { /* do nothing - forbidden op */ }
@@ -5,15 +5,511 @@
     ==========
     File        :    RtMesh.cpp
     Author      :    Jamie Taylor
-    Last Edit   :    31/07/13
+    Last Edit   :    17/10/26
     Desc        :    Describes a mesh used by the engine. Contents can be set
                      by parsing a .rtm file or using the GeoPrimitiveGenerator.
 
+                     17/10/26 - The .obj/.mtl parsing uses the zero-copy tokenizer, no more token buffers to
+                                clear after every token. Numbers are converted straight from the token with
+                                ParseF32/ParseI32 rather than atof/atoi.
+
+                     17/10/26 - LoadFromObjFile reads the file once instead of three times (count, component
+                                counts, parse), the data goes into ArenaArrays that grow as it's read.
+
+                     17/10/26 - The .obj file is split into chunks of whole lines that are parsed over the job system
+                                (when it's running), then stitched together. Negative (relative) face indices work.
+
+                     17/10/26 - The .obj and .mtl files are memory mapped (MappedFile) and parsed in place rather
+                                than read into a buffer first.
+
+                     17/10/26 - Each chunk's arrays are sized from a quick count of the lines starting with each keyword
+                                instead of reserving half the chunk for every one of them, and a chunk that can't grow
+                                its arrays makes LoadFromObjFile return false.
+
 ===============================================================================
 */
 
 
 #include "RtMesh.h"
+#include "../../CoreSystems/RtParse.h"
+#include "../../CoreSystems/RtArenaArray.h"
+#include "../../CoreSystems/RtMemoryCommon.h"
+#include "../../CoreSystems/RtJobSystem.h"
+#include "../../PlatformIndependenceLayer/RtMappedFile.h"
+#include <new>
+#include <string.h>
+
+
+/*
+================
+ReadFloat
+
+Reads the next token as a float, 0 if it isn't one (as atof did).
+================
+*/
+static F32 ReadFloat( Tokenizer &tokenizer, const DelimiterSet &delimiters ) {
+    TokenView token;
+    F32 value = 0.0f;
+
+    tokenizer.GetNextToken( token, delimiters );
+    ParseF32( token.start, token.length, value );
+    return value;
+}
+
+/*
+================
+ParseValue
+================
+*/
+static inline void ParseValue( const TokenView &token, F32 &value ) {
+    ParseF32( token.start, token.length, value );
+}
+
+static inline void ParseValue( const TokenView &token, U32 &value ) {
+    I32 index;
+    if( ParseI32( token.start, token.length, index ) == true ) {
+        value = static_cast<U32>( index );
+    }
+}
+
+/*
+================
+ReadLine
+
+Reads the values on the rest of the line into @values. If @componentCount is 0 every value is kept
+and the count is returned, otherwise exactly @componentCount are added (extras are dropped, missing
+or unreadable ones are @padding) so the array stays in step with the line count.
+================
+*/
+template<class T>
+static U32 ReadLine( Tokenizer &tokenizer, const DelimiterSet &delimiters, ArenaArray<T> &values, U32 componentCount, T padding ) {
+    TokenView token;
+    U32 read = 0;
+
+    while( ( tokenizer.GetNextToken( token, delimiters ) == true ) && ( token.IsEndOfLine( ) == false ) ) {
+        if( ( componentCount == 0 ) || ( read < componentCount ) ) {
+            T value = padding;
+            ParseValue( token, value );
+            values.PushBack( value );
+            ++read;
+        }
+    }
+
+    for( ; read < componentCount; ++read ) {
+        values.PushBack( padding );
+    }
+
+    return read;
+}
+
+
+/*
+================
+ObjChunk
+
+A run of whole lines from an .obj file and what was read from them. Face indices are left as they
+are in the file (1 based, counting over the whole file) apart from the ones in relativeIndices, they
+were negative and count from the start of the chunk until the chunk's bases are added on.
+================
+*/
+struct ObjChunk : public Uncopyable {
+                            ObjChunk( const I8 *start_, U32 length_ );
+
+    bool                    HasFailed( void ) const;
+
+    const I8              * start;
+    U32                     length;
+
+    ArenaArray<F32>         positions;
+    ArenaArray<F32>         textureCoordinates;
+    ArenaArray<F32>         normals;
+    ArenaArray<U32>         faceIndices;
+                            // where the chunk relative indices are in faceIndices
+    ArenaArray<U32>         relativeIndices;
+                            // first vertex of each submesh (aka subset), counting from the chunk's first face
+    ArenaArray<U32>         subMeshStarts;
+                            // views into the file buffer
+    ArenaArray<TokenView>   materialNames;
+    TokenView               materialFile;
+
+                            // how many values make up a texture coordinate, normal and face - set by the first of each
+    U32                     textureCoordinateComponentCount;
+    U32                     normalComponentCount;
+    U32                     faceComponentCount;
+    U32                     faceCount;
+
+                            // how many positions, texture coordinates and normals come before the chunk's
+    U32                     bases[3];
+    U32                     faceBase;
+};
+
+/*
+================
+ObjChunk::ObjChunk
+
+Nothing is reserved until the chunk is parsed, see ReserveObjChunk.
+================
+*/
+ObjChunk::ObjChunk( const I8 *start_, U32 length_ ) {
+    start = start_;
+    length = length_;
+
+    materialFile.start = NULL;
+    materialFile.length = 0;
+
+    textureCoordinateComponentCount = 0;
+    normalComponentCount = 0;
+    faceComponentCount = 0;
+    faceCount = 0;
+
+    bases[0] = bases[1] = bases[2] = 0;
+    faceBase = 0;
+}
+
+/*
+================
+ObjChunk::HasFailed
+
+One of the arrays couldn't grow, the chunk is incomplete.
+================
+*/
+bool ObjChunk::HasFailed( void ) const {
+    return positions.HasFailed( ) || textureCoordinates.HasFailed( ) || normals.HasFailed( ) || faceIndices.HasFailed( ) ||
+           relativeIndices.HasFailed( ) || subMeshStarts.HasFailed( ) || materialNames.HasFailed( );
+}
+
+/*
+================
+IsObjSeparator
+
+What the tokenizer skips between tokens, as set up in ParseObjChunk.
+================
+*/
+static inline bool IsObjSeparator( I8 c ) {
+    return ( static_cast<U8>( c ) <= 32 ) || ( static_cast<U8>( c ) >= 127 ) || ( c == '/' );
+}
+
+/*
+================
+ObjValueBound
+
+At most @maxLength/2 + 1 values on each of @lineCount lines (a value and a separator take two
+characters), capped at what the whole chunk could hold.
+================
+*/
+static size_t ObjValueBound( U32 lineCount, U32 maxLength, U32 chunkLength ) {
+    U64 bound = static_cast<U64>( lineCount ) * ( maxLength / 2 + 1 );
+    U64 cap = chunkLength / 2 + 1;
+    return static_cast<size_t>( ( bound < cap ) ? bound : cap );
+}
+
+/*
+================
+ReserveObjChunk
+
+Sizes the chunk's arrays from a quick count of the lines starting with each keyword (and the
+longest of them), rather than reserving for the whole chunk in every array. A file that puts
+keywords anywhere but the start of a line can go past the counts, the arrays move to a bigger
+reservation when that happens.
+================
+*/
+static bool ReserveObjChunk( ObjChunk &chunk ) {
+    enum { OBJ_V = 0, OBJ_VT, OBJ_VN, OBJ_F, OBJ_USEMTL, OBJ_KEYWORD_COUNT };
+    U32 lineCounts[OBJ_KEYWORD_COUNT] = { 0 };
+    U32 maxLengths[OBJ_KEYWORD_COUNT] = { 0 };
+
+    const I8 *line = chunk.start, *chunkEnd = chunk.start + chunk.length;
+    while( line < chunkEnd ) {
+        const I8 *lineEnd = reinterpret_cast<const I8*>( memchr( line, '\n', static_cast<size_t>( chunkEnd - line ) ) );
+        lineEnd = ( lineEnd != NULL ) ? lineEnd : chunkEnd;
+
+        const I8 *keyword = line;
+        while( ( keyword < lineEnd ) && ( IsObjSeparator( *keyword ) == true ) ) {
+            ++keyword;
+        }
+        const I8 *keywordEnd = keyword;
+        while( ( keywordEnd < lineEnd ) && ( IsObjSeparator( *keywordEnd ) == false ) ) {
+            ++keywordEnd;
+        }
+
+        I32 kind = -1;
+        switch( keywordEnd - keyword ) {
+            case 1:
+                kind = ( keyword[0] == 'v' ) ? OBJ_V : ( ( keyword[0] == 'f' ) ? OBJ_F : -1 );
+                break;
+            case 2:
+                if( keyword[0] == 'v' ) {
+                    kind = ( keyword[1] == 't' ) ? OBJ_VT : ( ( keyword[1] == 'n' ) ? OBJ_VN : -1 );
+                }
+                break;
+            case 6:
+                kind = ( memcmp( keyword, "usemtl", 6 ) == 0 ) ? OBJ_USEMTL : -1;
+                break;
+        }
+
+        if( kind >= 0 ) {
+            U32 lineLength = static_cast<U32>( lineEnd - line );
+            ++lineCounts[kind];
+            maxLengths[kind] = ( lineLength > maxLengths[kind] ) ? lineLength : maxLengths[kind];
+        }
+
+        line = lineEnd + 1;
+    }
+
+    // positions always take three values, relative indices are rare enough to start small
+    bool reserved = chunk.positions.Reserve( static_cast<size_t>( lineCounts[OBJ_V] ) * 3 );
+    reserved &= chunk.textureCoordinates.Reserve( ObjValueBound( lineCounts[OBJ_VT], maxLengths[OBJ_VT], chunk.length ) );
+    reserved &= chunk.normals.Reserve( ObjValueBound( lineCounts[OBJ_VN], maxLengths[OBJ_VN], chunk.length ) );
+    reserved &= chunk.faceIndices.Reserve( ObjValueBound( lineCounts[OBJ_F], maxLengths[OBJ_F], chunk.length ) );
+    reserved &= chunk.subMeshStarts.Reserve( lineCounts[OBJ_USEMTL] );
+    reserved &= chunk.materialNames.Reserve( lineCounts[OBJ_USEMTL] );
+    return reserved;
+}
+
+/*
+================
+ElementCount
+
+Positions (0), texture coordinates (1) or normals (2) read into the chunk so far.
+================
+*/
+static U32 ElementCount( const ObjChunk &chunk, U32 element ) {
+    switch( element ) {
+        case 0:
+            return chunk.positions.Count( ) / 3;
+        case 1:
+            return ( chunk.textureCoordinateComponentCount > 0 ) ? ( chunk.textureCoordinates.Count( ) / chunk.textureCoordinateComponentCount ) : 0;
+        default:
+            return ( chunk.normalComponentCount > 0 ) ? ( chunk.normals.Count( ) / chunk.normalComponentCount ) : 0;
+    }
+}
+
+/*
+================
+ParseObjChunk
+
+Stops early if the chunk's arrays can't grow, HasFailed() says so.
+================
+*/
+static void ParseObjChunk( ObjChunk &chunk, bool rightHanded ) {
+    if( ReserveObjChunk( chunk ) == false ) {
+        return;
+    }
+
+    // names (file, material) can hold a '/'
+    const DelimiterSet delimiters( " /", 2 );
+    const DelimiterSet nameDelimiters( " ", 1 );
+
+    Tokenizer tokenizer;
+    tokenizer.SetBuffer( chunk.start, chunk.length );
+    tokenizer.ResetBuffer( );
+
+    TokenView token;
+
+    while( tokenizer.GetNextToken( token, delimiters ) == true ) {
+        if( token.Equals( "v" ) == true ) {
+            ReadLine( tokenizer, nameDelimiters, chunk.positions, 3, 0.0f );
+            if( chunk.positions.HasFailed( ) == true ) {
+                break;
+            }
+            if( rightHanded == true ) {
+                chunk.positions[chunk.positions.Count( ) - 1] *= -1.0f;
+            }
+        }
+        else if( token.Equals( "vt" ) == true ) {
+            chunk.textureCoordinateComponentCount = ReadLine( tokenizer, nameDelimiters, chunk.textureCoordinates, chunk.textureCoordinateComponentCount, 0.0f );
+            if( chunk.textureCoordinates.HasFailed( ) == true ) {
+                break;
+            }
+            if( ( rightHanded == true ) && ( chunk.textureCoordinateComponentCount > 1 ) ) {
+                F32 &v = chunk.textureCoordinates[chunk.textureCoordinates.Count( ) - chunk.textureCoordinateComponentCount + 1];
+                v = 1 - v;
+            }
+        }
+        else if( token.Equals( "vn" ) == true ) {
+            chunk.normalComponentCount = ReadLine( tokenizer, nameDelimiters, chunk.normals, chunk.normalComponentCount, 0.0f );
+            if( chunk.normals.HasFailed( ) == true ) {
+                break;
+            }
+            if( ( rightHanded == true ) && ( chunk.normalComponentCount > 2 ) ) {
+                chunk.normals[chunk.normals.Count( ) - chunk.normalComponentCount + 2] *= -1.0f;
+            }
+        }
+        else if( token.Equals( "f" ) == true ) {
+            chunk.faceComponentCount = ReadLine( tokenizer, delimiters, chunk.faceIndices, chunk.faceComponentCount, 1U );
+            if( chunk.faceIndices.HasFailed( ) == true ) {
+                break;
+            }
+
+            // negative indices count back from the latest element, make them count from the start of the
+            // chunk for now (the result can be 0 or less, they reach back into earlier chunks)
+            U32 first = chunk.faceIndices.Count( ) - chunk.faceComponentCount;
+            U32 step = ( chunk.faceComponentCount >= 3 ) ? ( chunk.faceComponentCount / 3 ) : 1;
+            for( U32 i=0; i<chunk.faceComponentCount; ++i ) {
+                U32 &index = chunk.faceIndices[first + i];
+                if( static_cast<I32>( index ) < 0 ) {
+                    index += ElementCount( chunk, i % step ) + 1;
+                    chunk.relativeIndices.PushBack( first + i );
+                }
+            }
+
+            ++chunk.faceCount;
+        }
+        else if( token.Equals( "usemtl" ) == true ) {
+            // the submesh starts at the next face, faces are triangles
+            chunk.subMeshStarts.PushBack( chunk.faceCount * 3 );
+            tokenizer.GetNextToken( token, nameDelimiters );
+            chunk.materialNames.PushBack( token );
+        }
+        else if( token.Equals( "mtllib" ) == true ) {
+            tokenizer.GetNextToken( chunk.materialFile, nameDelimiters );
+        }
+    } // while( )
+
+    tokenizer.ReleaseBuffer( );
+}
+
+/*
+================
+MergeComponentCount
+
+Chunks without any of an element don't know its component count, the rest have to agree.
+================
+*/
+static bool MergeComponentCount( U32 &componentCount, U32 chunkComponentCount ) {
+    if( componentCount == 0 ) {
+        componentCount = chunkComponentCount;
+    }
+
+    return ( chunkComponentCount == 0 ) || ( chunkComponentCount == componentCount );
+}
+
+/*
+================
+ObjLoad
+
+Shared by the jobs that load the chunks.
+================
+*/
+struct ObjLoad {
+    ObjChunk              * chunks;
+    bool                    rightHanded;
+
+    // the whole mesh's positions, texture coordinates and normals
+    F32                   * positions;
+    F32                   * textureCoordinates;
+    F32                   * normals;
+
+    U32                     textureCoordinateComponentCount;
+    U32                     normalComponentCount;
+    U32                     faceComponentCount;
+
+    Vertex                * vertexData;
+};
+
+/*
+================
+ParseObjChunks
+================
+*/
+static void ParseObjChunks( void *param, U32 begin, U32 end, JobContext & /*context*/ ) {
+    ObjLoad *load = reinterpret_cast<ObjLoad*>( param );
+
+    for( U32 i=begin; i<end; ++i ) {
+        ParseObjChunk( load->chunks[i], load->rightHanded );
+    }
+}
+
+/*
+================
+GatherObjChunks
+
+Copies each chunk's positions, texture coordinates and normals to their place in the whole mesh's.
+================
+*/
+static void GatherObjChunks( void *param, U32 begin, U32 end, JobContext & /*context*/ ) {
+    ObjLoad *load = reinterpret_cast<ObjLoad*>( param );
+
+    for( U32 i=begin; i<end; ++i ) {
+        const ObjChunk &chunk = load->chunks[i];
+
+        CopyMem( chunk.positions.GetData( ), &load->positions[chunk.bases[0] * 3], sizeof( F32 ) * chunk.positions.Count( ) );
+        if( chunk.textureCoordinates.IsEmpty( ) == false ) {
+            CopyMem( chunk.textureCoordinates.GetData( ), &load->textureCoordinates[chunk.bases[1] * load->textureCoordinateComponentCount],
+                     sizeof( F32 ) * chunk.textureCoordinates.Count( ) );
+        }
+        if( chunk.normals.IsEmpty( ) == false ) {
+            CopyMem( chunk.normals.GetData( ), &load->normals[chunk.bases[2] * load->normalComponentCount],
+                     sizeof( F32 ) * chunk.normals.Count( ) );
+        }
+    }
+}
+
+/*
+================
+BuildObjVertices
+
+Arranges each chunk's faces into a list of triangles suitable for rendering, starting at the
+chunk's first vertex.
+================
+*/
+static void BuildObjVertices( void *param, U32 begin, U32 end, JobContext & /*context*/ ) {
+    ObjLoad *load = reinterpret_cast<ObjLoad*>( param );
+    const U32 TEXTURE_COORDINATE_COMPONENT_COUNT = load->textureCoordinateComponentCount;
+    const U32 VERTEX_NORMAL_COMPONENT_COUNT = load->normalComponentCount;
+    const U32 step = ( load->faceComponentCount / 3 );
+
+    for( U32 c=begin; c<end; ++c ) {
+        ObjChunk &chunk = load->chunks[c];
+        U32 *faceIndices = chunk.faceIndices.GetData( );
+
+        for( U32 i=0; i<chunk.relativeIndices.Count( ); ++i ) {
+            U32 slot = chunk.relativeIndices[i];
+            faceIndices[slot] += chunk.bases[slot % step];
+        }
+
+        // -1 because .obj indexing starts at 1, c/c++ arrays start at 0
+        Vertex *vertexData = &load->vertexData[chunk.faceBase * 3];
+        U32 countTo = ( chunk.faceCount * load->faceComponentCount );
+        for( U32 i=0, vertexIndex=0; i<countTo; i+=step, ++vertexIndex ) {
+            vertexData[vertexIndex].position[0] = load->positions[( faceIndices[i] - 1 ) * 3 + 0];
+            vertexData[vertexIndex].position[1] = load->positions[( faceIndices[i] - 1 ) * 3 + 1];
+            vertexData[vertexIndex].position[2] = load->positions[( faceIndices[i] - 1 ) * 3 + 2];
+
+            if( TEXTURE_COORDINATE_COMPONENT_COUNT > 0 ) {
+                for( U32 j=0; j<TEXTURE_COORDINATE_COMPONENT_COUNT; ++j ) {
+                    vertexData[vertexIndex].textureCoordinates[j] = load->textureCoordinates[( faceIndices[i + 1] - 1 ) * TEXTURE_COORDINATE_COMPONENT_COUNT + j];
+                }
+            }
+
+            if( VERTEX_NORMAL_COMPONENT_COUNT > 0 ) {
+                for( U32 j=0; j<VERTEX_NORMAL_COMPONENT_COUNT; ++j ) {
+                    vertexData[vertexIndex].normal[j] = load->normals[( faceIndices[i + 2] - 1 ) * VERTEX_NORMAL_COMPONENT_COUNT + j];
+                }
+            }
+
+            vertexData[vertexIndex].diffuseColour[0] = 0.75f; vertexData[vertexIndex].diffuseColour[1] = 0.75f;
+            vertexData[vertexIndex].diffuseColour[2] = 0.75f; vertexData[vertexIndex].diffuseColour[3] = 1.0f;
+        } // for( )
+    } // for( )
+}
+
+/*
+================
+RunOverChunks
+
+Over the job system when there's more than one chunk, otherwise on this thread.
+================
+*/
+static void RunOverChunks( JobSystem *jobSystem, JobFunction function, ObjLoad &load, U32 chunkCount ) {
+    if( ( jobSystem != NULL ) && ( chunkCount > 1 ) ) {
+        jobSystem->ParallelFor( chunkCount, 1, function, &load );
+    }
+    else {
+        JobContext context = { 0, NULL };
+        function( &load, 0, chunkCount, context );
+    }
+}
 
 
 /*
@@ -65,213 +561,130 @@ but I've still lots to get on with/get done.
 bool Mesh::LoadFromObjFile( const I8 *fileName, bool rightHanded ) {
     isRightHanded = rightHanded;
 
-    // Will move this file operation code to a minor platform neutral file 'helper' class
-    // -------------------------------------------------------------------------------
-    // load the file
-    HANDLE fileHwnd = CreateFile( fileName, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
-                                  NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
-    if( fileHwnd == INVALID_HANDLE_VALUE ) {
+    // map the file and parse it in place, all of it is going to be read
+    MappedFile file;
+    if( file.Open( fileName ) == false ) {
         return false;
     }
-    
-    // read in the file
-    LARGE_INTEGER fileSize;
-    GetFileSizeEx( fileHwnd, &fileSize );
-
-    I8 *fileBuffer = reinterpret_cast<I8*>( allocator.Allocate( sizeof( I8 ) * fileSize.QuadPart ) );
-    U32 bytesRead = 0;
-
-    if( ReadFile( fileHwnd, reinterpret_cast<void*>( &fileBuffer[0] ), fileSize.QuadPart,
-                  reinterpret_cast<LPDWORD>( &bytesRead ), NULL ) == 0 ) {
-        CloseHandle( fileHwnd );
-        Release( );
-        return false;
+    file.Prefetch( 0, file.Size( ) );
+
+    // split the file into chunks of whole lines, one per few workers if the job system is up (so the
+    // stealing can even things out) and small enough for the tokenizer's 32 bit offsets either way
+    const I8 *fileBuffer = reinterpret_cast<const I8*>( file.Data( ) );
+    U64 fileLength = file.Size( );
+    U64 chunkCount64 = ( fileLength + OBJ_MAX_CHUNK_SIZE - 1 ) / OBJ_MAX_CHUNK_SIZE;
+
+    JobSystem *jobSystem = JobSystem::GetSingletonPointer( );
+    if( ( jobSystem != NULL ) && ( jobSystem->GetWorkerCount( ) > 1 ) ) {
+        U64 wanted = static_cast<U64>( jobSystem->GetWorkerCount( ) ) * 4;
+        U64 fit = fileLength / OBJ_MIN_CHUNK_SIZE;
+        wanted = ( wanted < fit ) ? wanted : fit;
+        chunkCount64 = ( wanted > chunkCount64 ) ? wanted : chunkCount64;
     }
-
-    CloseHandle( fileHwnd );
-    // -------------------------------------------------------------------------------
-
-    // parse the file buffer
-    I8 delimiters[2] = { ' ', '/' };
-    tokenizer.SetBuffer( ( &fileBuffer[0] ), fileSize.QuadPart );
-
-    const U32 TOKEN_BUFFER_SIZE = 64;
-    I8 tokenBuffer[TOKEN_BUFFER_SIZE] = { 0 };
-
-    // for material parsing
-    I8 materialFile[64] = { 0 };
-    bool includesMaterial = false;
-
-    // in an attempt to avoid structures like vectors that do frequent dynamic allocation, we
-    // go through the file to work out the number of vertices etc and then make one allocation
-    // for each buffer
-    U32 TEXTURE_COORDINATE_COUNT = 0, VERTEX_NORMAL_COUNT = 0, FACE_COUNT = 0;
-
-    while( tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 2 ) == true ) {
-        if( strcmp( tokenBuffer, "v" ) == 0 ) {
-             ++vertexCount;
+    U32 chunkCount = ( chunkCount64 > 0 ) ? static_cast<U32>( chunkCount64 ) : 1;
+
+    ObjChunk *chunks = reinterpret_cast<ObjChunk*>( allocator.Allocate( sizeof( ObjChunk ) * chunkCount, RT_CACHE_LINE_SIZE ) );
+    const I8 *chunkStart = fileBuffer, *fileEnd = fileBuffer + fileLength;
+    for( U32 i=0; i<chunkCount; ++i ) {
+        const I8 *chunkEnd = ( i == ( chunkCount - 1 ) ) ? fileEnd : ( fileBuffer + ( fileLength / chunkCount ) * ( i + 1 ) );
+        if( chunkEnd <= chunkStart ) {
+            chunkEnd = chunkStart;
         }
-
-        if( strcmp( tokenBuffer, "vt" ) == 0 ) {
-            ++TEXTURE_COORDINATE_COUNT;
+        else {
+            // carry on to the end of the line
+            while( ( chunkEnd < fileEnd ) && ( chunkEnd[-1] != '\n' ) ) {
+                ++chunkEnd;
+            }
         }
 
-        if( strcmp( tokenBuffer, "vn" ) == 0 ) {
-            ++VERTEX_NORMAL_COUNT;
-        }
+        // use placement new
+        new( reinterpret_cast<void*>( &chunks[i] ) ) ObjChunk( chunkStart, static_cast<U32>( chunkEnd - chunkStart ) );
+        chunkStart = chunkEnd;
+    }
 
-        if( strcmp( tokenBuffer, "f" ) == 0 ) {
-            ++FACE_COUNT;
-        }
+    ObjLoad load;
+    load.chunks = chunks;
+    load.rightHanded = rightHanded;
+    RunOverChunks( jobSystem, ParseObjChunks, load, chunkCount );
 
-        if( strcmp( tokenBuffer, "mtllib" ) == 0 ) {
-            includesMaterial = true;
+    // work out where each chunk's data goes in the whole mesh
+    U32 POSITION_COUNT = 0, TEXTURE_COORDINATE_COUNT = 0, VERTEX_NORMAL_COUNT = 0, FACE_COUNT = 0;
+    U32 TEXTURE_COORDINATE_COMPONENT_COUNT = 0, VERTEX_NORMAL_COMPONENT_COUNT = 0, FACE_COMPONENT_COUNT = 0;
+    bool consistent = true;
 
-            // store the material file name
-            tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 1 );
-            strcpy( materialFile, tokenBuffer );
-        }
+    // for material parsing
+    TokenView materialFileToken = { NULL, 0 };
+    materialCount = 0;
 
-        if( strcmp( tokenBuffer, "usemtl" ) == 0 ) {
-            ++materialCount;
-        }
+    for( U32 i=0; i<chunkCount; ++i ) {
+        ObjChunk &chunk = chunks[i];
 
-        memset( tokenBuffer, 0, TOKEN_BUFFER_SIZE );
-    } // while( )
-    tokenizer.ResetBuffer( );
+        // ran out of address space or memory
+        consistent &= ( chunk.HasFailed( ) == false );
+        consistent &= MergeComponentCount( TEXTURE_COORDINATE_COMPONENT_COUNT, chunk.textureCoordinateComponentCount );
+        consistent &= MergeComponentCount( VERTEX_NORMAL_COMPONENT_COUNT, chunk.normalComponentCount );
+        consistent &= MergeComponentCount( FACE_COMPONENT_COUNT, chunk.faceComponentCount );
 
-    // work out how many components make a up a vector normal, texture coordinate and face
-    U32 VERTEX_NORMAL_COMPONENT_COUNT = 0, TEXTURE_COORDINATE_COMPONENT_COUNT = 0, FACE_COMPONENT_COUNT = 0;
+        chunk.bases[0] = POSITION_COUNT;
+        chunk.bases[1] = TEXTURE_COORDINATE_COUNT;
+        chunk.bases[2] = VERTEX_NORMAL_COUNT;
+        chunk.faceBase = FACE_COUNT;
 
-    while( tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 2 ) == true ) {
-        if( ( strcmp( tokenBuffer, "vt" ) == 0 ) && ( TEXTURE_COORDINATE_COMPONENT_COUNT == 0 ) ) {
-            while( ( tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 2 ) == true ) && 
-                   ( strcmp( tokenBuffer, "" ) != 0 ) && ( strcmp( tokenBuffer, "vt" ) != 0 ) ) {
-                ++TEXTURE_COORDINATE_COMPONENT_COUNT;
-                memset( tokenBuffer, 0, TOKEN_BUFFER_SIZE );
-            }
-        }
+        POSITION_COUNT += ElementCount( chunk, 0 );
+        TEXTURE_COORDINATE_COUNT += ElementCount( chunk, 1 );
+        VERTEX_NORMAL_COUNT += ElementCount( chunk, 2 );
+        FACE_COUNT += chunk.faceCount;
 
-        if( ( strcmp( tokenBuffer, "vn" ) == 0 )  && ( VERTEX_NORMAL_COMPONENT_COUNT == 0 ) ) {
-            while( ( tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 2 ) == true ) && 
-                   ( strcmp( tokenBuffer, "" ) != 0 ) && ( strcmp( tokenBuffer, "vn" ) != 0 ) ) {
-                ++VERTEX_NORMAL_COMPONENT_COUNT;
-                memset( tokenBuffer, 0, TOKEN_BUFFER_SIZE );
-            }
+        materialCount += chunk.materialNames.Count( );
+        if( chunk.materialFile.IsEndOfLine( ) == false ) {
+            materialFileToken = chunk.materialFile;
         }
+    }
 
-        if( ( strcmp( tokenBuffer, "f" ) == 0 ) && ( FACE_COMPONENT_COUNT == 0 ) ) {
-            while( ( tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 2 ) == true ) &&
-                   ( strcmp( tokenBuffer, "" ) != 0 ) && ( strcmp( tokenBuffer, "f" ) != 0 ) ) {
-                ++FACE_COMPONENT_COUNT;
-                memset( tokenBuffer, 0, TOKEN_BUFFER_SIZE );
-            }
+    // a face needs at least a position for each of its three vertices
+    if( ( consistent == false ) || ( ( FACE_COUNT > 0 ) && ( FACE_COMPONENT_COUNT < 3 ) ) ) {
+        for( U32 i=0; i<chunkCount; ++i ) {
+            chunks[i].~ObjChunk( );
         }
-
-        memset( tokenBuffer, 0, TOKEN_BUFFER_SIZE );
-    } // while( )
-    tokenizer.ResetBuffer( );
-
-    // we now setup a few temporary buffers and then go through the file again (the first time was
-    // to get the sizes for these buffers) and read in the actual model data
-
-    // sets vertex info for the subsets, should look into getting rid of this but will keep it around
-    // for now, still loads to do (AABB, picking, editor etc..)
-    U32 *tempVertexOffsets = reinterpret_cast<U32*>( allocator.Allocate( sizeof( U32 ) * ( materialCount + 1 ) ) );
-
-    F32 *tempVertexData = reinterpret_cast<F32*>( allocator.Allocate( sizeof( F32 ) * vertexCount * 3 ) );
-    U32 *tempFaceData   = reinterpret_cast<U32*>( allocator.Allocate( sizeof( U32 ) * FACE_COUNT * FACE_COMPONENT_COUNT ) );
-
-    F32 *tempTextureCoordinateData = NULL;
-    if( TEXTURE_COORDINATE_COMPONENT_COUNT > 0 ) {
-        tempTextureCoordinateData = reinterpret_cast<F32*>( allocator.Allocate( sizeof( F32 ) * TEXTURE_COORDINATE_COUNT * TEXTURE_COORDINATE_COMPONENT_COUNT ) );
+        allocator.DeAllocate( chunks );
+        Release( );
+        return false;
     }
 
-    F32 *tempVertexNormalData = NULL;
-    if( VERTEX_NORMAL_COMPONENT_COUNT > 0 ) {
-        tempVertexNormalData = reinterpret_cast<F32*>( allocator.Allocate( sizeof( F32 ) * VERTEX_NORMAL_COUNT * VERTEX_NORMAL_COMPONENT_COUNT ) );
-    }
+    // copy out the names, the file can be unmapped after this
+    I8 materialFile[64] = { 0 };
+    bool includesMaterial = ( materialFileToken.IsEndOfLine( ) == false );
+    materialFileToken.CopyTo( materialFile, sizeof( materialFile ) );
 
     subMeshCount = materialCount;
     subMeshData = reinterpret_cast<SubMesh*>( allocator.Allocate( sizeof( SubMesh ) * subMeshCount ) );
     materialData = reinterpret_cast<Material*>( allocator.Allocate( sizeof( Material ) * materialCount ) );
-
-    // reset
-    vertexCount = 0;
-    TEXTURE_COORDINATE_COUNT = 0;
-    VERTEX_NORMAL_COUNT = 0;
-
-    U32 mtrlCount = 0, faceCount = 0, materialNumber = 0;
-    while( tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 2 ) == true ) {
-        // added for material parsing
-        if( strcmp( tokenBuffer, "usemtl" ) == 0 ) {
-            // old material related code
-            U32 temp = ( faceCount / ( FACE_COMPONENT_COUNT / 3 ) );
-            tempVertexOffsets[mtrlCount] = temp;
-            ++mtrlCount;
-
-            tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 1 );
-            strcpy( materialData[materialNumber].materialName, tokenBuffer );
-            ++materialNumber;
+    for( U32 i=0, material=0; i<chunkCount; ++i ) {
+        for( U32 j=0; j<chunks[i].materialNames.Count( ); ++j, ++material ) {
+            chunks[i].materialNames[j].CopyTo( materialData[material].materialName, sizeof( materialData[material].materialName ) );
+            subMeshData[material].startVertex = ( chunks[i].faceBase * 3 ) + chunks[i].subMeshStarts[j];
         }
+    }
 
-        if( strcmp( tokenBuffer, "v" ) == 0 ) {
-            for( U32 i=0; i<3; ++i ) {
-                tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 1 );
-                if( ( i == 2 ) && ( rightHanded == true ) ) {
-                    tempVertexData[vertexCount] = -1.0f * atof( &tokenBuffer[0] );
-                }
-                else {
-                    tempVertexData[vertexCount] = atof( &tokenBuffer[0] );
-                }
-                ++vertexCount;
-                memset( tokenBuffer, 0, TOKEN_BUFFER_SIZE );
-            } // for( )
-        } // if( )
-
-        if( strcmp( tokenBuffer, "vt" ) == 0 && ( TEXTURE_COORDINATE_COMPONENT_COUNT > 0 ) ) {    
-            for( U32 i=0; i<TEXTURE_COORDINATE_COMPONENT_COUNT; ++i ) {
-                tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 1 );
-                if( ( i == 1 ) && ( rightHanded == true ) ) {
-                    tempTextureCoordinateData[TEXTURE_COORDINATE_COUNT] = 1 - atof( &tokenBuffer[0] );
-                }
-                else {
-                    tempTextureCoordinateData[TEXTURE_COORDINATE_COUNT] =  atof( &tokenBuffer[0] );
-                }
-                ++TEXTURE_COORDINATE_COUNT;
-                memset( tokenBuffer, 0, TOKEN_BUFFER_SIZE );
-            } // for( )
-        } // if( )
-
-        if( strcmp( tokenBuffer, "vn" ) == 0 && ( VERTEX_NORMAL_COMPONENT_COUNT > 0 ) ) {    
-            for( U32 i=0; i<VERTEX_NORMAL_COMPONENT_COUNT; ++i ) {
-                tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 1 );
-                if( ( i == 2 ) && ( rightHanded == true ) ) {
-                    tempVertexNormalData[VERTEX_NORMAL_COUNT] = -1.0f *  atof( &tokenBuffer[0] );
-                }
-                else {
-                    tempVertexNormalData[VERTEX_NORMAL_COUNT] = atof( &tokenBuffer[0] );
-                }
-                ++VERTEX_NORMAL_COUNT;
-                memset( tokenBuffer, 0, TOKEN_BUFFER_SIZE );        
-            } // for( )
-        } // if( )
-
-        if( strcmp( tokenBuffer, "f" ) == 0 ) {    
-            for( U32 i=0; i<FACE_COMPONENT_COUNT; ++i ) {
-                tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 2 );
-                tempFaceData[faceCount] = atoi( &tokenBuffer[0] );
-                ++faceCount;
-                memset( tokenBuffer, 0, TOKEN_BUFFER_SIZE );    
-            }
-        } // if( )
+    file.Close( );
+    fileBuffer = NULL;
 
-        memset( tokenBuffer, 0, TOKEN_BUFFER_SIZE );
-    } // while( )
+    // stitch the chunks' positions, texture coordinates and normals together, a single chunk already is the whole mesh's
+    load.textureCoordinateComponentCount = TEXTURE_COORDINATE_COMPONENT_COUNT;
+    load.normalComponentCount = VERTEX_NORMAL_COMPONENT_COUNT;
+    load.faceComponentCount = FACE_COMPONENT_COUNT;
 
-    // done with the buffer, can be released now
-    tokenizer.ReleaseBuffer( );
-    //tokenizer->ResetBuffer( );
+    if( chunkCount == 1 ) {
+        load.positions = chunks[0].positions.GetData( );
+        load.textureCoordinates = chunks[0].textureCoordinates.GetData( );
+        load.normals = chunks[0].normals.GetData( );
+    }
+    else {
+        load.positions = reinterpret_cast<F32*>( allocator.Allocate( sizeof( F32 ) * ( POSITION_COUNT * 3 + 1 ), 16 ) );
+        load.textureCoordinates = reinterpret_cast<F32*>( allocator.Allocate( sizeof( F32 ) * ( TEXTURE_COORDINATE_COUNT * TEXTURE_COORDINATE_COMPONENT_COUNT + 1 ), 16 ) );
+        load.normals = reinterpret_cast<F32*>( allocator.Allocate( sizeof( F32 ) * ( VERTEX_NORMAL_COUNT * VERTEX_NORMAL_COMPONENT_COUNT + 1 ), 16 ) );
+        RunOverChunks( jobSystem, GatherObjChunks, load, chunkCount );
+    }
 
     // -------------------------------------------------------------------------------
     // arrange the loaded .obj information int a list of triangles suitable for rendering
@@ -279,52 +692,22 @@ bool Mesh::LoadFromObjFile( const I8 *fileName, bool rightHanded ) {
     vertexCount = FACE_COUNT * 3;
 
     vertexData = reinterpret_cast<Vertex*>( allocator.Allocate( sizeof( Vertex ) * vertexCount ) );
-
-    tempVertexOffsets[materialCount] = vertexCount;
-
-    // -1 because .obj indexing starts at 1, c/c++ arrays start at 0
-    U32 vIndex = 0, countTo = ( FACE_COUNT * FACE_COMPONENT_COUNT ), step = ( FACE_COMPONENT_COUNT / 3 );
-    for( U32 i=0, vertexIndex=0; i<countTo; i+=step, ++vertexIndex ) {
-        vertexData[vertexIndex].position[0] = tempVertexData[( tempFaceData[i] - 1 ) * 3 + 0];
-        vertexData[vertexIndex].position[1] = tempVertexData[( tempFaceData[i] - 1 ) * 3 + 1];
-        vertexData[vertexIndex].position[2] = tempVertexData[( tempFaceData[i] - 1 ) * 3 + 2];
-
-        if( TEXTURE_COORDINATE_COMPONENT_COUNT > 0 ) {
-            for( U32 j=0; j<TEXTURE_COORDINATE_COMPONENT_COUNT; ++j ) {
-                vertexData[vertexIndex].textureCoordinates[j] = tempTextureCoordinateData[( tempFaceData[i + 1] - 1 ) * TEXTURE_COORDINATE_COMPONENT_COUNT + j];
-            }
-        }
-
-        if( VERTEX_NORMAL_COMPONENT_COUNT > 0 ) {
-            for( U32 j=0; j<VERTEX_NORMAL_COMPONENT_COUNT; ++j ) {
-                vertexData[vertexIndex].normal[j] = tempVertexNormalData[( tempFaceData[i + 2] - 1 ) * VERTEX_NORMAL_COMPONENT_COUNT + j];
-            }
-        }
-
-        vertexData[vertexIndex].diffuseColour[0] = 0.75f; vertexData[vertexIndex].diffuseColour[1] = 0.75f;
-        vertexData[vertexIndex].diffuseColour[2] = 0.75f; vertexData[vertexIndex].diffuseColour[3] = 1.0f;
-    } // for( )
+    load.vertexData = vertexData;
+    RunOverChunks( jobSystem, BuildObjVertices, load, chunkCount );
     // -------------------------------------------------------------------------------
 
-    // finished, release the temporary buffers allocated earlier
-    allocator.DeAllocate( fileBuffer );
-    fileBuffer = NULL;
-
-    allocator.DeAllocate( tempVertexData );
-    tempVertexData = NULL;
-
-    allocator.DeAllocate( tempFaceData );
-    tempFaceData = NULL;
-
-    if( TEXTURE_COORDINATE_COMPONENT_COUNT > 0 ) {
-        allocator.DeAllocate( tempTextureCoordinateData );
-        tempTextureCoordinateData = NULL;
+    // finished, release the chunks
+    if( chunkCount > 1 ) {
+        allocator.DeAllocate( load.positions );
+        allocator.DeAllocate( load.textureCoordinates );
+        allocator.DeAllocate( load.normals );
     }
 
-    if( VERTEX_NORMAL_COMPONENT_COUNT > 0 ) {
-        allocator.DeAllocate( tempVertexNormalData );
-        tempVertexNormalData = NULL;
+    for( U32 i=0; i<chunkCount; ++i ) {
+        chunks[i].~ObjChunk( );
     }
+    allocator.DeAllocate( chunks );
+    chunks = NULL;
 
     // load and set materials
     bool b = false;
@@ -343,12 +726,12 @@ bool Mesh::LoadFromObjFile( const I8 *fileName, bool rightHanded ) {
         }
     }
 
-    // set the submesh data
+    // set the submesh data, the start vertices were set along with the material names
     for( U32 i=0; i<subMeshCount; ++i ) {
         subMeshData[i].subMeshId = i;
 
-        subMeshData[i].startVertex  = tempVertexOffsets[i];
-        subMeshData[i].vertexCount  = tempVertexOffsets[i+1] - tempVertexOffsets[i];
+        U32 endVertex = ( i < ( subMeshCount - 1 ) ) ? subMeshData[i+1].startVertex : vertexCount;
+        subMeshData[i].vertexCount  = endVertex - subMeshData[i].startVertex;
 
         subMeshData[i].startIndex = -1;
         subMeshData[i].indexCount = -1;
@@ -357,9 +740,6 @@ bool Mesh::LoadFromObjFile( const I8 *fileName, bool rightHanded ) {
     // so we set index info to -1
     indexCount = -1;
 
-    allocator.DeAllocate( tempVertexOffsets );
-    tempVertexOffsets = NULL;
-
     // finish by calculating bounding volume
     CalculateBoundingVolume( );
 
@@ -560,98 +940,67 @@ Mesh::LoadMaterialFile
 ================
 */
 bool Mesh::LoadMaterialFile( const I8 *fileName ) {
-    // load the file
-    HANDLE fileHwnd = CreateFile( fileName, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
-    if( fileHwnd == INVALID_HANDLE_VALUE ) {
+    // map the file
+    MappedFile file;
+    if( file.Open( fileName ) == false ) {
         return false;
     }
 
-    // read in the file
-    LARGE_INTEGER fileSize;
-    GetFileSizeEx( fileHwnd, &fileSize );
-
-    I8 *fileBuffer = reinterpret_cast<I8*>( allocator.Allocate( sizeof( I8 ) * fileSize.QuadPart ) );
-    U32 bytesRead = 0;
-
-    if( ReadFile( fileHwnd, reinterpret_cast<void*>( &fileBuffer[0] ), fileSize.QuadPart,
-                  reinterpret_cast<LPDWORD>( &bytesRead ), NULL ) == 0 ) {
-        CloseHandle( fileHwnd );
-        Release( );
-        return false;
-    }
-
-    CloseHandle( fileHwnd );
-
     // parse the material
-    I8 delimiters[2] = { ' ', '/' };
-    tokenizer.SetBuffer( ( &fileBuffer[0] ), fileSize.QuadPart );
+    const DelimiterSet delimiters( " /", 2 );
+    const DelimiterSet nameDelimiters( " ", 1 );
+    tokenizer.SetBuffer( reinterpret_cast<const I8*>( file.Data( ) ), static_cast<U32>( file.Size( ) ) );
+    tokenizer.ResetBuffer( );
 
-    I8 tokenBuffer[64] = { 0 };
+    TokenView token;
 
     // fill in the material properties
-    I32 i = 0, j = 0;
-    while( tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 2 ) == true ) {
-    
-        if( strcmp( tokenBuffer, "newmtl" ) == 0 ) {
+    I32 j = 0;
+    while( tokenizer.GetNextToken( token, delimiters ) == true ) {
+        if( token.Equals( "newmtl" ) == true ) {
             // get the relevant material
-            tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 1 );
+            tokenizer.GetNextToken( token, nameDelimiters );
             for( U32 i=0; i<materialCount; ++i ) {
-                if( strcmp( materialData[i].materialName, &tokenBuffer[0] ) == 0 ) {
+                if( token.Equals( materialData[i].materialName ) == true ) {
                     j = i;
                     break;
                 }
             }
         }
-
-        if( strcmp( tokenBuffer, "Ka" ) == 0 ) {
+        else if( token.Equals( "Ka" ) == true ) {
             for( U32 i=0; i<3; ++i ) {
-                tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 1 );
-                materialData[j].ambientColour[i] = atof( &tokenBuffer[0] );
-                memset( tokenBuffer, 0, 64 );
+                materialData[j].ambientColour[i] = ReadFloat( tokenizer, nameDelimiters );
             }
         }
-
-        if( strcmp( tokenBuffer, "Kd" ) == 0 ) {
+        else if( token.Equals( "Kd" ) == true ) {
             for( U32 i=0; i<3; ++i ) {
-                tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 1 );
-                materialData[j].diffuseColour[i] = atof( &tokenBuffer[0] );
-                memset( tokenBuffer, 0, 64 );
+                materialData[j].diffuseColour[i] = ReadFloat( tokenizer, nameDelimiters );
             }
         }
-
-        if( strcmp( tokenBuffer, "Ks" ) == 0 ) {
+        else if( token.Equals( "Ks" ) == true ) {
             for( U32 i=0; i<3; ++i ) {
-                tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 1 );
-                materialData[j].specularColour[i] = atof( &tokenBuffer[0] );
-                memset( tokenBuffer, 0, 64 );
+                materialData[j].specularColour[i] = ReadFloat( tokenizer, nameDelimiters );
             }
         }
-
-        if( strcmp( tokenBuffer, "Ns" ) == 0 ) {
-            tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 1 );
-            materialData[j].specularCoefficient = atof( &tokenBuffer[0] );
+        else if( token.Equals( "Ns" ) == true ) {
+            materialData[j].specularCoefficient = ReadFloat( tokenizer, nameDelimiters );
         }
-
-        if( strcmp( tokenBuffer, "map_Kd" ) == 0 ) {
-            tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 1 );
-            strcpy( materialData[j].diffuseMapName, &tokenBuffer[0] );
+        else if( token.Equals( "map_Kd" ) == true ) {
+            tokenizer.GetNextToken( token, nameDelimiters );
+            token.CopyTo( materialData[j].diffuseMapName, sizeof( materialData[j].diffuseMapName ) );
         }
-
-        if( strcmp( tokenBuffer, "map_Ks" ) == 0 ) {
-            tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 1 );
-            strcpy( materialData[j].specularMapName, &tokenBuffer[0] );
+        else if( token.Equals( "map_Ks" ) == true ) {
+            tokenizer.GetNextToken( token, nameDelimiters );
+            token.CopyTo( materialData[j].specularMapName, sizeof( materialData[j].specularMapName ) );
         }
-
-        if( strcmp( tokenBuffer, "map_bump" ) == 0 || strcmp( tokenBuffer, "bump" ) == 0 ) {
-            tokenizer.GetNextToken( ( &tokenBuffer[0] ), delimiters, 1 );
-            strcpy( materialData[j].normalMapName, &tokenBuffer[0] );
+        else if( token.Equals( "map_bump" ) == true || token.Equals( "bump" ) == true ) {
+            tokenizer.GetNextToken( token, nameDelimiters );
+            token.CopyTo( materialData[j].normalMapName, sizeof( materialData[j].normalMapName ) );
         }
-
-        memset( tokenBuffer, 0, 64 );
     }
 
     tokenizer.ReleaseBuffer( );
-    allocator.DeAllocate( fileBuffer );
+    file.Close( );
 
     return true;
 }
@@ -5,10 +5,14 @@
     ==========
     File        :    RtMesh.h
     Author      :    Jamie Taylor
-    Last Edit   :    31/07/13
+    Last Edit   :    17/10/26
     Desc        :    Describes a mesh used by the engine. Contents can be set
                      by parsing a .obj|&.rtm file or using the GeoPrimitiveGenerator.
 
+                     17/10/26 - Back on the core tokenizer, temptok.h/.cpp are gone.
+
+                     17/10/26 - .obj files are parsed in chunks, spread over the job system if it's running.
+
 ===============================================================================
 */
 
@@ -18,14 +22,24 @@
 
 
 #include "../../PlatformIndependenceLayer/RtPlatform.h"
-#include "../../CoreSystems/RtHeapAllocator.h"
-//#include "../../CoreSystems/RtTokenizer.h"
-#include "temptok.h"
+#include "../../CoreSystems/RtSizeClassAllocator.h"
+#include "../../CoreSystems/RtTokenizer.h"
 #include "RtVertex.h"
 #include "RtMaterial.h"
 #include "../../Collision&Phsysics/RtAxisAlignedBox.h"
 
 
+// smallest chunk of an .obj file handed to a job - can be overridden in RtConfiguration.h
+#ifndef OBJ_MIN_CHUNK_SIZE
+    #define OBJ_MIN_CHUNK_SIZE ( 4 * 1024 * 1024 )
+#endif // OBJ_MIN_CHUNK_SIZE
+
+// largest chunk of an .obj file, the tokenizer works in 32 bit offsets - can be overridden in RtConfiguration.h
+#ifndef OBJ_MAX_CHUNK_SIZE
+    #define OBJ_MAX_CHUNK_SIZE ( 1024 * 1024 * 1024 )
+#endif // OBJ_MAX_CHUNK_SIZE
+
+
 // TEMP: replace with platform netural math code once things are up and running
 #include<xnamath.h>
 
@@ -99,10 +113,8 @@ public:
     bool           IsLoaded( void ) const;
 
 private:
-    HeapAllocator<void> allocator;
+    SizeClassAllocator<void> allocator;
 
-    // made static to 'fix' lnk2019 mesh::tokenizer( ) and ~( )
-    // feels like 'fixing' a symptom and not the genuine issue
     Tokenizer      tokenizer;
 
     U32            vertexCount;
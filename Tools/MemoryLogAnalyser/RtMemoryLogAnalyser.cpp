@@ -0,0 +1,433 @@
+/*
+===============================================================================
+
+    ReflecTech
+    ==========
+    File        :    RtMemoryLogAnalyser.cpp
+    Author      :    Jamie Taylor
+    Last Edit   :    17/10/26
+    Desc        :    Command line analyser for the memory tracker's binary event log (RtMemoryEventLog.h).
+
+                     usage: RtMemoryLogAnalyser <log file> [-i <interval ms>] [-n <top count>]
+
+                     Reports
+                         - live bytes per source/usage over time, one row per interval
+                         - the peak, and the allocation sites holding the most memory at that point
+                         - allocation rate hot spots, the busiest sites and the busiest intervals
+                         - leak sites, allocations that were never freed, grouped by site
+
+                     Sources and usages are printed as their ALLOC_SOURCE/ALLOC_USAGE values.
+
+                     A file id is the address of a __FILE__ string, so a header included by several translation
+                     units shows up under several ids (and path spellings). Names are normalised and every id
+                     with the same name is folded into one so a site is reported once.
+
+                     Offline tool, so it uses the standard library rather than the engine containers.
+
+===============================================================================
+*/
+
+
+#include "../../CoreSystems/RtMemoryEventLog.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+
+// source/usage pair packed into one key
+typedef U32 UsageKey;
+// file id and line packed into one key
+typedef std::pair<U64, U32> SiteKey;
+
+struct LiveAllocation {
+    U64                 bytes;
+    SiteKey             site;
+    UsageKey            usage;
+};
+
+struct SiteStats {
+    SiteStats( void ) { allocCount = bytesAllocated = liveCount = liveBytes = 0; }
+
+    U64                 allocCount;
+    U64                 bytesAllocated;
+    U64                 liveCount;
+    U64                 liveBytes;
+};
+
+struct Log {
+    std::vector<MemoryEvent>        events;
+    std::map<U64, std::string>      fileNames;
+    // file id -> the first id seen with the same (normalised) name
+    std::map<U64, U64>              canonicalFiles;
+};
+
+
+/*
+================
+MakeUsageKey
+================
+*/
+static UsageKey MakeUsageKey( const MemoryEvent &event ) {
+    return ( static_cast<U32>( static_cast<U8>( event.source ) ) << 8 ) | static_cast<U8>( event.usage );
+}
+
+/*
+================
+UsageName
+================
+*/
+static std::string UsageName( UsageKey key ) {
+    char name[32];
+    sprintf( name, "%d/%d", static_cast<I8>( key >> 8 ), static_cast<I8>( key & 0xFF ) );
+    return name;
+}
+
+/*
+================
+SiteName
+================
+*/
+static std::string SiteName( const Log &log, const SiteKey &site ) {
+    std::map<U64, std::string>::const_iterator name = log.fileNames.find( site.first );
+    char line[32];
+    sprintf( line, ":%u", site.second );
+    return ( ( name != log.fileNames.end( ) ) ? name->second : std::string( "unknown" ) ) + line;
+}
+
+/*
+================
+NormaliseFileName
+
+Forward slashes, no "." segments and ".." folded into the segment before it where there is one.
+================
+*/
+static std::string NormaliseFileName( const std::string &name ) {
+    std::string path( name );
+    std::replace( path.begin( ), path.end( ), '\\', '/' );
+
+    bool absolute = ( path.empty( ) == false && path[0] == '/' );
+    std::vector<std::string> segments;
+    size_t start = 0;
+    while( start <= path.size( ) ) {
+        size_t end = path.find( '/', start );
+        if( end == std::string::npos ) {
+            end = path.size( );
+        }
+
+        std::string segment = path.substr( start, end - start );
+        if( segment == ".." && segments.empty( ) == false && segments.back( ) != ".." ) {
+            segments.pop_back( );
+        }
+        else if( segment.empty( ) == false && segment != "." ) {
+            segments.push_back( segment );
+        }
+
+        start = end + 1;
+    }
+
+    std::string normalised( absolute ? "/" : "" );
+    for( size_t i=0; i<segments.size( ); ++i ) {
+        normalised += ( i > 0 ) ? ( "/" + segments[i] ) : segments[i];
+    }
+    return normalised;
+}
+
+/*
+================
+LoadLog
+================
+*/
+static bool LoadLog( const char *fileName, Log &log ) {
+    FILE *file = fopen( fileName, "rb" );
+    if( file == NULL ) {
+        fprintf( stderr, "can't open %s\n", fileName );
+        return false;
+    }
+
+    MemoryEventLogHeader header;
+    if( fread( &header, sizeof( header ), 1, file ) != 1 || header.magic != MEMORY_EVENT_LOG_MAGIC ) {
+        fprintf( stderr, "%s isn't a memory event log\n", fileName );
+        fclose( file );
+        return false;
+    }
+
+    if( header.version != MEMORY_EVENT_LOG_VERSION || header.eventSize != sizeof( MemoryEvent ) ) {
+        fprintf( stderr, "%s is version %u, this analyser reads version %u\n", fileName, header.version, MEMORY_EVENT_LOG_VERSION );
+        fclose( file );
+        return false;
+    }
+
+    std::map<std::string, U64> idsByName;
+
+    MemoryEvent event;
+    while( fread( &event, sizeof( event ), 1, file ) == 1 ) {
+        if( event.type == MEMORY_EVENT_FILE_NAME ) {
+            std::string name( static_cast<size_t>( event.bytes ), '\0' );
+            if( event.bytes > 0 && fread( &name[0], 1, name.size( ), file ) != name.size( ) ) {
+                break;
+            }
+
+            name = NormaliseFileName( name );
+            std::map<std::string, U64>::const_iterator known = idsByName.find( name );
+            if( known == idsByName.end( ) ) {
+                idsByName[name] = event.file;
+                log.fileNames[event.file] = name;
+                log.canonicalFiles[event.file] = event.file;
+            }
+            else {
+                log.canonicalFiles[event.file] = known->second;
+            }
+            continue;
+        }
+
+        // a name is always written before the first event that refers to it
+        std::map<U64, U64>::const_iterator canonical = log.canonicalFiles.find( event.file );
+        if( canonical != log.canonicalFiles.end( ) ) {
+            event.file = canonical->second;
+        }
+
+        log.events.push_back( event );
+    }
+
+    fclose( file );
+    return true;
+}
+
+/*
+================
+ReportTimeline
+
+Live bytes per source/usage at the end of each interval.
+================
+*/
+static void ReportTimeline( const Log &log, U64 intervalUs ) {
+    printf( "\n== live bytes per source/usage, every %llu ms ==\n", static_cast<unsigned long long>( intervalUs / 1000 ) );
+
+    // only show the usages that ever allocated anything
+    std::vector<UsageKey> columns;
+    for( size_t i=0; i<log.events.size( ); ++i ) {
+        UsageKey key = MakeUsageKey( log.events[i] );
+        if( std::find( columns.begin( ), columns.end( ), key ) == columns.end( ) ) {
+            columns.push_back( key );
+        }
+    }
+    std::sort( columns.begin( ), columns.end( ) );
+
+    printf( "%10s", "ms" );
+    for( size_t c=0; c<columns.size( ); ++c ) {
+        printf( "  %12s", UsageName( columns[c] ).c_str( ) );
+    }
+    printf( "\n" );
+
+    std::map<UsageKey, I64> live;
+    U64 intervalEnd = intervalUs;
+    size_t i = 0;
+
+    while( i < log.events.size( ) ) {
+        for( ; i < log.events.size( ) && log.events[i].timestamp < intervalEnd; ++i ) {
+            const MemoryEvent &event = log.events[i];
+            I64 delta = static_cast<I64>( event.bytes );
+            live[MakeUsageKey( event )] += ( event.type == MEMORY_EVENT_ALLOC ) ? delta : -delta;
+        }
+
+        printf( "%10llu", static_cast<unsigned long long>( intervalEnd / 1000 ) );
+        for( size_t c=0; c<columns.size( ); ++c ) {
+            printf( "  %12lld", static_cast<long long>( live[columns[c]] ) );
+        }
+        printf( "\n" );
+
+        intervalEnd += intervalUs;
+    }
+}
+
+/*
+================
+ReportPeak
+
+Find the point where the most memory was live, then replay up to it to see who was holding it.
+================
+*/
+static void ReportPeak( const Log &log, U32 topCount ) {
+    I64 live = 0, peak = 0;
+    size_t peakIndex = 0;
+
+    for( size_t i=0; i<log.events.size( ); ++i ) {
+        const MemoryEvent &event = log.events[i];
+        live += ( event.type == MEMORY_EVENT_ALLOC ) ? static_cast<I64>( event.bytes ) : -static_cast<I64>( event.bytes );
+        if( live > peak ) {
+            peak = live;
+            peakIndex = i;
+        }
+    }
+
+    std::map<U64, LiveAllocation> allocations;
+    for( size_t i=0; i<=peakIndex && i<log.events.size( ); ++i ) {
+        const MemoryEvent &event = log.events[i];
+        if( event.type == MEMORY_EVENT_ALLOC ) {
+            LiveAllocation &allocation = allocations[event.pointer];
+            allocation.bytes = event.bytes;
+            allocation.site = SiteKey( event.file, event.line );
+            allocation.usage = MakeUsageKey( event );
+        }
+        else {
+            allocations.erase( event.pointer );
+        }
+    }
+
+    std::map<SiteKey, U64> bySite;
+    for( std::map<U64, LiveAllocation>::const_iterator itr = allocations.begin( ); itr != allocations.end( ); ++itr ) {
+        bySite[itr->second.site] += itr->second.bytes;
+    }
+
+    std::vector< std::pair<U64, SiteKey> > sorted;
+    for( std::map<SiteKey, U64>::const_iterator itr = bySite.begin( ); itr != bySite.end( ); ++itr ) {
+        sorted.push_back( std::make_pair( itr->second, itr->first ) );
+    }
+    std::sort( sorted.rbegin( ), sorted.rend( ) );
+
+    U64 peakTime = log.events.empty( ) ? 0 : log.events[peakIndex].timestamp;
+    printf( "\n== peak: %lld bytes at %llu ms, largest contributors ==\n", static_cast<long long>( peak ), static_cast<unsigned long long>( peakTime / 1000 ) );
+    for( size_t i=0; i<sorted.size( ) && i<topCount; ++i ) {
+        printf( "%14llu  %5.1f%%  %s\n", static_cast<unsigned long long>( sorted[i].first ),
+                ( peak > 0 ) ? ( 100.0 * sorted[i].first / peak ) : 0.0, SiteName( log, sorted[i].second ).c_str( ) );
+    }
+}
+
+/*
+================
+ReportHotSpotsAndLeaks
+================
+*/
+static void ReportHotSpotsAndLeaks( const Log &log, U64 intervalUs, U32 topCount ) {
+    std::map<SiteKey, SiteStats> sites;
+    std::map<U64, LiveAllocation> allocations;
+    std::map<U64, U64> allocsPerInterval;
+
+    for( size_t i=0; i<log.events.size( ); ++i ) {
+        const MemoryEvent &event = log.events[i];
+        if( event.type == MEMORY_EVENT_ALLOC ) {
+            SiteKey site( event.file, event.line );
+            SiteStats &stats = sites[site];
+            ++stats.allocCount;
+            stats.bytesAllocated += event.bytes;
+
+            LiveAllocation &allocation = allocations[event.pointer];
+            allocation.bytes = event.bytes;
+            allocation.site = site;
+            allocation.usage = MakeUsageKey( event );
+
+            ++allocsPerInterval[event.timestamp / intervalUs];
+        }
+        else {
+            allocations.erase( event.pointer );
+        }
+    }
+
+    double seconds = log.events.empty( ) ? 0.0 : ( log.events.back( ).timestamp / 1000000.0 );
+
+    // busiest sites
+    std::vector< std::pair<U64, SiteKey> > sorted;
+    for( std::map<SiteKey, SiteStats>::const_iterator itr = sites.begin( ); itr != sites.end( ); ++itr ) {
+        sorted.push_back( std::make_pair( itr->second.allocCount, itr->first ) );
+    }
+    std::sort( sorted.rbegin( ), sorted.rend( ) );
+
+    printf( "\n== allocation hot spots, by number of allocations ==\n" );
+    printf( "%12s  %12s  %14s  %s\n", "allocs", "allocs/s", "bytes", "site" );
+    for( size_t i=0; i<sorted.size( ) && i<topCount; ++i ) {
+        const SiteStats &stats = sites[sorted[i].second];
+        printf( "%12llu  %12.0f  %14llu  %s\n", static_cast<unsigned long long>( stats.allocCount ),
+                ( seconds > 0.0 ) ? ( stats.allocCount / seconds ) : 0.0,
+                static_cast<unsigned long long>( stats.bytesAllocated ), SiteName( log, sorted[i].second ).c_str( ) );
+    }
+
+    // busiest intervals
+    std::vector< std::pair<U64, U64> > intervals;
+    for( std::map<U64, U64>::const_iterator itr = allocsPerInterval.begin( ); itr != allocsPerInterval.end( ); ++itr ) {
+        intervals.push_back( std::make_pair( itr->second, itr->first ) );
+    }
+    std::sort( intervals.rbegin( ), intervals.rend( ) );
+
+    printf( "\n== busiest intervals ==\n" );
+    for( size_t i=0; i<intervals.size( ) && i<topCount; ++i ) {
+        U64 start = intervals[i].second * intervalUs;
+        printf( "%10llu - %10llu ms  %12llu allocs\n", static_cast<unsigned long long>( start / 1000 ),
+                static_cast<unsigned long long>( ( start + intervalUs ) / 1000 ), static_cast<unsigned long long>( intervals[i].first ) );
+    }
+
+    // anything still live at the end of the log was leaked
+    for( std::map<U64, LiveAllocation>::const_iterator itr = allocations.begin( ); itr != allocations.end( ); ++itr ) {
+        SiteStats &stats = sites[itr->second.site];
+        ++stats.liveCount;
+        stats.liveBytes += itr->second.bytes;
+    }
+
+    sorted.clear( );
+    U64 leakedBytes = 0;
+    for( std::map<SiteKey, SiteStats>::const_iterator itr = sites.begin( ); itr != sites.end( ); ++itr ) {
+        if( itr->second.liveCount > 0 ) {
+            sorted.push_back( std::make_pair( itr->second.liveBytes, itr->first ) );
+            leakedBytes += itr->second.liveBytes;
+        }
+    }
+    std::sort( sorted.rbegin( ), sorted.rend( ) );
+
+    printf( "\n== leaks: %llu allocations, %llu bytes ==\n", static_cast<unsigned long long>( allocations.size( ) ), static_cast<unsigned long long>( leakedBytes ) );
+    for( size_t i=0; i<sorted.size( ); ++i ) {
+        const SiteStats &stats = sites[sorted[i].second];
+        printf( "%14llu bytes in %8llu allocations  %s\n", static_cast<unsigned long long>( stats.liveBytes ),
+                static_cast<unsigned long long>( stats.liveCount ), SiteName( log, sorted[i].second ).c_str( ) );
+    }
+}
+
+/*
+================
+main
+================
+*/
+int main( int argc, char **argv ) {
+    const char *fileName = NULL;
+    U64 intervalMs = 1000;
+    U32 topCount = 10;
+
+    for( int i=1; i<argc; ++i ) {
+        if( strcmp( argv[i], "-i" ) == 0 && ( i + 1 ) < argc ) {
+            intervalMs = strtoul( argv[++i], NULL, 10 );
+        }
+        else if( strcmp( argv[i], "-n" ) == 0 && ( i + 1 ) < argc ) {
+            topCount = static_cast<U32>( strtoul( argv[++i], NULL, 10 ) );
+        }
+        else {
+            fileName = argv[i];
+        }
+    }
+
+    if( fileName == NULL || intervalMs == 0 ) {
+        fprintf( stderr, "usage: %s <log file> [-i <interval ms>] [-n <top count>]\n", argv[0] );
+        return 1;
+    }
+
+    Log log;
+    if( LoadLog( fileName, log ) == false ) {
+        return 1;
+    }
+
+    // events from different threads can be a few microseconds out of order, the reports want them in time order
+    struct EarlierEvent {
+        static bool Compare( const MemoryEvent &a, const MemoryEvent &b ) { return a.timestamp < b.timestamp; }
+    };
+    std::stable_sort( log.events.begin( ), log.events.end( ), EarlierEvent::Compare );
+
+    printf( "%s: %llu events, %llu files\n", fileName, static_cast<unsigned long long>( log.events.size( ) ),
+            static_cast<unsigned long long>( log.fileNames.size( ) ) );
+
+    ReportTimeline( log, intervalMs * 1000 );
+    ReportPeak( log, topCount );
+    ReportHotSpotsAndLeaks( log, intervalMs * 1000, topCount );
+
+    return 0;
+}